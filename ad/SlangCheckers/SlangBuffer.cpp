@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// A growable byte buffer, to build the SPAN IR text.
+//===----------------------------------------------------------------------===//
+
+#include "SlangBuffer.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace slang;
+
+// the buffers that are not in use (with their capacity)
+static thread_local std::vector<std::string> freeBuffers;
+
+// a larger buffer (e.g. of a whole TU dump) is not kept
+#define MAX_FREE_BUFFER_CAPACITY (64 * 1024)
+
+AppendBuffer::AppendBuffer() {
+    if (!freeBuffers.empty()) {
+        buf.swap(freeBuffers.back());
+        freeBuffers.pop_back();
+    }
+}
+
+AppendBuffer::~AppendBuffer() {
+    if (buf.capacity() <= MAX_FREE_BUFFER_CAPACITY) {
+        buf.clear();
+        freeBuffers.push_back(std::move(buf));
+    }
+}
+
+AppendBuffer &AppendBuffer::appendFixed(double value) {
+    char digits[512]; // enough for any double with six decimals
+    int size = std::snprintf(digits, sizeof(digits), "%f", value);
+    if (size > 0) {
+        buf.append(digits, (size_t)size < sizeof(digits) ? (size_t)size : sizeof(digits) - 1);
+    }
+    return *this;
+}
+
+AppendBuffer &AppendBuffer::appendSigned(long long value) {
+    if (value < 0) {
+        buf.push_back('-');
+        // negate in unsigned, to handle the minimum value
+        return appendUnsigned(0ULL - (unsigned long long)value);
+    }
+    return appendUnsigned((unsigned long long)value);
+}
+
+AppendBuffer &AppendBuffer::appendUnsigned(unsigned long long value) {
+    char digits[20]; // the digits of 2^64 - 1
+    char *end = digits + sizeof(digits);
+    char *curr = end;
+    do {
+        *--curr = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    buf.append(curr, (size_t)(end - curr));
+    return *this;
+}
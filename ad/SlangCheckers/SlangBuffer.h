@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// A growable byte buffer, to build the SPAN IR text.
+//
+// It replaces std::stringstream in the lowering and the emission: there is
+// no locale, no stream state, and the integers are formatted by hand.
+// The storage is reused: a buffer takes a string (with its capacity) from
+// a per thread free list when constructed, and returns it when destroyed,
+// so the many short lived buffers of the lowering rarely allocate.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_BUFFER_H
+#define SLANG_BUFFER_H
+
+#include <cstdint>
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+
+namespace slang {
+
+class AppendBuffer {
+  public:
+    AppendBuffer();
+    ~AppendBuffer();
+
+    AppendBuffer(const AppendBuffer &) = delete;
+    AppendBuffer &operator=(const AppendBuffer &) = delete;
+
+    AppendBuffer &operator<<(llvm::StringRef str) {
+        buf.append(str.data(), str.size());
+        return *this;
+    }
+
+    AppendBuffer &operator<<(const char *str) { return *this << llvm::StringRef(str); }
+    AppendBuffer &operator<<(const std::string &str) { return *this << llvm::StringRef(str); }
+
+    AppendBuffer &operator<<(char c) {
+        buf.push_back(c);
+        return *this;
+    }
+
+    // bool is promoted to int: it is written as 0 or 1 (as with streams)
+    AppendBuffer &operator<<(int value) { return appendSigned(value); }
+    AppendBuffer &operator<<(long value) { return appendSigned(value); }
+    AppendBuffer &operator<<(long long value) { return appendSigned(value); }
+    AppendBuffer &operator<<(unsigned value) { return appendUnsigned(value); }
+    AppendBuffer &operator<<(unsigned long value) { return appendUnsigned(value); }
+    AppendBuffer &operator<<(unsigned long long value) { return appendUnsigned(value); }
+
+    AppendBuffer &write(const char *data, size_t size) {
+        buf.append(data, size);
+        return *this;
+    }
+
+    /** Appends the value with six decimals, as std::fixed does. */
+    AppendBuffer &appendFixed(double value);
+
+    /** @return a copy of the content. */
+    std::string str() const { return buf; }
+
+    /** @return the content; valid till the buffer is changed. */
+    llvm::StringRef getRef() const { return buf; }
+
+    size_t size() const { return buf.size(); }
+
+    /** Empties the buffer (it keeps its capacity). */
+    void clear() { buf.clear(); }
+
+  private:
+    std::string buf;
+
+    AppendBuffer &appendSigned(long long value);
+    AppendBuffer &appendUnsigned(unsigned long long value);
+};
+
+} // namespace slang
+
+#endif // SLANG_BUFFER_H
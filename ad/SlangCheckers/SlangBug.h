@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//  Author: Ronak Chauhan (r.chauhan@somaiya.edu)
+//
+//===----------------------------------------------------------------------===//
+// The bug (and its messages) that SLANG reports through Clang's BugReporter.
+// Shared by the checkers that load bugs from SPAN (.spanreport) and the ones
+// that detect bugs natively.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_BUG_H
+#define SLANG_BUG_H
+
+#include <string>
+#include <vector>
+#include "clang/AST/Stmt.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace slang {
+
+class BugMessage {
+    uint32_t line;
+    uint32_t col;
+    std::string messageString;
+    clang::Stmt *stmt;
+
+  public:
+    BugMessage() {
+        line = col = 0;
+        messageString = "";
+        stmt = nullptr;
+    }
+
+    BugMessage(uint32_t line, uint32_t col, std::string messageString) {
+        this->line = line;
+        this->col = col;
+        this->messageString = messageString;
+        stmt = nullptr;
+    }
+
+    uint64_t genEncodedId() const {
+        uint64_t encoded = 0;
+        encoded |= line;
+        encoded <<= 32;
+        encoded |= col;
+        return encoded;
+    }
+
+    uint32_t getLine() const { return line; }
+
+    uint32_t getCol() const { return col; }
+
+    clang::Stmt *getStmt() const { return stmt; }
+
+    void setStmt(clang::Stmt *stmt) { this->stmt = stmt; }
+
+    std::string getMessageString() const { return messageString; }
+
+    bool isEmpty() const { return line == 0 && col == 0 && messageString.length() == 0; }
+
+    void dump() const {
+        llvm::errs() << "LINE" << " " << line << "\n";
+        llvm::errs() << "COLUMN" << " " << col << "\n";
+        llvm::errs() << "MSG" << " " << messageString << "\n";
+        llvm::errs() << "STMT :\n";
+        if (stmt) {
+            stmt->dump();
+        } else {
+            llvm::errs() << "STMT is nullptr\n";
+        }
+    }
+};
+
+class Bug {
+  public:
+    std::string bugName;
+    std::string bugCategory;
+    std::vector<BugMessage> messages;
+
+    Bug() {
+        bugName = "";
+        bugCategory = "";
+    }
+
+    Bug(std::string bugName, std::string bugCategory, std::vector<BugMessage> messages) {
+        this->bugName = bugName;
+        this->bugCategory = bugCategory;
+        this->messages = messages;
+    }
+
+    // less than operator based on encoded id of first message
+    bool operator<(const Bug &rhs) const {
+        return this->messages[0].genEncodedId() < rhs.messages[0].genEncodedId();
+    }
+
+    bool isEmpty() const { return bugName == "" && bugCategory == ""; }
+
+    void dump() const {
+        llvm::errs() << "START" << "\n";
+        llvm::errs() << "NAME" << " " << bugName << "\n";
+        llvm::errs() << "CATEGORY" << " " << bugCategory << "\n";
+        for (int i = 0; i < (int)messages.size(); ++i) {
+            messages[i].dump();
+        }
+        llvm::errs() << "END" << "\n";
+    }
+};
+
+} // namespace slang
+
+#endif // SLANG_BUG_H
@@ -36,10 +36,12 @@
 #include <sstream>                    //AD
 #include <algorithm>                  //AD
 
+#include "SlangBug.h"
 #include "SlangUtil.h"
 
 using namespace clang;
 using namespace ento;
+using namespace slang;
 
 // #define LOG_ME(X) if (Utility::debug_mode) Utility::log((X), __FUNCTION__, __LINE__)
 
@@ -63,90 +65,6 @@ using namespace ento;
 
 namespace {
 
-class BugMessage {
-    uint32_t line;
-    uint32_t col;
-    std::string messageString;
-    Stmt *stmt;
-
-  public:
-    BugMessage() {
-        line = col = 0;
-        messageString = "";
-        stmt = nullptr;
-    }
-
-    BugMessage(uint32_t line, uint32_t col, std::string messageString) {
-        this->line = line;
-        this->col = col;
-        this->messageString = messageString;
-        stmt = nullptr;
-    }
-
-    uint64_t genEncodedId() const {
-        uint64_t encoded = 0;
-        encoded |= line;
-        encoded <<= 32;
-        encoded |= col;
-        return encoded;
-    }
-
-    Stmt *getStmt() const { return stmt; }
-
-    void setStmt(Stmt *stmt) { this->stmt = stmt; }
-
-    std::string getMessageString() const { return messageString; }
-
-    bool isEmpty() const { return line == 0 && col == 0 && messageString.length() == 0; }
-
-    void dump() const {
-        llvm::errs() << "LINE" << " " << line << "\n";
-        llvm::errs() << "COLUMN" << " " << col << "\n";
-        llvm::errs() << "MSG" << " " << messageString << "\n";
-        llvm::errs() << "STMT :\n";
-        if (stmt) {
-            stmt->dump();
-        } else {
-            llvm::errs() << "STMT is nullptr\n";
-        }
-    }
-};
-
-class Bug {
-  public:
-    std::string bugName;
-    std::string bugCategory;
-    std::vector<BugMessage> messages;
-
-    Bug() {
-        bugName = "";
-        bugCategory = "";
-    }
-
-    Bug(std::string bugName, std::string bugCategory, std::vector<BugMessage> messages) {
-        this->bugName = bugName;
-        this->bugCategory = bugCategory;
-        this->messages = messages;
-    }
-
-    // less than operator based on encoded id of first message
-    bool operator<(const Bug &rhs) const {
-        return this->messages[0].genEncodedId() < rhs.messages[0].genEncodedId();
-    }
-
-    bool isEmpty() const { return bugName == "" && bugCategory == ""; }
-
-    void dump() const {
-        llvm::errs() << "START" << "\n";
-        llvm::errs() << "NAME" << " " << bugName << "\n";
-        llvm::errs() << "CATEGORY" << " " << bugCategory << "\n";
-        for (int i = 0; i < (int)messages.size(); ++i) {
-            messages[i].dump();
-        }
-        llvm::errs() << "END" << "\n";
-    }
-};
-
 class BugRepo {
   public:
     // list of bugs for a particular point in source
@@ -0,0 +1,258 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// The call graph of a translation unit, and its strongly connected
+// components (SCCs) in bottom-up (callees first) order.
+//===----------------------------------------------------------------------===//
+
+#include "SlangCallGraph.h"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+using namespace slang;
+
+void CallGraph::addFunction(const std::string &funcName, const std::string &funcSig) {
+    funcSigs[funcName] = funcSig;
+}
+
+void CallGraph::addCall(const std::string &caller, const std::string &callee) {
+    callees[caller].insert(callee);
+}
+
+void CallGraph::addIndirectCall(const std::string &caller, const std::string &funcSig) {
+    indirectCallSigs[caller].insert(funcSig);
+}
+
+std::vector<std::string> CallGraph::getCallees(const std::string &funcName) const {
+    auto it = callees.find(funcName);
+    if (it == callees.end()) {
+        return std::vector<std::string>{};
+    }
+    return std::vector<std::string>(it->second.begin(), it->second.end());
+}
+
+static const char FUNC_SIG_PREFIX[] = "types.FuncSig(returnType=";
+
+// the return type of a types.FuncSig string, "" if it is not one
+static std::string getReturnType(const std::string &funcSig) {
+    const size_t start = sizeof(FUNC_SIG_PREFIX) - 1;
+    if (funcSig.compare(0, start, FUNC_SIG_PREFIX) != 0) {
+        return "";
+    }
+    int depth = 0;
+    for (size_t i = start; i < funcSig.size(); ++i) {
+        char c = funcSig[i];
+        if (c == '(' || c == '[') {
+            ++depth;
+        } else if ((c == ')' || c == ']') && depth > 0) {
+            --depth;
+        } else if ((c == ',' || c == ')') && depth == 0) {
+            return funcSig.substr(start, i - start);
+        }
+    }
+    return "";
+}
+
+// a function type without a prototype: types.FuncSig(returnType=R)
+static bool isNoProto(const std::string &funcSig, const std::string &returnType) {
+    return !returnType.empty() &&
+           funcSig.size() == sizeof(FUNC_SIG_PREFIX) - 1 + returnType.size() + 1;
+}
+
+static bool isVariadic(const std::string &funcSig) {
+    static const char suffix[] = ", variadic=True)";
+    const size_t size = sizeof(suffix) - 1;
+    return funcSig.size() >= size && funcSig.compare(funcSig.size() - size, size, suffix) == 0;
+}
+
+void CallGraph::computeSccs() {
+    // STEP 1: resolve the indirect calls by the function signature
+    // (see the header for the functions without a prototype).
+    std::map<std::string, std::vector<std::string>> sigToFuncs;
+    std::map<std::string, std::vector<std::string>> returnTypeToFuncs; // not variadic
+    std::map<std::string, std::vector<std::string>> returnTypeToNoProtoFuncs;
+    for (auto &funcSig : funcSigs) {
+        if (funcSig.second.empty()) {
+            continue;
+        }
+        sigToFuncs[funcSig.second].push_back(funcSig.first);
+        std::string returnType = getReturnType(funcSig.second);
+        if (returnType.empty() || isVariadic(funcSig.second)) {
+            continue;
+        }
+        returnTypeToFuncs[returnType].push_back(funcSig.first);
+        if (isNoProto(funcSig.second, returnType)) {
+            returnTypeToNoProtoFuncs[returnType].push_back(funcSig.first);
+        }
+    }
+    for (auto &callSigs : indirectCallSigs) {
+        std::set<std::string> &targets = callees[callSigs.first];
+        for (const std::string &funcSig : callSigs.second) {
+            std::string returnType = getReturnType(funcSig);
+            if (isNoProto(funcSig, returnType)) {
+                for (const std::string &target : returnTypeToFuncs[returnType]) {
+                    targets.insert(target);
+                }
+                continue;
+            }
+            for (const std::string &target : sigToFuncs[funcSig]) {
+                targets.insert(target);
+            }
+            if (!returnType.empty() && !isVariadic(funcSig)) {
+                for (const std::string &target : returnTypeToNoProtoFuncs[returnType]) {
+                    targets.insert(target);
+                }
+            }
+        }
+    }
+
+    // STEP 2: number the functions (in sorted order, for a stable output).
+    std::map<std::string, uint32_t> ids;
+    names.clear();
+    for (auto &funcSig : funcSigs) {
+        ids[funcSig.first] = (uint32_t)names.size();
+        names.push_back(funcSig.first);
+    }
+    for (auto &calls : callees) { // callers and callees not added as functions
+        for (const std::string &name : calls.second) {
+            if (ids.insert(std::make_pair(name, (uint32_t)names.size())).second) {
+                names.push_back(name);
+            }
+        }
+        if (ids.insert(std::make_pair(calls.first, (uint32_t)names.size())).second) {
+            names.push_back(calls.first);
+        }
+    }
+
+    succs.assign(names.size(), std::vector<uint32_t>{});
+    for (auto &calls : callees) {
+        for (const std::string &name : calls.second) {
+            succs[ids[calls.first]].push_back(ids[name]);
+        }
+    }
+
+    // STEP 3: Tarjan's algorithm; it finds an SCC only after all the SCCs it calls.
+    sccs.clear();
+    index.assign(names.size(), -1);
+    lowLink.assign(names.size(), 0);
+    onStack.assign(names.size(), false);
+    sccOf.assign(names.size(), -1);
+    stack.clear();
+    nextIndex = 0;
+    for (uint32_t i = 0; i < names.size(); ++i) {
+        if (index[i] < 0) {
+            strongConnect(i);
+        }
+    }
+
+    computeLevels();
+} // computeSccs()
+
+// iterative version of Tarjan's strongconnect(), to not overflow the stack
+void CallGraph::strongConnect(uint32_t root) {
+    std::vector<std::pair<uint32_t, size_t>> callStack; // (node, next successor)
+    callStack.push_back(std::make_pair(root, 0));
+    index[root] = lowLink[root] = nextIndex++;
+    stack.push_back(root);
+    onStack[root] = true;
+
+    while (!callStack.empty()) {
+        uint32_t node = callStack.back().first;
+        size_t &next = callStack.back().second;
+
+        if (next < succs[node].size()) {
+            uint32_t succ = succs[node][next++];
+            if (index[succ] < 0) {
+                index[succ] = lowLink[succ] = nextIndex++;
+                stack.push_back(succ);
+                onStack[succ] = true;
+                callStack.push_back(std::make_pair(succ, 0));
+            } else if (onStack[succ]) {
+                lowLink[node] = std::min(lowLink[node], index[succ]);
+            }
+            continue;
+        }
+
+        // all successors done: node may be the root of an SCC
+        if (lowLink[node] == index[node]) {
+            CallGraphScc scc;
+            scc.level = 0;
+            uint32_t member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                onStack[member] = false;
+                sccOf[member] = (int32_t)sccs.size();
+                scc.funcNames.push_back(names[member]);
+            } while (member != node);
+            std::sort(scc.funcNames.begin(), scc.funcNames.end());
+            sccs.push_back(scc);
+        }
+
+        callStack.pop_back();
+        if (!callStack.empty()) {
+            uint32_t parent = callStack.back().first;
+            lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+        }
+    }
+} // strongConnect()
+
+// the level of an SCC is one more than the highest level of the SCCs it calls
+void CallGraph::computeLevels() {
+    std::vector<std::vector<uint32_t>> sccMembers(sccs.size());
+    for (uint32_t i = 0; i < names.size(); ++i) {
+        sccMembers[sccOf[i]].push_back(i);
+    }
+
+    // the SCCs are already in bottom-up order
+    for (size_t s = 0; s < sccs.size(); ++s) {
+        uint32_t level = 0;
+        for (uint32_t member : sccMembers[s]) {
+            for (uint32_t succ : succs[member]) {
+                if (sccOf[succ] != (int32_t)s) {
+                    level = std::max(level, sccs[sccOf[succ]].level + 1);
+                }
+            }
+        }
+        sccs[s].level = level;
+    }
+}
+
+std::string CallGraph::toString(const std::string &indent) const {
+    std::stringstream ss;
+    std::string prefix;
+
+    ss << indent << "callGraph = {\n";
+    for (const std::string &name : names) {
+        ss << indent << "  \"" << name << "\": [";
+        prefix = "";
+        for (const std::string &callee : getCallees(name)) {
+            ss << prefix << "\"" << callee << "\"";
+            prefix = ", ";
+        }
+        ss << "],\n";
+    }
+    ss << indent << "}, # end callGraph dict\n\n";
+
+    ss << indent << "# (level, functions) of each SCC, callees before callers.\n";
+    ss << indent << "# The SCCs at the same level are independent of each other.\n";
+    ss << indent << "callGraphSccs = [\n";
+    for (const CallGraphScc &scc : sccs) {
+        ss << indent << "  (" << scc.level << ", [";
+        prefix = "";
+        for (const std::string &name : scc.funcNames) {
+            ss << prefix << "\"" << name << "\"";
+            prefix = ", ";
+        }
+        ss << "]),\n";
+    }
+    ss << indent << "], # end callGraphSccs list\n\n";
+
+    return ss.str();
+} // toString()
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// The call graph of a translation unit, and its strongly connected
+// components (SCCs) in bottom-up (callees first) order.
+//
+// Calls through function pointers are conservatively resolved by the
+// signature of the callee (the types.FuncSig string): to all the functions
+// with the same signature. A function type without a prototype (`int f()`
+// in C) has no paramTypes, types.FuncSig(returnType=types.Int32): C lets
+// it be called with any arguments, so a call through a pointer to it
+// resolves to all the functions (not variadic) with its return type, and a
+// call through a prototyped pointer also to the functions without a
+// prototype with its return type.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_CALLGRAPH_H
+#define SLANG_CALLGRAPH_H
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace slang {
+
+// A strongly connected component of the call graph.
+class CallGraphScc {
+  public:
+    std::vector<std::string> funcNames; // sorted
+    // SCCs at the same level do not call each other (leaves are at level 0)
+    uint32_t level;
+};
+
+class CallGraph {
+  public:
+    /** Add a function, e.g. ("f:main", "types.FuncSig(returnType=...)");
+     *  its signature is "" if unknown (it is then not called indirectly).
+     */
+    void addFunction(const std::string &funcName, const std::string &funcSig);
+
+    /** Add a direct call edge. */
+    void addCall(const std::string &caller, const std::string &callee);
+
+    /** Add a call, from caller, through a pointer to a function of type funcSig. */
+    void addIndirectCall(const std::string &caller, const std::string &funcSig);
+
+    /** Resolve the indirect calls and compute the SCCs. */
+    void computeSccs();
+
+    /** @return the sorted callees of a function (after computeSccs()). */
+    std::vector<std::string> getCallees(const std::string &funcName) const;
+
+    /** @return the SCCs in bottom-up (reverse topological) order. */
+    const std::vector<CallGraphScc> &getSccs() const { return sccs; }
+
+    /** @return the call graph, as `callGraph` and `callGraphSccs` python entries. */
+    std::string toString(const std::string &indent) const;
+
+  private:
+    std::map<std::string, std::string> funcSigs; // sorted, for a stable output
+    std::map<std::string, std::set<std::string>> callees;
+    std::map<std::string, std::set<std::string>> indirectCallSigs;
+    std::vector<CallGraphScc> sccs;
+
+    // Tarjan's algorithm state
+    std::vector<std::string> names;
+    std::vector<std::vector<uint32_t>> succs;
+    std::vector<int32_t> index;
+    std::vector<int32_t> lowLink;
+    std::vector<bool> onStack;
+    std::vector<uint32_t> stack;
+    std::vector<int32_t> sccOf;
+    int32_t nextIndex;
+
+    void strongConnect(uint32_t root);
+    void computeLevels();
+};
+
+} // namespace slang
+
+#endif // SLANG_CALLGRAPH_H
@@ -0,0 +1,173 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// The changed line ranges of some files (e.g. of a patch).
+//===----------------------------------------------------------------------===//
+
+#include "SlangChangedLines.h"
+
+#include <algorithm>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace slang;
+
+bool ChangedLines::readFile(const std::string &path, std::string &error) {
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (!buffer) {
+        error = "cannot read '" + path + "': " + buffer.getError().message();
+        return false;
+    }
+    parse((*buffer)->getBuffer());
+    return true;
+}
+
+void ChangedLines::parse(llvm::StringRef text) {
+    if (text.startswith("diff ") || text.startswith("--- ") ||
+        text.find("\n+++ ") != llvm::StringRef::npos) {
+        parseDiff(text);
+    } else {
+        parseRangeLines(text);
+    }
+}
+
+// BOUND START: parsing
+
+// the hunks of a unified diff, e.g.
+//     +++ b/src/list.c
+//     @@ -10,3 +10,5 @@ int main() {
+void ChangedLines::parseDiff(llvm::StringRef text) {
+    llvm::SmallVector<llvm::StringRef, 128> lines;
+    text.split(lines, '\n', -1, /*KeepEmpty=*/false);
+
+    llvm::StringRef fileName;
+    for (llvm::StringRef line : lines) {
+        line = line.rtrim("\r");
+        if (line.startswith("+++ ")) {
+            fileName = line.drop_front(4).split('\t').first.rtrim(); // drop a timestamp
+            if (fileName == "/dev/null") {
+                fileName = ""; // the file is deleted
+            } else if (fileName.startswith("b/")) {
+                fileName = fileName.drop_front(2);
+            }
+        } else if (line.startswith("@@ ") && !fileName.empty()) {
+            // the new side: +START[,COUNT]
+            llvm::StringRef newSide = line.drop_front(3).split(' ').second.split(' ').first;
+            if (!newSide.startswith("+")) {
+                continue;
+            }
+            llvm::StringRef startStr = newSide.drop_front(1).split(',').first;
+            llvm::StringRef countStr = newSide.drop_front(1).split(',').second;
+            uint32_t start, count = 1;
+            if (startStr.getAsInteger(10, start) ||
+                (!countStr.empty() && countStr.getAsInteger(10, count))) {
+                continue;
+            }
+            if (count == 0) {
+                // lines deleted between start and start + 1
+                addRange(fileName, start > 0 ? start : 1, start + 1);
+            } else {
+                addRange(fileName, start, start + count - 1);
+            }
+        }
+    }
+} // parseDiff()
+
+// lines of FILE:START-END[,START-END...]
+void ChangedLines::parseRangeLines(llvm::StringRef text) {
+    llvm::SmallVector<llvm::StringRef, 32> lines;
+    text.split(lines, '\n', -1, /*KeepEmpty=*/false);
+
+    for (llvm::StringRef line : lines) {
+        line = line.trim();
+        llvm::StringRef fileName = line.rsplit(':').first;
+        llvm::StringRef rangesStr = line.rsplit(':').second;
+        if (line.empty() || line.startswith("#") || fileName == line) {
+            continue; // a comment, or no ranges
+        }
+
+        llvm::SmallVector<llvm::StringRef, 8> rangeStrs;
+        rangesStr.split(rangeStrs, ',', -1, /*KeepEmpty=*/false);
+        for (llvm::StringRef rangeStr : rangeStrs) {
+            llvm::StringRef startStr = rangeStr.split('-').first.trim();
+            llvm::StringRef endStr = rangeStr.split('-').second.trim();
+            uint32_t start, end;
+            if (startStr.getAsInteger(10, start)) {
+                continue;
+            }
+            if (endStr.empty()) {
+                end = start; // a single line
+            } else if (endStr.getAsInteger(10, end)) {
+                continue;
+            }
+            addRange(fileName, start, end);
+        }
+    }
+} // parseRangeLines()
+
+// BOUND END  : parsing
+
+void ChangedLines::addRange(llvm::StringRef fileName, uint32_t start, uint32_t end) {
+    if (start > end) {
+        std::swap(start, end);
+    }
+    RangeVector &fileRanges = ranges[fileName];
+
+    // insert in order, then merge with the overlapping (or adjacent) neighbours
+    auto it = std::lower_bound(fileRanges.begin(), fileRanges.end(),
+                               std::make_pair(start, end));
+    it = fileRanges.insert(it, std::make_pair(start, end));
+    if (it != fileRanges.begin() && (it - 1)->second + 1 >= it->first) {
+        --it;
+        it->second = std::max(it->second, (it + 1)->second);
+        fileRanges.erase(it + 1);
+    }
+    while (it + 1 != fileRanges.end() && it->second + 1 >= (it + 1)->first) {
+        it->second = std::max(it->second, (it + 1)->second);
+        fileRanges.erase(it + 1);
+    }
+}
+
+bool ChangedLines::intersects(llvm::StringRef fileName, uint32_t start, uint32_t end) const {
+    const RangeVector *fileRanges = findFile(fileName);
+    if (!fileRanges) {
+        return false;
+    }
+
+    // the first range that ends at or after start
+    auto it = std::lower_bound(
+        fileRanges->begin(), fileRanges->end(), start,
+        [](const std::pair<uint32_t, uint32_t> &range, uint32_t line) {
+            return range.second < line;
+        });
+    return it != fileRanges->end() && it->first <= end;
+}
+
+// true if longName is shortName, or ends with "/" + shortName
+static bool isPathSuffix(llvm::StringRef longName, llvm::StringRef shortName) {
+    return longName.endswith(shortName) &&
+           (longName.size() == shortName.size() ||
+            longName[longName.size() - shortName.size() - 1] == '/');
+}
+
+const ChangedLines::RangeVector *ChangedLines::findFile(llvm::StringRef fileName) const {
+    auto found = ranges.find(fileName);
+    if (found != ranges.end()) {
+        return &found->second;
+    }
+
+    fileName.consume_front("./");
+    for (const auto &entry : ranges) {
+        llvm::StringRef entryName = entry.getKey();
+        entryName.consume_front("./");
+        if (isPathSuffix(fileName, entryName) || isPathSuffix(entryName, fileName)) {
+            return &entry.getValue();
+        }
+    }
+    return nullptr;
+}
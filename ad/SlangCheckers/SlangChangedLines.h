@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// The changed line ranges of some files (e.g. of a patch).
+//
+// They scope the lowering to the functions a patch touches. They are read
+// from a unified diff (e.g. the output of `git diff -U0`), taking the
+// lines of the new side of each hunk, or from lines of the form,
+//
+//     FILE:START-END[,START-END...]
+//
+// e.g. "src/list.c:10-20,31-31". A file name matches the name Clang uses
+// if one ends with the other (on a path boundary), as the diff names are
+// relative to the root of the repository.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_CHANGEDLINES_H
+#define SLANG_CHANGEDLINES_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace slang {
+
+class ChangedLines {
+  public:
+    /** Reads the ranges from a file (see above). @return false on an I/O error. */
+    bool readFile(const std::string &path, std::string &error);
+
+    /** Adds the ranges in the text (a unified diff, or FILE:RANGES lines). */
+    void parse(llvm::StringRef text);
+
+    /** Adds the lines start..end (both inclusive) of the file. */
+    void addRange(llvm::StringRef fileName, uint32_t start, uint32_t end);
+
+    /** @return true if a changed line of the file is in start..end. */
+    bool intersects(llvm::StringRef fileName, uint32_t start, uint32_t end) const;
+
+    /** @return the number of files with changes. */
+    size_t getFileCount() const { return ranges.size(); }
+
+  private:
+    typedef std::vector<std::pair<uint32_t, uint32_t>> RangeVector;
+
+    // file name -> its ranges, sorted and disjoint (see addRange())
+    llvm::StringMap<RangeVector> ranges;
+
+    void parseDiff(llvm::StringRef text);
+    void parseRangeLines(llvm::StringRef text);
+    const RangeVector *findFile(llvm::StringRef fileName) const;
+};
+
+} // namespace slang
+
+#endif // SLANG_CHANGEDLINES_H
@@ -0,0 +1,213 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// A flat map for the lowering tables, which are keyed by a Decl* cast to
+// uint64_t (or by a small unique id, for the temporaries).
+//
+// The entries (key, value) are kept densely, in insertion order, in chunks
+// of CHUNK_SIZE entries that never move: a reference to a value stays
+// valid while the map grows (currFunc points into the funcMap, and
+// SlangRecordField::slangRecord into the recordMap). An open addressing
+// table of 4 byte slots finds them: each slot packs the index of an entry
+// (24 bits) and the low 8 bits of its key's hash, so most probes of another
+// key are rejected without touching its entry. An empty slot costs 4 bytes,
+// not a whole value (as in an llvm::DenseMap of the values), and an entry
+// costs no node of its own (as in a std::unordered_map). The table is at
+// most 3/4 full.
+//
+// The keys are hashed with all their bits (fibonacci hashing): the low bits
+// of an aligned pointer are always zero. Entries are never erased.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_DECLMAP_H
+#define SLANG_DECLMAP_H
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace slang {
+
+template <typename ValueT> class DeclMap {
+  public:
+    typedef std::pair<uint64_t, ValueT> EntryT;
+
+    /** Iterates the entries in insertion order. */
+    template <typename MapT, typename RefT> class Iterator {
+      public:
+        Iterator(MapT *map, uint32_t index) : map{map}, index{index} {}
+        RefT operator*() const { return map->getEntry(index); }
+        typename std::remove_reference<RefT>::type *operator->() const {
+            return &map->getEntry(index);
+        }
+        Iterator &operator++() {
+            ++index;
+            return *this;
+        }
+        bool operator==(const Iterator &other) const { return index == other.index; }
+        bool operator!=(const Iterator &other) const { return index != other.index; }
+
+      private:
+        MapT *map;
+        uint32_t index;
+    };
+    typedef Iterator<DeclMap, EntryT &> iterator;
+    typedef Iterator<const DeclMap, const EntryT &> const_iterator;
+
+    DeclMap() : numEntries{0} {}
+    DeclMap(const DeclMap &other) : numEntries{0} { *this = other; }
+    DeclMap(DeclMap &&other) noexcept : numEntries{0} { *this = std::move(other); }
+    ~DeclMap() { clear(); }
+
+    DeclMap &operator=(const DeclMap &other) {
+        if (this != &other) {
+            clear();
+            for (const EntryT &entry : other) {
+                (*this)[entry.first] = entry.second;
+            }
+        }
+        return *this;
+    }
+
+    DeclMap &operator=(DeclMap &&other) noexcept {
+        if (this != &other) {
+            clear();
+            chunks = std::move(other.chunks);
+            slots = std::move(other.slots);
+            numEntries = other.numEntries;
+            other.numEntries = 0;
+        }
+        return *this;
+    }
+
+    /** @return the value of key, default constructed if it is new. */
+    ValueT &operator[](uint64_t key) {
+        uint32_t tag;
+        size_t slot = findSlot(key, tag);
+        if (!slots.empty() && slots[slot]) {
+            return getEntry((slots[slot] >> TAG_BITS) - 1).second;
+        }
+
+        if ((size_t)(numEntries + 1) * 4 > slots.size() * 3) { // at most 3/4 full
+            grow();
+            slot = findSlot(key, tag);
+        }
+        if ((numEntries & (CHUNK_SIZE - 1)) == 0) {
+            chunks.emplace_back(new Storage[CHUNK_SIZE]);
+        }
+        new (&chunks.back()[numEntries & (CHUNK_SIZE - 1)]) EntryT(key, ValueT());
+        numEntries += 1;
+        slots[slot] = (numEntries << TAG_BITS) | (tag & TAG_MASK);
+        return getEntry(numEntries - 1).second;
+    }
+
+    bool count(uint64_t key) const { return find(key) != end(); }
+
+    iterator find(uint64_t key) {
+        uint32_t tag;
+        size_t slot = findSlot(key, tag);
+        return iterator(this, slots.empty() || !slots[slot] ? numEntries
+                                                            : (slots[slot] >> TAG_BITS) - 1);
+    }
+
+    const_iterator find(uint64_t key) const {
+        uint32_t tag;
+        size_t slot = findSlot(key, tag);
+        return const_iterator(this, slots.empty() || !slots[slot] ? numEntries
+                                                                  : (slots[slot] >> TAG_BITS) - 1);
+    }
+
+    size_t size() const { return numEntries; }
+    bool empty() const { return numEntries == 0; }
+
+    /** @return the bytes held by the map (not counting what the values own). */
+    size_t getMemorySize() const {
+        return chunks.capacity() * sizeof(chunks[0]) +
+               chunks.size() * CHUNK_SIZE * sizeof(EntryT) + slots.capacity() * sizeof(Slot);
+    }
+
+    void clear() {
+        for (uint32_t i = 0; i < numEntries; ++i) {
+            getEntry(i).~EntryT();
+        }
+        chunks.clear();
+        slots.clear();
+        numEntries = 0;
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, numEntries); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, numEntries); }
+
+  private:
+    enum : uint32_t {
+        CHUNK_SIZE = 64, // a power of two
+        TAG_BITS = 8,
+        TAG_MASK = (1u << TAG_BITS) - 1,
+        MAX_ENTRIES = (1u << (32 - TAG_BITS)) - 2,
+    };
+
+    typedef typename std::aligned_storage<sizeof(EntryT), alignof(EntryT)>::type Storage;
+
+    // (the index of the entry + 1) << TAG_BITS | (the low bits of the tag),
+    // 0 if the slot is empty
+    typedef uint32_t Slot;
+
+    std::vector<std::unique_ptr<Storage[]>> chunks;
+    std::vector<Slot> slots; // a power of two of them
+    uint32_t numEntries;
+
+    EntryT &getEntry(uint32_t index) const {
+        return *reinterpret_cast<EntryT *>(&chunks[index / CHUNK_SIZE][index % CHUNK_SIZE]);
+    }
+
+    // fibonacci hashing: the high half of the product depends on all the bits
+    static uint32_t hash(uint64_t key) { return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32); }
+
+    // @return the slot of the key, or the empty slot where it goes
+    size_t findSlot(uint64_t key, uint32_t &tag) const {
+        tag = hash(key);
+        if (slots.empty()) {
+            return 0;
+        }
+        size_t mask = slots.size() - 1;
+        for (size_t slot = (tag >> TAG_BITS) & mask;; slot = (slot + 1) & mask) {
+            Slot s = slots[slot];
+            if (!s || ((s & TAG_MASK) == (tag & TAG_MASK) &&
+                       getEntry((s >> TAG_BITS) - 1).first == key)) {
+                return slot;
+            }
+        }
+    }
+
+    void grow() {
+        assert(numEntries < MAX_ENTRIES);
+        std::vector<Slot> old;
+        old.swap(slots);
+        slots.assign(old.empty() ? 16 : old.size() * 2, 0);
+        size_t mask = slots.size() - 1;
+        for (Slot s : old) {
+            if (s) {
+                // (the slot only keeps the low bits of the hash)
+                size_t slot = (hash(getEntry((s >> TAG_BITS) - 1).first) >> TAG_BITS) & mask;
+                while (slots[slot]) {
+                    slot = (slot + 1) & mask;
+                }
+                slots[slot] = s;
+            }
+        }
+    }
+};
+
+} // namespace slang
+
+#endif // SLANG_DECLMAP_H
@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// Runs the SPAN diagnoses in a python interpreter embedded in the checker.
+// (Empty unless SLANG_EMBED_PYTHON is defined.)
+//===----------------------------------------------------------------------===//
+
+#ifdef SLANG_EMBED_PYTHON
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h> // first, as python requires
+
+#include "SlangEmbeddedPython.h"
+
+#include <mutex>
+
+#define SPAN_EMBEDDED_MODULE "span.util.embedded"
+
+using namespace slang;
+
+namespace {
+
+std::once_flag pythonStarted;
+
+// starts the interpreter once (and never stops it: some extension
+// modules cannot be loaded again), releasing the GIL for PyGILState_Ensure()
+void startPython() {
+    std::call_once(pythonStarted, []() {
+        if (!Py_IsInitialized()) {
+            Py_InitializeEx(0); // no signal handlers
+            PyEval_SaveThread();
+        }
+    });
+}
+
+// @return the message of the pending python exception (and clears it)
+std::string fetchError() {
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    std::string message = "unknown python error";
+    PyObject *str = value ? PyObject_Str(value) : (type ? PyObject_Str(type) : nullptr);
+    if (str) {
+        const char *utf8 = PyUnicode_AsUTF8(str);
+        if (utf8) {
+            message = utf8;
+        }
+        Py_DECREF(str);
+    }
+    PyErr_Clear();
+    Py_XDECREF(type);
+    Py_XDECREF(value);
+    Py_XDECREF(traceback);
+    return message;
+}
+
+// a python str as a std::string ("" if it is not a str)
+std::string toString(PyObject *str) {
+    Py_ssize_t size = 0;
+    const char *utf8 = str ? PyUnicode_AsUTF8AndSize(str, &size) : nullptr;
+    if (!utf8) {
+        PyErr_Clear();
+        return "";
+    }
+    return std::string(utf8, size);
+}
+
+// converts a (name, category, [(line, col, msg), ...]) tuple
+bool toBug(PyObject *item, Bug &bug) {
+    PyObject *messages = nullptr;
+    PyObject *name = nullptr, *category = nullptr;
+    if (!PyArg_ParseTuple(item, "UUO", &name, &category, &messages)) {
+        return false;
+    }
+
+    PyObject *messageSeq = PySequence_Fast(messages, "the bug messages must be a list");
+    if (!messageSeq) {
+        return false;
+    }
+    std::vector<BugMessage> bugMessages;
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(messageSeq); ++i) {
+        unsigned int line, col;
+        PyObject *message;
+        if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(messageSeq, i), "IIU", &line, &col,
+                              &message)) {
+            Py_DECREF(messageSeq);
+            return false;
+        }
+        bugMessages.push_back(BugMessage(line, col, toString(message)));
+    }
+    Py_DECREF(messageSeq);
+
+    bug = Bug(toString(name), toString(category), bugMessages);
+    return true;
+} // toBug()
+
+// calls span.util.embedded.diagnose(spanIr, diagnoses) (the GIL is held)
+bool callDiagnose(llvm::StringRef spanIr, llvm::StringRef diagnoses, llvm::StringRef spanPath,
+                  std::vector<Bug> &bugs) {
+    if (!spanPath.empty()) {
+        PyObject *sysPath = PySys_GetObject("path"); // borrowed
+        PyObject *path = PyUnicode_FromStringAndSize(spanPath.data(), spanPath.size());
+        int found = (sysPath && path) ? PySequence_Contains(sysPath, path) : -1;
+        if (found == 0) {
+            found = PyList_Insert(sysPath, 0, path);
+        }
+        Py_XDECREF(path);
+        if (found < 0) {
+            return false;
+        }
+    }
+
+    PyObject *module = PyImport_ImportModule(SPAN_EMBEDDED_MODULE);
+    if (!module) {
+        return false;
+    }
+    PyObject *result = PyObject_CallMethod(module, "diagnose", "s#s#", spanIr.data(),
+                                           (Py_ssize_t)spanIr.size(), diagnoses.data(),
+                                           (Py_ssize_t)diagnoses.size());
+    Py_DECREF(module);
+    if (!result) {
+        return false;
+    }
+
+    PyObject *resultSeq = PySequence_Fast(result, "diagnose() must return a list");
+    Py_DECREF(result);
+    if (!resultSeq) {
+        return false;
+    }
+    bool ok = true;
+    for (Py_ssize_t i = 0; ok && i < PySequence_Fast_GET_SIZE(resultSeq); ++i) {
+        Bug bug;
+        ok = toBug(PySequence_Fast_GET_ITEM(resultSeq, i), bug);
+        if (ok && !bug.messages.empty()) {
+            bugs.push_back(bug);
+        }
+    }
+    Py_DECREF(resultSeq);
+    return ok;
+} // callDiagnose()
+
+} // anonymous namespace
+
+bool slang::runSpanDiagnoses(llvm::StringRef spanIr, llvm::StringRef diagnoses,
+                             llvm::StringRef spanPath, std::vector<Bug> &bugs,
+                             std::string &error) {
+    startPython();
+
+    PyGILState_STATE gilState = PyGILState_Ensure();
+    bool ok = callDiagnose(spanIr, diagnoses, spanPath, bugs);
+    if (!ok) {
+        error = fetchError();
+    }
+    PyGILState_Release(gilState);
+    return ok;
+}
+
+#endif // SLANG_EMBED_PYTHON
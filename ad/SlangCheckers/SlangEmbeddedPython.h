@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// Runs the SPAN diagnoses in a python interpreter embedded in the checker.
+//
+// Instead of writing the SPAN IR, running span on it (which writes a
+// .spanreport) and running the SlangBugReporterChecker on the source again,
+// the SlangGenAst checker hands the IR of the TU (in memory) to
+// span.util.embedded.diagnose() and reports the bugs it returns itself.
+//
+// It needs SLANG built with SLANG_EMBED_PYTHON defined, and linked with
+// libpython3 (e.g. the flags of `python3-config --includes --ldflags --embed`).
+// The interpreter is started on the first use and kept for the process.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_EMBEDDEDPYTHON_H
+#define SLANG_EMBEDDEDPYTHON_H
+
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+
+#include "SlangBug.h"
+
+namespace slang {
+
+/** Runs the diagnoses (comma separated names, e.g. "DeadStore") on the SPAN
+ *  IR of a TU. spanPath is the directory of the span package ("" if it is
+ *  on the PYTHONPATH).
+ *  @return false on an error (a python exception, in error).
+ */
+bool runSpanDiagnoses(llvm::StringRef spanIr, llvm::StringRef diagnoses,
+                      llvm::StringRef spanPath, std::vector<Bug> &bugs, std::string &error);
+
+} // namespace slang
+
+#endif // SLANG_EMBEDDEDPYTHON_H
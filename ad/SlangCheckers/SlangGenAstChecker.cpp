@@ -12,6 +12,91 @@
 //      clang --analyze -Xanalyzer -analyzer-checker=debug.slanggen test.c |& tee mylog
 //
 //  which generates the file `test.c.spanir`.
+//
+//  The SlangDeadStoreChecker (named `SlangDeadStore` in Checkers.td) lowers
+//  each function the same way and reports dead stores found by the native
+//  liveness analysis directly, without the SPAN (.spanreport) round trip,
+//
+//      clang --analyze -Xanalyzer -analyzer-checker=debug.SlangDeadStore test.c
+//
+//  Its results are reused across runs and translation units if the checker
+//  option `SummaryCacheDir` names a (shared) cache directory,
+//
+//      -Xanalyzer -analyzer-config -Xanalyzer debug.SlangDeadStore:SummaryCacheDir=/tmp/slang
+//
+//  With the same option, either checker also keeps the lowered form of each
+//  function there, and reuses it (without lowering again) while the function's
+//  body and the types it uses are unchanged; only the edited functions of a
+//  file are lowered again.
+//
+//  The functions are analyzed at the end of the translation unit, with the
+//  checker option `Threads=N` on N threads, and the dead stores reported
+//  in the order of the function names, whatever N.
+//
+//  The SPAN IR is streamed out a function at a time. The checker option
+//  `Output` redirects it (see SlangOutputSink.h): `file:PATH`, an inherited
+//  `fd:N`, a named `pipe:PATH`, `memory` or `null`. It is written on a
+//  background thread unless `AsyncOutput=false`,
+//
+//      -Xanalyzer -analyzer-config -Xanalyzer debug.SlangGenAst:Output=fd:3
+//
+//  With the checker option `ChangedLines=PATH` (a unified diff, e.g. of
+//  `git diff -U0`, see SlangChangedLines.h) only the functions overlapping a
+//  changed line are lowered (and checked); the others are only declared,
+//
+//      -Xanalyzer -analyzer-config -Xanalyzer debug.SlangDeadStore:ChangedLines=patch.diff
+//
+//  Likewise `MainFileOnly=true`, `FunctionInclude=REGEX`, `FunctionExclude=REGEX`,
+//  `MaxFunctionLines=N` and `EntryFunctions=main,...` (only the functions
+//  reachable from these) filter the functions (see isInScope()).
+//
+//  With the checker option `PointsTo` set, SlangGenAst also runs the native
+//  points-to analysis on the whole translation unit and writes its result
+//  to `test.c.spanpts` (a python dict: variable name -> objects),
+//
+//      clang --analyze -Xanalyzer -analyzer-checker=debug.SlangGenAst \
+//          -Xanalyzer -analyzer-config -Xanalyzer debug.SlangGenAst:PointsTo=true test.c
+//
+//  Built with SLANG_EMBED_PYTHON (see SlangEmbeddedPython.h), the checker
+//  option `Diagnoses=NAME[,NAME...]` runs these SPAN diagnoses in the checker
+//  process, on the IR kept in memory, and reports their bugs directly (the
+//  option `SpanPath` names the directory of the span package),
+//
+//      -Xanalyzer -analyzer-config -Xanalyzer debug.SlangGenAst:Diagnoses=DeadStore
+//
+//  With the checker option `IrIndex=true` a small index is written next to
+//  the SPAN IR file, `test.c.spanir.idx` (see dumpIrIndex()): the byte offset
+//  and length of each function, and of the variables and the records, so
+//  that a reader can map the file and parse only the functions it needs.
+//  (Those written to the SharedIrDir, see below, are in neither.)
+//
+//  With `Output=shards:DIR` (or `shards`, for DIR `test.c.shards`) the IR is
+//  split for parallel consumers (see dumpShards()): the functions, in bundles
+//  of about `ShardSize` bytes (1 MiB; 0 for a function a bundle) balanced by
+//  size, go to the shards `DIR/test.c.N.spanir`, and the records, the
+//  global variables, the signatures of the functions, the call graph and the
+//  list of the shards to the manifest `DIR/test.c.spanir.manifest`.
+//
+//  With `SharedIrDir=DIR` the functions and the records defined in the
+//  headers (e.g. static inline functions) are written once for all the TUs,
+//  to the content addressed store DIR (see emitShared()); the SPAN IR of a
+//  TU only names them, by the hash of their text, in `sharedConstructs`
+//  (not with the `shards` and `memory` outputs). slang-irlink and
+//  span.ir.irload put them back in.
+//
+//  The layout of the types, as the ASTContext computes it for the target, is
+//  written in the `typeLayouts` dict (see dumpTypeLayouts()): the size and
+//  alignment of each type used, and the offset (and bit width) of each
+//  member of the records, so that a field sensitive analysis needs no
+//  sizeof of its own.
+//
+//  The global variables of internal linkage (static, and the static locals)
+//  are listed in `internalVars`: slang-irlink keeps them per TU.
+//
+//  The types in the functions and the variables are written once, in the
+//  `allTypes` list at the end, and referred to by their index, as `T(3)`
+//  (see SlangTypeTable.h). The option `TypeTable=false` writes them in full
+//  (as do the `shards` output and the SharedIrDir entries).
 //===----------------------------------------------------------------------===//
 
 //#include "ClangSACheckers.h"
@@ -20,20 +105,47 @@
 #include "clang/AST/Expr.h" //AD
 #include "clang/AST/Stmt.h" //AD
 #include "clang/AST/Type.h" //AD
+#include "clang/AST/ODRHash.h"
+#include "clang/AST/RecordLayout.h"
 #include "clang/Analysis/CFG.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/StaticAnalyzer/Core/BugReporter/BugReporter.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/BugType.h"
 #include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/Regex.h"
+#include "llvm/Support/StringSaver.h"
 #include "llvm/Support/raw_ostream.h" //AD
 #include <fstream>                    //AD
-#include <iomanip>                    //AD for std::fixed
+#include <map>                        //AD
+#include <memory>                     //AD
+#include <set>                        //AD
+#include <algorithm>                  //AD
 #include <sstream>                    //AD
 #include <string>                     //AD
 #include <unordered_map>              //AD
 #include <utility>                    //AD
 #include <vector>                     //AD
 
+#include "SlangBug.h"
+#include "SlangBuffer.h"
+#include "SlangCallGraph.h"
+#include "SlangChangedLines.h"
+#include "SlangDeclMap.h"
+#include "SlangEmbeddedPython.h"
+#include "SlangLiveness.h"
+#include "SlangOutputSink.h"
+#include "SlangPointsTo.h"
+#include "SlangScheduler.h"
+#include "SlangSummaryCache.h"
+#include "SlangSymbolTable.h"
+#include "SlangTypeTable.h"
 #include "SlangUtil.h"
 
 using namespace slang;
@@ -53,6 +165,10 @@ typedef std::vector<const Stmt *> StmtVector;
 
 #define VAR_NAME_PREFIX "v:"
 #define FUNC_NAME_PREFIX "f:"
+// the id of the dead store results in the SummaryCache (bump if they change)
+#define DEAD_STORE_ANALYSIS_ID "slang.deadstore.v1"
+// the id of the lowered functions in the SummaryCache (bump if the lowering changes)
+#define SPAN_IR_CACHE_ID "slang.spanir.v4"
 
 #define DONT_PRINT "DONT_PRINT"
 #define NULL_STMT "NULL_STMT"
@@ -66,11 +182,18 @@ namespace {
 enum EdgeLabel { FalseEdge = 0, TrueEdge = 1, UnCondEdge = 2 };
 enum SlangRecordKind { Struct = 0, Union = 1 };
 
+// interned names of variables, functions, records and fields (of the TU);
+// the lowering carries their ids and the text of a name is materialized
+// once, when a statement's text (the lowered form) or a dump first uses it.
+SymbolTable symbols;
+
 class SlangExpr {
 public:
-  std::string expr;
+  // in the arena of the function being lowered (see SlangTranslationUnit::save()),
+  // or a literal: a SlangExpr is copied freely, without any heap allocation
+  llvm::StringRef expr;
   bool compound;
-  std::string locStr;
+  std::string locStr; // e.g. "Loc(12,3)": short enough for no heap allocation
   QualType qualType;
   bool nonTmpVar;
   uint64_t varId;
@@ -85,7 +208,7 @@ public:
   };
 
   std::string toString() {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "SlangExpr:\n";
     ss << "  Expr     : " << expr << "\n";
     ss << "  ExprType : " << qualType.getAsString() << "\n";
@@ -100,32 +223,35 @@ class SlangVar {
 public:
   uint64_t id;
   // variable name: e.g. a variable 'x' in main function, is "v:main:x".
-  std::string name;
+  SymbolId nameId;
   std::string typeStr;
+  // a global of internal (or no) linkage, e.g. static: one per TU
+  bool internal;
 
-  SlangVar() {}
+  SlangVar() : id{0}, nameId{EMPTY_SYMBOL_ID}, internal{false} {}
 
-  SlangVar(uint64_t id, std::string name) {
+  SlangVar(uint64_t id, llvm::StringRef name) {
     // specially for anonymous member names (needed in member expressions)
     this->id = id;
-    this->name = name;
+    this->nameId = symbols.getString(name);
     this->typeStr = DONT_PRINT;
+    this->internal = false;
   }
 
+  const std::string &getName() const { return symbols.getName(nameId); }
+
   std::string convertToString() {
-    std::stringstream ss;
-    ss << "\"" << name << "\": " << typeStr << ",";
+    AppendBuffer ss;
+    ss << "\"" << getName() << "\": " << typeStr << ",";
     return ss.str();
   }
 
-  void setLocalVarName(std::string varName, std::string funcName) {
-    name = VAR_NAME_PREFIX;
-    name += funcName + ":" + varName;
+  void setLocalVarName(llvm::StringRef varName, llvm::StringRef funcName) {
+    nameId = symbols.getLocalVar(symbols.getString(funcName), symbols.getString(varName));
   }
 
-  void setGlobalVarName(std::string varName) {
-    name = VAR_NAME_PREFIX;
-    name += varName;
+  void setGlobalVarName(llvm::StringRef varName) {
+    nameId = symbols.getGlobalVar(symbols.getString(varName));
   }
 }; // class SlangVar
 
@@ -135,18 +261,63 @@ public:
   std::string name;     // e.g. 'main'
   std::string fullName; // e.g. 'f:main'
   std::string retType;
-  std::vector<std::string> paramNames;
+  std::vector<SymbolId> paramNameIds; // the text is built when dumped
   bool variadic;
+  std::string funcSig; // e.g. types.FuncSig(returnType=types.Int32, paramTypes=[])
+
+  // the call graph edges
+  std::set<std::string> callees; // directly called functions
+  std::set<std::string> indirectCallSigs; // the funcSig of functions called through pointers
 
   uint32_t tmpVarCount;
+  uint32_t labelCount; // labels are local to the function
   const Stmt *lastDeclStmt;
-
-  std::vector<std::string> spanStmts;
-
-  SlangFunc() {
+  // the lowering refers to an anonymous record (named by its position)
+  bool usesAnonymousRecord;
+  // defined in an included file (see SlangTranslationUnit::emitShared())
+  bool inHeader;
+  // its body is lowered (or reused from the cache) in this TU
+  bool lowered;
+
+  // the source position, to order the output (see SlangTranslationUnit::dumpFunctions())
+  uint32_t line;
+  uint32_t col;
+
+  // the text of the statements (and of the SlangExprs they are built
+  // from) lives in the arena of the function, and is freed in bulk with it
+  // (see SlangTranslationUnit::reset()), or as soon as it is emitted (see
+  // releaseStmts())
+  std::unique_ptr<llvm::BumpPtrAllocator> arena;
+  std::vector<llvm::StringRef> spanStmts;
+
+  SlangFunc() : arena{new llvm::BumpPtrAllocator()} {
     variadic = false;
-    paramNames = std::vector<std::string>{};
     tmpVarCount = 0;
+    labelCount = 0;
+    usesAnonymousRecord = false;
+    inHeader = false;
+    lowered = false;
+    line = 0;
+    col = 0;
+  }
+
+  void addStmt(llvm::StringRef spanStmt) { spanStmts.push_back(save(spanStmt)); }
+
+  // @return a copy of the text in the arena of the function
+  llvm::StringRef save(llvm::StringRef text) { return llvm::StringSaver(*arena).save(text); }
+
+  // frees the statements (and all the slabs of the arena)
+  void releaseStmts() {
+    std::vector<llvm::StringRef>().swap(spanStmts);
+    arena.reset(new llvm::BumpPtrAllocator());
+  }
+
+  std::vector<std::string> getParamNames() const {
+    std::vector<std::string> paramNames;
+    for (SymbolId paramNameId : paramNameIds) {
+      paramNames.push_back(symbols.getName(paramNameId));
+    }
+    return paramNames;
   }
 }; // class SlangFunc
 
@@ -155,28 +326,34 @@ class SlangRecord;
 class SlangRecordField {
 public:
   bool anonymous;
-  std::string name;
+  SymbolId nameId;
   std::string typeStr;
   SlangRecord *slangRecord;
   QualType type;
+  uint64_t offset;   // in bits, from the start of the record
+  uint32_t bitWidth; // 0 if not a bit-field
 
-  SlangRecordField() : anonymous{false}, name{""}, typeStr{""}, type{QualType()} {}
+  SlangRecordField()
+      : anonymous{false}, nameId{EMPTY_SYMBOL_ID}, typeStr{""}, type{QualType()}, offset{0},
+        bitWidth{0} {}
 
-  std::string getName() const { return name; }
+  const std::string &getName() const { return symbols.getName(nameId); }
 
   std::string toString() {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "("
-       << "\"" << name << "\"";
+       << "\"" << getName() << "\"";
     ss << ", " << typeStr << ")";
     return ss.str();
   }
 
   void clear() {
     anonymous = false;
-    name = "";
+    nameId = EMPTY_SYMBOL_ID;
     typeStr = "";
     type = QualType();
+    offset = 0;
+    bitWidth = 0;
   }
 }; // class SlangRecordField
 
@@ -185,29 +362,42 @@ class SlangRecord {
 public:
   SlangRecordKind recordKind; // Struct, or Union
   bool anonymous;
-  std::string name;
+  SymbolId nameId; // e.g. "s:node"
   std::vector<SlangRecordField> members;
   std::string locStr;
+  uint32_t line; // the source position, to order the output
+  uint32_t col;
   int32_t nextAnonymousFieldId;
+  bool inHeader; // defined in an included file
+  // in bytes (0 if not known: the record is only declared)
+  uint64_t size;
+  uint64_t align;
 
   SlangRecord() {
     recordKind = Struct; // Struct, or Union
     anonymous = false;
-    name = "";
+    inHeader = false;
+    size = 0;
+    align = 0;
+    nameId = EMPTY_SYMBOL_ID;
+    line = 0;
+    col = 0;
     nextAnonymousFieldId = 0;
   }
 
   std::string getNextAnonymousFieldIdStr() {
-    std::stringstream ss;
+    AppendBuffer ss;
     nextAnonymousFieldId += 1;
     ss << nextAnonymousFieldId;
     return ss.str();
   }
 
+  const std::string &getName() const { return symbols.getName(nameId); }
+
   std::vector<SlangRecordField> getFields() const { return members; }
 
   std::string genMemberExpr(std::vector<uint32_t> indexVector) {
-    std::stringstream ss;
+    AppendBuffer ss;
 
     std::vector<std::string> members;
     SlangRecord *currentRecord = this;
@@ -216,7 +406,7 @@ public:
     llvm::errs() << "\n------------------------\n" << indexVector[0] << indexVector[1] << "\n";
     llvm::errs().flush();
     for (auto it = indexVector.begin(); it != indexVector.end(); ++it) {
-      members.push_back(currentRecord->members[*it].name);
+      members.push_back(currentRecord->members[*it].getName());
       if (currentRecord->members[*it].slangRecord != nullptr) {
         // means its a member of type record
         currentRecord = currentRecord->members[*it].slangRecord;
@@ -235,12 +425,12 @@ public:
   }
 
   std::string toString() {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << NBSP6;
     ss << ((recordKind == Struct) ? "types.Struct(\n" : "types.Union(\n");
 
     ss << NBSP8 << "name = ";
-    ss << "\"" << name << "\""
+    ss << "\"" << getName() << "\""
        << ",\n";
 
     std::string suffix = ",\n";
@@ -256,15 +446,28 @@ public:
     return ss.str();
   }
 
+  // (size, align, [(offset, bitWidth), ...]): a typeLayouts entry
+  std::string layoutToString() const {
+    AppendBuffer ss;
+    ss << "(" << size << ", " << align << ", [";
+    std::string prefix = "";
+    for (const SlangRecordField &member : members) {
+      ss << prefix << "(" << member.offset << ", " << member.bitWidth << ")";
+      prefix = ", ";
+    }
+    ss << "])";
+    return ss.str();
+  }
+
   std::string toShortString() {
-    std::stringstream ss;
+    AppendBuffer ss;
 
     if (recordKind == Struct) {
       ss << "types.Struct";
     } else {
       ss << "types.Union";
     }
-    ss << "(\"" << name << "\")";
+    ss << "(\"" << getName() << "\")";
 
     return ss.str();
   }
@@ -277,23 +480,65 @@ public:
   std::string fileName; // the current translation unit file name
   SlangFunc *currFunc;  // the current function being translated
 
-  uint32_t labelCount;
-
-  // to uniquely name anonymous records (see getNextRecordId())
-  int32_t recordId;
-
   // maps a unique variable id to its SlangVar.
-  std::unordered_map<uint64_t, SlangVar> varMap;
-  // map of var-name to a count:
+  DeclMap<SlangVar> varMap;
+  // the varMap ids of the locals of each function (by its name's symbol),
+  // for computeIrHash()
+  llvm::DenseMap<SymbolId, std::vector<uint64_t>> localVarIds;
+  // map of var-name (its symbol) to a count:
   // used in case two local variables have same name (blocks)
-  std::unordered_map<std::string, uint64_t> varCountMap;
-  // contains functions
-  std::unordered_map<uint64_t, SlangFunc> funcMap;
-  // contains structs
-  std::unordered_map<uint64_t, SlangRecord> recordMap;
+  llvm::DenseMap<SymbolId, uint32_t> varCountMap;
+  // map of anonymous record name (its symbol) to a count:
+  // used in case two anonymous records start at the same position
+  llvm::DenseMap<SymbolId, uint32_t> anonRecordCountMap;
+  // contains functions (stable: currFunc points into it)
+  DeclMap<SlangFunc> funcMap;
+  // contains structs (stable: SlangRecordField::slangRecord points into it)
+  DeclMap<SlangRecord> recordMap;
 
   // tracks variables that become dirty in an expression
-  std::unordered_map<uint64_t, SlangExpr> dirtyVars;
+  DeclMap<SlangExpr> dirtyVars;
+
+  // the ids of the variables added while logVars is set (see serializeFuncIr())
+  bool logVars;
+  std::vector<uint64_t> loggedVars;
+
+  // the type string (not of a record) -> (size, align) in bytes (see dumpTypeLayouts())
+  std::map<std::string, std::pair<uint64_t, uint64_t>> typeLayouts;
+  // the types whose layout is added while logVars is set (see serializeFuncIr())
+  std::set<std::string> loggedTypes;
+
+  // the functions lowered, those reused from the SummaryCache instead,
+  // and those only declared (out of scope, see SlangGenAstChecker::isInScope())
+  uint32_t loweredFuncCount;
+  uint32_t reusedFuncCount;
+  uint32_t skippedFuncCount;
+
+  // the functions (canonical decls) reachable from the entry functions
+  // named in reachableFrom (see SlangGenAstChecker::isReachable())
+  std::string reachableFrom;
+  DeclMap<bool> reachableFuncs;
+
+  // where the span ir is written (see beginSlangIr())
+  std::unique_ptr<OutputSink> irSink;
+  // the functions already written to the irSink
+  DeclMap<bool> emittedFuncs;
+  // the span ir of the last TU, with the "memory" output
+  std::string memoryIr;
+  // the bytes written to the irSink so far (see writeIr())
+  uint64_t irOffset;
+  // the entries of the index of the span ir (see dumpIrIndex())
+  std::string irIndex;
+  // the store of the functions and records of the headers, or "" (see emitShared())
+  std::string sharedIrDir;
+  // the constructs in the sharedIrDir: name -> hash of their text
+  std::map<std::string, std::string> sharedRefs;
+  // the "v:<func>:" prefix of the locals of the shared functions
+  std::set<std::string> sharedLocalPrefixes;
+  // the types of the functions and variables written out (see dumpTyped())
+  bool typeTableUsed;
+  TypeTable typeTable;
+  std::string typedText; // (reused)
 
   // vector of start and exit label of constructs which can contain break and continue stmts.
   std::vector<std::pair<std::string, std::string>> entryExitLabels;
@@ -320,39 +565,54 @@ public:
   }
 
   SlangTranslationUnit()
-      : uniqueId{0}, fileName{}, currFunc{nullptr}, recordId{0}, varMap{}, varCountMap{}, funcMap{}, dirtyVars{} {
+      : uniqueId{0}, fileName{}, currFunc{nullptr}, varMap{}, varCountMap{}, funcMap{}, dirtyVars{},
+        logVars{false}, loweredFuncCount{0}, reusedFuncCount{0},
+        skippedFuncCount{0}, irOffset{0}, typeTableUsed{false} {
   }
 
   // clear the buffer for the next function.
   void clear() {
     varMap.clear();
+    localVarIds.clear();
     dirtyVars.clear();
     varCountMap.clear();
   } // clear()
 
   uint32_t genNextLabelCount() {
-    labelCount += 1;
-    return labelCount;
+    currFunc->labelCount += 1;
+    return currFunc->labelCount;
   }
 
   std::string genNextLabelCountStr() {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << genNextLabelCount();
     return ss.str();
   }
 
-  void addStmt(std::string spanStmt) { currFunc->spanStmts.push_back(spanStmt); }
+  void addStmt(llvm::StringRef spanStmt) { currFunc->addStmt(spanStmt); }
 
-  void pushBackFuncParams(std::string paramName) {
-    SLANG_TRACE("AddingParam: " << paramName << " to func " << currFunc->name)
-    currFunc->paramNames.push_back(paramName);
+  // @return a copy of the text (e.g. of a SlangExpr) in the arena of the current function
+  llvm::StringRef save(llvm::StringRef text) { return currFunc->save(text); }
+
+  // Forgets the TU (and the symbols), but the memoryIr: a process may
+  // lower many TUs one after the other (e.g. a SlangServer).
+  void reset() {
+    std::string lastMemoryIr = std::move(memoryIr);
+    *this = SlangTranslationUnit();
+    memoryIr = std::move(lastMemoryIr);
+    symbols.clear();
+  }
+
+  void pushBackFuncParams(SymbolId paramNameId) {
+    SLANG_TRACE("AddingParam: " << symbols.getName(paramNameId) << " to func " << currFunc->name)
+    currFunc->paramNameIds.push_back(paramNameId);
   }
 
   void setFuncReturnType(std::string &retType) { currFunc->retType = retType; }
 
   void setVariadicness(bool variadic) { currFunc->variadic = variadic; }
 
-  std::string getCurrFuncName() {
+  const std::string &getCurrFuncName() {
     return currFunc->name; // not fullName
   }
 
@@ -365,7 +625,7 @@ public:
 
   const Stmt *getLastDeclStmt() const { return currFunc->lastDeclStmt; }
 
-  bool isNewVar(uint64_t varAddr) { return varMap.find(varAddr) == varMap.end(); }
+  bool isNewVar(uint64_t varAddr) { return !varMap.count(varAddr); }
 
   uint32_t nextTmpId() {
     currFunc->tmpVarCount += 1;
@@ -377,10 +637,26 @@ public:
     return uniqueId;
   }
 
-  void addVar(uint64_t varId, SlangVar &slangVar) { varMap[varId] = slangVar; }
+  void addVar(uint64_t varId, SlangVar &slangVar) {
+    varMap[varId] = slangVar;
+    SymbolId funcNameId = symbols.getScope(slangVar.nameId);
+    if (funcNameId != EMPTY_SYMBOL_ID) {
+      localVarIds[funcNameId].push_back(varId);
+    }
+    if (logVars) {
+      loggedVars.push_back(varId);
+    }
+  }
+
+  void addTypeLayout(const std::string &typeStr, uint64_t size, uint64_t align) {
+    typeLayouts[typeStr] = std::make_pair(size, align);
+    if (logVars) {
+      loggedTypes.insert(typeStr);
+    }
+  }
 
   bool isRecordPresent(uint64_t recordAddr) {
-    return !(recordMap.find(recordAddr) == recordMap.end());
+    return recordMap.count(recordAddr);
   }
 
   void addRecord(uint64_t recordAddr, SlangRecord slangRecord) {
@@ -389,51 +665,541 @@ public:
 
   SlangRecord &getRecord(uint64_t recordAddr) { return recordMap[recordAddr]; }
 
-  int32_t getNextRecordId() {
-    recordId += 1;
-    return recordId;
+  // Names an anonymous record by its position, e.g. "12_5" for line 12, column 5,
+  // so that the name does not depend on the order the records are seen in.
+  // (A digit first: it cannot clash with a named record.)
+  SymbolId getAnonymousRecordName(uint32_t line, uint32_t col) {
+    AppendBuffer ss;
+    ss << line << "_" << col;
+    SymbolId recordName = symbols.getString(ss.getRef());
+
+    auto count = anonRecordCountMap.find(recordName);
+    if (count == anonRecordCountMap.end()) {
+      anonRecordCountMap[recordName] = 1;
+      return recordName;
+    }
+    // e.g. records from a macro expansion, or from another file
+    ss.clear();
+    ss << ++count->second << "D" << line << "_" << col;
+    return symbols.getString(ss.getRef());
   }
 
-  std::string getNextRecordIdStr() {
-    std::stringstream ss;
-    ss << getNextRecordId();
-    return ss.str();
+  const std::string &convertFuncName(llvm::StringRef funcName) {
+    return symbols.getName(symbols.getFunc(symbols.getString(funcName)));
   }
 
-  std::string convertFuncName(std::string funcName) {
-    std::stringstream ss;
-    ss << FUNC_NAME_PREFIX << funcName;
-    return ss.str();
+  const std::string &convertVarExpr(uint64_t varAddr) {
+    // if here, var should already be in varMap
+    return varMap[varAddr].getName();
   }
 
-  std::string convertVarExpr(uint64_t varAddr) {
-    // if here, var should already be in varMap
-    std::stringstream ss;
+  // BOUND START: ir_cache_routines
+
+  // The lowered form of a function, as kept in the SummaryCache (one item a line),
+  //     <baseLine>              the line the function starts at
+  //     V\t<name>\t<type>       a variable its lowering added (locals, temporaries...)
+  //     C\t<callee>             a called function
+  //     I\t<funcSig>            the signature of a function called through a pointer
+  //     S\t<stmt>               an instruction
+  //     T\t<count>              the number of temporaries
+  //     L\t<size>\t<align>\t<type> the layout of a type it uses
+  // The lines in the instructions are made relative to the baseLine on reuse.
+  // @return "" if the function cannot be kept (e.g. a newline in an instruction).
+  std::string serializeFuncIr(const SlangFunc &slangFunc) {
+    AppendBuffer ss;
+    ss << slangFunc.line << "\n";
+
+    std::set<std::string> varNames; // a variable may be added twice
+    for (uint64_t varId : loggedVars) {
+      const SlangVar &slangVar = varMap[varId];
+      if (slangVar.typeStr != DONT_PRINT && varNames.insert(slangVar.getName()).second) {
+        ss << "V\t" << slangVar.getName() << "\t" << slangVar.typeStr << "\n";
+      }
+    }
+    for (const std::string &callee : slangFunc.callees) {
+      ss << "C\t" << callee << "\n";
+    }
+    for (const std::string &funcSig : slangFunc.indirectCallSigs) {
+      ss << "I\t" << funcSig << "\n";
+    }
+    for (llvm::StringRef stmt : slangFunc.spanStmts) {
+      if (stmt.find('\n') != llvm::StringRef::npos) {
+        return "";
+      }
+      ss << "S\t" << stmt << "\n";
+    }
+    ss << "T\t" << slangFunc.tmpVarCount << "\n";
+    for (const std::string &typeStr : loggedTypes) {
+      auto &layout = typeLayouts[typeStr];
+      ss << "L\t" << layout.first << "\t" << layout.second << "\t" << typeStr << "\n";
+    }
+    return ss.str();
+  } // serializeFuncIr()
 
-    auto slangVar = varMap[varAddr];
-    ss << slangVar.name;
+  // Fills the current function from its serializeFuncIr() form.
+  // @return false if the entry is malformed (then nothing is changed).
+  bool reuseFuncIr(llvm::StringRef entry) {
+    llvm::SmallVector<llvm::StringRef, 64> lines;
+    entry.split(lines, '\n', -1, /*KeepEmpty=*/false);
 
-    return ss.str();
-  }
+    uint32_t baseLine;
+    if (lines.empty() || lines[0].getAsInteger(10, baseLine)) {
+      return false;
+    }
+    for (size_t i = 1; i < lines.size(); ++i) {
+      if (lines[i].size() < 2 || lines[i][1] != '\t' ||
+          llvm::StringRef("VCISTL").find(lines[i][0]) == llvm::StringRef::npos) {
+        return false;
+      }
+    }
+
+    int64_t lineDelta = (int64_t)currFunc->line - baseLine;
+    std::string localPrefix = VAR_NAME_PREFIX + currFunc->name + ":";
+    AppendBuffer ss;
+    for (size_t i = 1; i < lines.size(); ++i) {
+      llvm::StringRef item = lines[i].drop_front(2);
+      switch (lines[i][0]) {
+      case 'V': {
+        // a fresh id: the Decl of a reused variable is never looked up
+        SlangVar slangVar{};
+        slangVar.id = nextUniqueId();
+        llvm::StringRef varName = item.split('\t').first;
+        if (varName.startswith(localPrefix)) {
+          // as the lowering names it, so that it is found by the function
+          slangVar.setLocalVarName(varName.drop_front(localPrefix.size()), currFunc->name);
+        } else {
+          slangVar.nameId = symbols.getString(varName);
+        }
+        slangVar.typeStr = item.split('\t').second.str();
+        addVar(slangVar.id, slangVar);
+        break;
+      }
+      case 'C': currFunc->callees.insert(item.str()); break;
+      case 'I': currFunc->indirectCallSigs.insert(item.str()); break;
+      case 'T': item.getAsInteger(10, currFunc->tmpVarCount); break;
+      case 'L': {
+        llvm::SmallVector<llvm::StringRef, 3> parts;
+        item.split(parts, '\t', 2);
+        uint64_t size, align;
+        if (parts.size() == 3 && !parts[0].getAsInteger(10, size) &&
+            !parts[1].getAsInteger(10, align)) {
+          addTypeLayout(parts[2].str(), size, align);
+        }
+        break;
+      }
+      default:
+        ss.clear();
+        shiftLocLines(item, lineDelta, ss);
+        currFunc->addStmt(ss.getRef());
+        break;
+      }
+    }
+    return true;
+  } // reuseFuncIr()
+
+  // appends the stmt with the line of each "Loc(line,col)" moved by lineDelta
+  static void shiftLocLines(llvm::StringRef stmt, int64_t lineDelta, AppendBuffer &ss) {
+    if (lineDelta == 0) {
+      ss << stmt;
+      return;
+    }
+    size_t pos;
+    while ((pos = stmt.find("Loc(")) != llvm::StringRef::npos) {
+      pos += 4;
+      ss << stmt.take_front(pos);
+      stmt = stmt.drop_front(pos);
+
+      size_t digits = stmt.find_first_not_of("0123456789");
+      int64_t line;
+      if (digits == 0 || digits == llvm::StringRef::npos ||
+          stmt.take_front(digits).getAsInteger(10, line)) {
+        continue; // not a location
+      }
+      ss << (long long)(line + lineDelta);
+      stmt = stmt.drop_front(digits);
+    }
+    ss << stmt;
+  } // shiftLocLines()
+
+  // BOUND END  : ir_cache_routines
 
   // BOUND START: dump_routines (to SPAN Strings)
 
-  // dump entire span ir module for the translation unit.
-  void dumpSlangIr() {
-    std::stringstream ss;
+  // The span ir is streamed: each function is written to the irSink as
+  // soon as it is lowered, and the rest (records, variables...) at the end.
+  // (The order of the keyword arguments of tunit.TranslationUnit is free.)
+  //
+  // The output is the same, byte for byte, for the same input: the streamed
+  // functions follow the (deterministic) order Clang visits them in, and the
+  // rest is sorted by source position then name, never by Decl address.
+  //
+  // opens the irSink (see SlangOutputSink.h for the outputSpec)
+  void beginSlangIr(const std::string &outputSpec, bool async) {
+    if (irSink) {
+      return; // already begun
+    }
+
+    std::string error;
+    irSink = createOutputSink(outputSpec, fileName + ".spanir", async, error);
+    if (!irSink) {
+      SLANG_ERROR("SLANG: ERROR: no output for the SPAN IR: " << error)
+      irSink.reset(new NullSink());
+    }
 
+    AppendBuffer ss;
     dumpHeader(ss);
+    ss << NBSP2 << "allConstructs = {\n";
+    writeIr(ss);
+  } // beginSlangIr()
+
+  // writes out a lowered function
+  void emitFunction(uint64_t funcAddr) {
+    const SlangFunc &slangFunc = funcMap[funcAddr];
+    emittedFuncs[funcAddr] = true;
+    if (slangFunc.inHeader && emitShared(slangFunc)) {
+      return;
+    }
+    AppendBuffer ss;
+    dumpFunction(slangFunc, ss);
+    writeIr(ss);
+  }
+
+  // The functions (with their locals) and the records defined in the headers
+  // are the same in the many TUs including them. With a sharedIrDir they are
+  // written there once, each as a tunit.TranslationUnit of its own, keyed by
+  // the hash of its text (see SHARED_IR_CACHE_ID and SummaryCache for the
+  // layout). The TU only lists them, by name and hash, in the
+  // sharedConstructs dict.
+  // @return false if the function is not shared (then it is to be dumped).
+  bool emitShared(const SlangFunc &slangFunc) {
+    if (sharedIrDir.empty() || slangFunc.spanStmts.empty()) {
+      return false;
+    }
+
+    std::string localPrefix = VAR_NAME_PREFIX + slangFunc.name + ":";
+    bool tableUsed = typeTableUsed; // an entry is shared: its types are in full
+    typeTableUsed = false;
+    AppendBuffer ss;
+    dumpSharedHeader(slangFunc.fullName, ss);
+    ss << NBSP2 << "allConstructs = {\n";
+    dumpFunction(slangFunc, ss, /*indexed=*/false);
+    ss << NBSP2 << "}, # end allConstructs dict\n\n";
+    ss << NBSP2 << "allVars = {\n";
+    for (const SlangVar *var : getSortedVars()) {
+      if (var->getName().compare(0, localPrefix.size(), localPrefix) == 0) {
+        dumpVariable(*var, ss);
+      }
+    }
+    ss << NBSP2 << "}, # end allVars dict\n";
+    dumpFooter(ss);
+    typeTableUsed = tableUsed;
+
+    if (!storeShared(slangFunc.fullName, ss.str())) {
+      return false;
+    }
+    sharedLocalPrefixes.insert(localPrefix);
+    return true;
+  } // emitShared()
+
+  // the same, for a record
+  bool emitShared(SlangRecord &slangRecord) {
+    if (sharedIrDir.empty()) {
+      return false;
+    }
+    AppendBuffer ss;
+    dumpSharedHeader(slangRecord.getName(), ss);
+    ss << NBSP2 << "allConstructs = {\n";
+    ss << NBSP4 << "\"" << slangRecord.getName() << "\":\n";
+    ss << slangRecord.toString() << ",\n";
+    ss << NBSP2 << "}, # end allConstructs dict\n";
+    dumpFooter(ss);
+    return storeShared(slangRecord.getName(), ss.str());
+  }
+
+  void dumpSharedHeader(const std::string &name, AppendBuffer &ss) {
+    ss << "\n# START: A_SPAN_shared_construct.\n\n";
+    ss << "tunit.TranslationUnit(\n";
+    ss << NBSP2 << "name = \"shared:" << name << "\",\n";
+    ss << NBSP2 << "description = \"Shared by the translation units (see SharedIrDir).\",\n";
+  }
+
+  // puts the text in the sharedIrDir (if not there yet)
+  bool storeShared(const std::string &name, const std::string &text) {
+    std::string hash = SummaryCache::hashText(text);
+    SummaryCache store(sharedIrDir);
+    if (!llvm::sys::fs::exists(store.getEntryPath(SHARED_IR_CACHE_ID, hash)) &&
+        !store.store(SHARED_IR_CACHE_ID, hash, text)) {
+      return false;
+    }
+    sharedRefs[name] = hash;
+    return true;
+  }
+
+  void dumpSharedRefs(AppendBuffer &ss) {
+    if (sharedRefs.empty()) {
+      return;
+    }
+    ss << NBSP2 << "# name -> hash, in the SharedIrDir (see SlangSummaryCache.h)\n";
+    ss << NBSP2 << "sharedConstructs = {\n";
+    for (auto &sharedRef : sharedRefs) {
+      ss << NBSP4 << "\"" << sharedRef.first << "\": \"" << sharedRef.second << "\",\n";
+    }
+    ss << NBSP2 << "}, # end sharedConstructs dict\n\n";
+  }
+
+  // the list of the types the text refers to (see dumpTyped())
+  void dumpTypeTable(AppendBuffer &ss) {
+    if (!typeTableUsed) {
+      return;
+    }
+    ss << NBSP2 << "# the types, referred to as T(<index>) (see SlangTypeTable.h)\n";
+    ss << NBSP2 << "allTypes = ";
+    size_t begin = ss.size();
+    typedText.clear();
+    typeTable.dump(NBSP2, typedText);
+    ss << typedText;
+    addIrIndexEntry("types", begin, ss.size());
+    ss << ", # end allTypes list\n\n";
+  }
+
+  // appends the text (e.g. an instruction) to ss, with the types in it
+  // referred to by their index in the typeTable, if typeTableUsed
+  void dumpTyped(llvm::StringRef text, AppendBuffer &ss) {
+    if (!typeTableUsed) {
+      ss.write(text.data(), text.size());
+      return;
+    }
+    typedText.clear();
+    typeTable.internTypes(text, typedText);
+    ss << typedText;
+  }
+
+  // Writes the text to the irSink. The dump routines record the offsets of
+  // the index as irOffset + (the position in the text): the text must be
+  // written as soon as it is dumped.
+  void writeIr(const AppendBuffer &ss) {
+    irSink->write(ss.getRef());
+    irOffset += ss.size();
+  }
+
+  // writes out the rest of the span ir module, and closes the irSink
+  // (and the index of the file, with indexed set)
+  void dumpSlangIr(const std::string &outputSpec, bool async, bool indexed) {
+    beginSlangIr(outputSpec, async);
+
+    AppendBuffer ss;
+    dumpRecords(ss);
+    dumpFunctions(ss); // those not emitted yet (e.g. declarations)
+    ss << NBSP2 << "}, # end allConstructs dict\n";
     dumpVariables(ss);
-    dumpObjs(ss);
+    dumpInternalVars(ss);
+    dumpCallGraph(ss);
+    dumpTypeLayouts(ss);
+    dumpSharedRefs(ss);
+    dumpTypeTable(ss);
     dumpFooter(ss);
+    writeIr(ss);
 
-    // TODO: print the content to a file.
-    std::string fileName = this->fileName + ".spanir";
-    Util::writeToFile(fileName, ss.str());
-    llvm::errs() << ss.str();
+    if (!irSink->close()) {
+      SLANG_ERROR("SLANG: ERROR: error writing the SPAN IR of " << fileName)
+    } else if (indexed) {
+      dumpIrIndex(getOutputFilePath(outputSpec, fileName + ".spanir"));
+    }
+    // the "memory" output is kept, for the embedder to read
+    if (auto memorySink = dynamic_cast<MemorySink *>(irSink.get())) {
+      memoryIr = memorySink->getContent();
+    }
+    irSink.reset();
+    emittedFuncs.clear();
+    irOffset = 0;
+    irIndex.clear();
+    sharedRefs.clear();
+    sharedLocalPrefixes.clear();
+    typeTable.clear();
   } // dumpSlangIr()
 
-  void dumpHeader(std::stringstream &ss) {
+  // Writes the index of the span ir file to <irPath>.idx, one entry a line
+  // (tab separated, offsets and lengths in bytes),
+  //     spanir  <name>  <size>          the TU and the size of the file
+  //     records <offset> <length>       the records, as the items of a dict
+  //     vars    <offset> <length>       the allVars dict
+  //     types   <offset> <length>       the allTypes list (see dumpTypeTable())
+  //     func    <name> <offset> <length> <blocks> <instrs> <temps>
+  //                                     a constructs.Func(...) value
+  // Nothing is written if the IR is not in a file (e.g. a pipe).
+  void dumpIrIndex(const std::string &irPath) {
+    if (irPath.empty()) {
+      SLANG_ERROR("SLANG: ERROR: IrIndex needs the SPAN IR in a file")
+      return;
+    }
+
+    AppendBuffer ss;
+    ss << "# The index of " << irPath << " (see SlangGenAstChecker.cpp, dumpIrIndex()).\n";
+    ss << "spanir\t" << fileName << "\t" << irOffset << "\n";
+    ss << irIndex;
+    Util::writeToFile(irPath + ".idx", ss.getRef());
+  } // dumpIrIndex()
+
+  // adds an entry to the index of the span ir (see dumpIrIndex())
+  void addIrIndexEntry(llvm::StringRef kind, uint64_t begin, uint64_t end) {
+    AppendBuffer ss;
+    ss << kind << "\t" << (irOffset + begin) << "\t" << (end - begin) << "\n";
+    irIndex += ss.getRef();
+  }
+
+  // Writes the span ir in shards, instead of dumpSlangIr(), to be analyzed
+  // in parallel. Each shard, DIR/<file>.N.spanir, is a tunit.TranslationUnit
+  // of a bundle of the functions, with their local variables. The bundles
+  // are of about shardSize bytes, balanced by size (see balanceBundles()).
+  // The manifest, DIR/<file>.spanir.manifest, has what the shards share,
+  //     Manifest(
+  //       name = "test.c",
+  //       description = "...",
+  //       allConstructs = {...},     the records
+  //       allVars = {...},           the global variables
+  //       callGraph = {...},
+  //       callGraphSccs = [...],
+  //       shards = [("test.c.0.spanir", ["f:main", ...]), ...],
+  //     )
+  void dumpShards(const std::string &shardDir, uint64_t shardSize) {
+    if (std::error_code ec = llvm::sys::fs::create_directories(shardDir)) {
+      SLANG_ERROR("SLANG: ERROR: cannot create the shard directory '" << shardDir
+                  << "': " << ec.message())
+      return;
+    }
+
+    std::vector<const SlangFunc *> funcs;
+    for (auto &slangFunc : funcMap) {
+      funcs.push_back(&slangFunc.second);
+    }
+    std::stable_sort(funcs.begin(), funcs.end(), [](const SlangFunc *a, const SlangFunc *b) {
+      return isBefore(a, b, a->fullName, b->fullName);
+    });
+
+    // STEP 1: the text of each function, and of its local variables ("v:main:x")
+    std::vector<AppendBuffer> funcIrs(funcs.size());
+    std::vector<AppendBuffer> localIrs(funcs.size());
+    llvm::StringMap<size_t> funcIds; // function name -> index in funcs
+    for (size_t i = 0; i < funcs.size(); ++i) {
+      dumpFunction(*funcs[i], funcIrs[i]);
+      funcIds[funcs[i]->name] = i;
+    }
+    AppendBuffer globalIr;
+    for (const SlangVar *var : getSortedVars()) {
+      std::pair<llvm::StringRef, llvm::StringRef> scope =
+          llvm::StringRef(var->getName()).drop_front(llvm::StringRef(VAR_NAME_PREFIX).size()).split(':');
+      auto found = scope.second.empty() ? funcIds.end() : funcIds.find(scope.first);
+      dumpVariable(*var, found == funcIds.end() ? globalIr : localIrs[found->second]);
+    }
+
+    // STEP 2: the shards
+    std::vector<uint64_t> sizes;
+    for (size_t i = 0; i < funcs.size(); ++i) {
+      sizes.push_back(funcIrs[i].size() + localIrs[i].size());
+    }
+    std::vector<std::vector<size_t>> bundles = balanceBundles(sizes, shardSize);
+
+    std::string baseName = llvm::sys::path::filename(fileName).str();
+    AppendBuffer shardList;
+    for (size_t b = 0; b < bundles.size(); ++b) {
+      AppendBuffer shardName, description, ss;
+      shardName << baseName << "." << b << ".spanir";
+      description << "Shard " << b << " of " << bundles.size() << " of " << fileName
+                  << " (see " << baseName << ".spanir.manifest).";
+
+      dumpHeader(ss, description.str());
+      ss << NBSP2 << "allConstructs = {\n";
+      for (size_t i : bundles[b]) {
+        ss << funcIrs[i].getRef();
+      }
+      ss << NBSP2 << "}, # end allConstructs dict\n\n";
+      ss << NBSP2 << "allVars = {\n";
+      for (size_t i : bundles[b]) {
+        ss << localIrs[i].getRef();
+      }
+      ss << NBSP2 << "}, # end allVars dict\n\n";
+      dumpFooter(ss);
+
+      llvm::SmallString<128> shardPath(shardDir);
+      llvm::sys::path::append(shardPath, shardName.getRef());
+      Util::writeToFile(shardPath.str().str(), ss.getRef());
+
+      shardList << NBSP4 << "(\"" << shardName.getRef() << "\", [";
+      std::string prefix = "";
+      for (size_t i : bundles[b]) {
+        shardList << prefix << "\"" << funcs[i]->fullName << "\"";
+        prefix = ", ";
+      }
+      shardList << "]),\n";
+    }
+
+    // STEP 3: the manifest
+    AppendBuffer ss;
+    ss << "\n# START: The manifest of the sharded SPAN IR of " << fileName << ".\n\n";
+    ss << "Manifest(\n";
+    ss << NBSP2 << "name = \"" << fileName << "\",\n";
+    ss << NBSP2 << "description = \"Auto-Translated from Clang AST, in "
+       << bundles.size() << " shards.\",\n";
+    ss << NBSP2 << "allConstructs = {\n";
+    dumpRecords(ss);
+    ss << NBSP2 << "}, # end allConstructs dict\n\n";
+    ss << NBSP2 << "allVars = {\n" << globalIr.getRef() << NBSP2 << "}, # end allVars dict\n\n";
+    dumpInternalVars(ss);
+    // the signature of each function: a shard calls the functions of the others
+    ss << NBSP2 << "funcSigs = {\n";
+    for (const SlangFunc *slangFunc : funcs) {
+      if (llvm::StringRef(slangFunc->funcSig).startswith("types.FuncSig(")) {
+        ss << NBSP4 << "\"" << slangFunc->fullName << "\": ";
+        dumpTyped(slangFunc->funcSig, ss);
+        ss << ",\n";
+      }
+    }
+    ss << NBSP2 << "}, # end funcSigs dict\n";
+    dumpCallGraph(ss);
+    dumpTypeLayouts(ss);
+    ss << NBSP2 << "shards = [\n" << shardList.getRef() << NBSP2 << "], # end shards list\n";
+    ss << ") # Manifest() ends\n";
+    ss << "\n# END  : The manifest of the sharded SPAN IR of " << fileName << ".\n";
+
+    llvm::SmallString<128> manifestPath(shardDir);
+    llvm::sys::path::append(manifestPath, baseName + ".spanir.manifest");
+    Util::writeToFile(manifestPath.str().str(), ss.getRef());
+
+    irIndex.clear(); // filled by the dump routines, not written here
+    SLANG_EVENT("SLANG: " << fileName << ": " << funcs.size() << " functions in "
+                << bundles.size() << " shards, in " << shardDir)
+  } // dumpShards()
+
+  // run the native points-to analysis on the lowered functions,
+  // and dump its result next to the span ir.
+  void dumpPointsTo() {
+    PointsToAnalysis pointsTo;
+
+    for (auto &var : varMap) {
+      pointsTo.addVar(var.second.getName(), var.second.typeStr);
+    }
+    for (auto &slangFunc : funcMap) {
+      if (!pointsTo.addFunction(slangFunc.second.fullName,
+            slangFunc.second.getParamNames(), slangFunc.second.spanStmts)) {
+        SLANG_ERROR("PointsTo: could not parse some instructions of "
+                    << slangFunc.second.fullName)
+      }
+    }
+    pointsTo.solve();
+    SLANG_DEBUG("PointsTo: nodes " << pointsTo.getNodeCount()
+                << ", collapsed " << pointsTo.getCollapsedCount())
+
+    AppendBuffer ss;
+    ss << "# START: Points-to result of " << fileName << ".\n";
+    ss << "# variable name -> names of the objects it may point to.\n";
+    ss << pointsTo.toString();
+    ss << "# END  : Points-to result of " << fileName << ".\n";
+
+    Util::writeToFile(fileName + ".spanpts", ss.getRef());
+  } // dumpPointsTo()
+
+  void dumpHeader(AppendBuffer &ss,
+                  const std::string &description = "Auto-Translated from Clang AST.") {
     ss << "\n";
     ss << "# START: A_SPAN_translation_unit.\n";
     ss << "\n";
@@ -451,97 +1217,558 @@ public:
     ss << "# An instance of span.ir.tunit.TranslationUnit class.\n";
     ss << "tunit.TranslationUnit(\n";
     ss << NBSP2 << "name = \"" << fileName << "\",\n";
-    ss << NBSP2 << "description = \"Auto-Translated from Clang AST.\",\n";
+    ss << NBSP2 << "description = \"" << description << "\",\n";
   } // dumpHeader()
 
-  void dumpFooter(std::stringstream &ss) {
+  void dumpFooter(AppendBuffer &ss) {
     ss << ") # tunit.TranslationUnit() ends\n";
     ss << "\n# END  : A_SPAN_translation_unit.\n";
   } // dumpFooter()
 
-  void dumpVariables(std::stringstream &ss) {
-    ss << "\n";
-    ss << NBSP2 << "allVars = {\n";
+  // the variables to print, by name (each name once)
+  std::vector<const SlangVar *> getSortedVars() const {
+    // the varMap order is not stable, hence sort
+    std::vector<const SlangVar *> vars;
     for (const auto &var : varMap) {
-      if (var.second.typeStr == DONT_PRINT)
-        continue;
-      ss << NBSP4;
-      ss << "\"" << var.second.name << "\": " << var.second.typeStr << ",\n";
+      if (var.second.typeStr != DONT_PRINT) {
+        vars.push_back(&var.second);
+      }
+    }
+    std::sort(vars.begin(), vars.end(), [](const SlangVar *a, const SlangVar *b) {
+      return a->getName() < b->getName();
+    });
+    // e.g. added again by a function reused from the cache
+    vars.erase(std::unique(vars.begin(), vars.end(),
+                           [](const SlangVar *a, const SlangVar *b) {
+                             return a->getName() == b->getName();
+                           }),
+               vars.end());
+    return vars;
+  }
+
+  // a local of a function in the sharedIrDir (see emitShared())
+  bool isSharedLocal(const std::string &varName) const {
+    if (sharedLocalPrefixes.empty()) {
+      return false;
+    }
+    size_t colon = varName.find(':', llvm::StringRef(VAR_NAME_PREFIX).size());
+    return colon != std::string::npos &&
+           sharedLocalPrefixes.count(varName.substr(0, colon + 1));
+  }
+
+  void dumpVariable(const SlangVar &var, AppendBuffer &ss) {
+    ss << NBSP4;
+    ss << "\"" << var.getName() << "\": ";
+    dumpTyped(var.typeStr, ss);
+    ss << ",\n";
+  }
+
+  void dumpVariables(AppendBuffer &ss) {
+    ss << "\n";
+    ss << NBSP2 << "allVars = ";
+    size_t begin = ss.size();
+    ss << "{\n";
+    for (const SlangVar *var : getSortedVars()) {
+      if (!isSharedLocal(var->getName())) {
+        dumpVariable(*var, ss);
+      }
     }
-    ss << NBSP2 << "}, # end allVars dict\n\n";
+    ss << NBSP2 << "}";
+    addIrIndexEntry("vars", begin, ss.size());
+    ss << ", # end allVars dict\n\n";
   } // dumpVariables()
 
-  void dumpObjs(std::stringstream &ss) {
-    ss << NBSP2 << "allConstructs = {\n";
-    dumpRecords(ss);
-    dumpFunctions(ss);
-    ss << NBSP2 << "}, # end allConstructs dict\n";
+  // the globals of internal linkage (e.g. static): slang-irlink keeps them
+  // per TU, as "v:x" is another variable in each
+  void dumpInternalVars(AppendBuffer &ss) {
+    std::vector<const SlangVar *> vars;
+    for (const SlangVar *var : getSortedVars()) {
+      if (var->internal) {
+        vars.push_back(var);
+      }
+    }
+    if (vars.empty()) {
+      return;
+    }
+    ss << NBSP2 << "internalVars = [";
+    std::string prefix = "";
+    for (const SlangVar *var : vars) {
+      ss << prefix << "\"" << var->getName() << "\"";
+      prefix = ", ";
+    }
+    ss << "], # end internalVars list\n\n";
   }
 
-  void dumpRecords(std::stringstream &ss) {
-    for (auto slangRecord : recordMap) {
+  // A stable hash of the lowered function and the types of its locals.
+  // It keys the summaries of the function in a SummaryCache.
+  std::string computeIrHash(const SlangFunc &slangFunc) const {
+    AppendBuffer ss;
+
+    ss << slangFunc.fullName << "\n";
+    for (SymbolId paramNameId : slangFunc.paramNameIds) {
+      ss << symbols.getName(paramNameId) << ",";
+    }
+    ss << "\n" << slangFunc.variadic << "\n" << slangFunc.retType << "\n";
+    for (llvm::StringRef stmt : slangFunc.spanStmts) {
+      ss.write(stmt.data(), stmt.size()) << "\n";
+    }
+
+    // the order the locals are added in is not stable, hence sort
+    std::vector<std::string> localVars;
+    auto funcLocals = localVarIds.find(symbols.getString(slangFunc.name));
+    if (funcLocals != localVarIds.end()) {
+      for (uint64_t varId : funcLocals->second) {
+        const SlangVar &var = varMap.find(varId)->second;
+        if (var.typeStr != DONT_PRINT) {
+          localVars.push_back(var.getName() + ": " + var.typeStr);
+        }
+      }
+    }
+    std::sort(localVars.begin(), localVars.end());
+    localVars.erase(std::unique(localVars.begin(), localVars.end()), localVars.end());
+    for (const std::string &localVar : localVars) {
+      ss << localVar << "\n";
+    }
+
+    return SummaryCache::hashText(ss.str());
+  } // computeIrHash()
+
+  void dumpCallGraph(AppendBuffer &ss) {
+    CallGraph callGraph;
+
+    for (auto &slangFunc : funcMap) {
+      callGraph.addFunction(slangFunc.second.fullName, slangFunc.second.funcSig);
+      for (const std::string &callee : slangFunc.second.callees) {
+        callGraph.addCall(slangFunc.second.fullName, callee);
+      }
+      for (const std::string &funcSig : slangFunc.second.indirectCallSigs) {
+        callGraph.addIndirectCall(slangFunc.second.fullName, funcSig);
+      }
+    }
+
+    callGraph.computeSccs();
+    ss << "\n";
+    ss << callGraph.toString(NBSP2);
+  } // dumpCallGraph()
+
+  // The layouts, as the ASTContext computes them for the target,
+  //     typeLayouts = {
+  //       "s:node": (16, 8, [(0, 0), (64, 0)]),   # a record, by name
+  //       types.Int32: (4, 4),                     # any other type used
+  //     },
+  // the size and the alignment in bytes; and for a record the offset and the
+  // bit width (0 if not a bit-field) in bits of each member, in order.
+  void dumpTypeLayouts(AppendBuffer &ss) {
+    std::map<std::string, const SlangRecord *> records; // sorted by name
+    for (auto &slangRecord : recordMap) {
+      if (slangRecord.second.size) {
+        records[slangRecord.second.getName()] = &slangRecord.second;
+      }
+    }
+
+    ss << NBSP2 << "typeLayouts = {\n";
+    for (auto &record : records) {
+      ss << NBSP4 << "\"" << record.first << "\": " << record.second->layoutToString() << ",\n";
+    }
+    for (auto &typeLayout : typeLayouts) {
+      ss << NBSP4 << typeLayout.first << ": (" << typeLayout.second.first << ", "
+         << typeLayout.second.second << "),\n";
+    }
+    ss << NBSP2 << "}, # end typeLayouts dict\n\n";
+  } // dumpTypeLayouts()
+
+  // orders by source position, then name
+  template <typename T>
+  static bool isBefore(const T *a, const T *b, const std::string &aName,
+                       const std::string &bName) {
+    if (a->line != b->line)
+      return a->line < b->line;
+    if (a->col != b->col)
+      return a->col < b->col;
+    return aName < bName;
+  }
+
+  void dumpRecords(AppendBuffer &ss) {
+    std::vector<SlangRecord *> records;
+    for (auto &slangRecord : recordMap) {
+      records.push_back(&slangRecord.second);
+    }
+    std::stable_sort(records.begin(), records.end(), [](SlangRecord *a, SlangRecord *b) {
+      return isBefore(a, b, a->getName(), b->getName());
+    });
+
+    size_t begin = ss.size();
+    for (SlangRecord *slangRecord : records) {
+      if (slangRecord->inHeader && emitShared(*slangRecord)) {
+        continue;
+      }
       ss << NBSP4;
-      ss << "\"" << slangRecord.second.name << "\":\n";
-      ss << slangRecord.second.toString();
+      ss << "\"" << slangRecord->getName() << "\":\n";
+      ss << slangRecord->toString();
       ss << ",\n\n";
     }
+    addIrIndexEntry("records", begin, ss.size());
     ss << "\n";
   }
 
-  void dumpFunctions(std::stringstream &ss) {
-    std::string prefix;
-    for (auto slangFunc : funcMap) {
-      ss << NBSP4; // indent
-      ss << "\"" << slangFunc.second.fullName << "\":\n";
-      ss << NBSP6 << "constructs.Func(\n";
-
-      // members
-      ss << NBSP8 << "name = "
-         << "\"" << slangFunc.second.fullName << "\",\n";
-      ss << NBSP8 << "paramNames = [";
-      prefix = "";
-      for (std::string &paramName : slangFunc.second.paramNames) {
-        ss << prefix << "\"" << paramName << "\"";
-        if (prefix.size() == 0) {
-          prefix = ", ";
-        }
+  void dumpFunctions(AppendBuffer &ss) {
+    std::vector<const SlangFunc *> funcs;
+    for (auto &slangFunc : funcMap) {
+      if (!emittedFuncs.count(slangFunc.first)) {
+        funcs.push_back(&slangFunc.second);
       }
-      ss << "],\n";
-      ss << NBSP8 << "variadic = " << (slangFunc.second.variadic ? "True" : "False") << ",\n";
+    }
+    std::stable_sort(funcs.begin(), funcs.end(), [](const SlangFunc *a, const SlangFunc *b) {
+      return isBefore(a, b, a->fullName, b->fullName);
+    });
 
-      ss << NBSP8 << "returnType = " << slangFunc.second.retType << ",\n";
+    for (const SlangFunc *slangFunc : funcs) {
+      if (!slangFunc->inHeader || !emitShared(*slangFunc)) {
+        dumpFunction(*slangFunc, ss);
+      }
+    }
+  } // dumpFunctions()
 
-      // member: basicBlocks
-      ss << "\n";
-      ss << NBSP8 << "# Note: -1 is always start/entry BB. (REQUIRED)\n";
-      ss << NBSP8 << "# Note: 0 is always end/exit BB (REQUIRED)\n";
-      ss << NBSP8 << "instrSeq = [\n";
-      for (auto insn : slangFunc.second.spanStmts) {
-        ss << NBSP12 << insn << ",\n";
+  // (and adds it to the index of the span ir, with indexed set)
+  void dumpFunction(const SlangFunc &slangFunc, AppendBuffer &ss, bool indexed = true) {
+    std::string prefix;
+    ss << NBSP4; // indent
+    ss << "\"" << slangFunc.fullName << "\":\n";
+    ss << NBSP6;
+    size_t begin = ss.size();
+    ss << "constructs.Func(\n";
+
+    // members
+    ss << NBSP8 << "name = "
+       << "\"" << slangFunc.fullName << "\",\n";
+    ss << NBSP8 << "paramNames = [";
+    prefix = "";
+    for (SymbolId paramNameId : slangFunc.paramNameIds) {
+      ss << prefix << "\"" << symbols.getName(paramNameId) << "\"";
+      if (prefix.size() == 0) {
+        prefix = ", ";
       }
-      ss << NBSP8 << "], # instrSeq end.\n";
+    }
+    ss << "],\n";
+    ss << NBSP8 << "variadic = " << (slangFunc.variadic ? "True" : "False") << ",\n";
 
-      // close this function object
-      ss << NBSP6 << "), # " << slangFunc.second.fullName << "() end. \n\n";
+    ss << NBSP8 << "returnType = ";
+    dumpTyped(slangFunc.retType, ss);
+    ss << ",\n";
+    ss << NBSP8 << "irHash = \"" << computeIrHash(slangFunc) << "\",\n";
+
+    // member: basicBlocks
+    ss << "\n";
+    ss << NBSP8 << "# Note: -1 is always start/entry BB. (REQUIRED)\n";
+    ss << NBSP8 << "# Note: 0 is always end/exit BB (REQUIRED)\n";
+    ss << NBSP8 << "instrSeq = [\n";
+    for (llvm::StringRef insn : slangFunc.spanStmts) {
+      ss << NBSP12;
+      dumpTyped(insn, ss);
+      ss << ",\n";
     }
-  } // dumpFunctions()
+    ss << NBSP8 << "], # instrSeq end.\n";
+
+    // close this function object
+    ss << NBSP6 << ")";
+    if (indexed) {
+      addFuncIndexEntry(slangFunc, begin, ss.size());
+    }
+    ss << ", # " << slangFunc.fullName << "() end. \n\n";
+  } // dumpFunction()
+
+  // adds the function to the index of the span ir, with its counts of
+  // basic blocks, instructions and temporaries (see dumpIrIndex())
+  void addFuncIndexEntry(const SlangFunc &slangFunc, uint64_t begin, uint64_t end) {
+    // a block begins at a label, or after a jump
+    uint32_t blocks = 0, instrs = 0;
+    bool inBlock = false;
+    for (llvm::StringRef stmt : slangFunc.spanStmts) {
+      if (stmt.startswith(LABEL_PREFIX)) {
+        blocks += 1;
+        inBlock = true;
+        continue;
+      }
+      if (!inBlock) {
+        blocks += 1;
+        inBlock = true;
+      }
+      instrs += 1;
+      if (stmt.startswith("instr.GotoI(") || stmt.startswith("instr.CondI(") ||
+          stmt.startswith("instr.ReturnI(")) {
+        inBlock = false;
+      }
+    }
+
+    AppendBuffer ss;
+    ss << "func\t" << slangFunc.fullName << "\t" << (irOffset + begin) << "\t"
+       << (end - begin) << "\t" << blocks << "\t" << instrs << "\t" << slangFunc.tmpVarCount
+       << "\n";
+    irIndex += ss.getRef();
+  } // addFuncIndexEntry()
 
   // BOUND END  : dump_routines (to SPAN Strings)
 
 }; // class SlangTranslationUnit
 
 class SlangGenAstChecker : public Checker<check::ASTCodeBody, check::EndOfTranslationUnit> {
+  // the bug types of the SPAN diagnoses (name and category -> type)
+  mutable std::map<std::string, std::unique_ptr<BugType>> spanBugTypes;
 
+protected:
   // static_members initialized
   static SlangTranslationUnit stu;
   static const FunctionDecl *FD; // funcDecl
 
+  // the checkers sharing stu, and those done with it in the current TU
+  static int stuUsers;
+  static int stuUsersDone;
+
+  // the TU is forgotten once all the checkers are done with it
+  // (and its lowering stats are logged)
+  void releaseStmtsIfLast() const {
+    stuUsersDone += 1;
+    if (stuUsersDone == stuUsers) {
+      stuUsersDone = 0;
+
+      SLANG_EVENT("SLANG: " << stu.fileName << ": " << stu.loweredFuncCount
+                  << " functions lowered, " << stu.reusedFuncCount << " reused from the cache, "
+                  << stu.skippedFuncCount << " skipped")
+      stu.reset();
+    }
+  }
+
+  friend std::string slang::takeMemoryIr();
+
 public:
+  SlangGenAstChecker() { stuUsers += 1; }
+  // (a process may create the checkers again for its next TU)
+  ~SlangGenAstChecker() { stuUsers -= 1; }
+
   // BOUND START: top_level_routines
 
   // mainentry, main entry point. Invokes top level Function and Cfg handlers.
   // It is invoked once for each source translation unit function.
   void checkASTCodeBody(const Decl *D, AnalysisManager &mgr, BugReporter &BR) const {
+    if (!isInScope(D, mgr)) {
+      declareFunction(D);
+      return;
+    }
+
+    lowerFunction(D, getCacheDir(mgr));
+    if (FD && getShardDir(mgr).empty()) {
+      // stream the function out, while the next one is lowered
+      stu.sharedIrDir = getSharedIrDir(mgr);
+      stu.typeTableUsed = getTypeTableUsed(mgr);
+      stu.beginSlangIr(getOutputSpec(mgr), getAsyncOutput(mgr));
+      stu.emitFunction((uint64_t) FD);
+      // no one reads the statements of an emitted function again, unless
+      // another checker shares stu (e.g. DeadStore analyzes them at the end
+      // of the TU) or the points-to analysis runs at the end of the TU
+      if (stuUsers == 1 && !getPointsTo(mgr)) {
+        stu.funcMap[(uint64_t) FD].releaseStmts();
+      }
+    }
+  } // checkASTCodeBody()
+
+  // The functions out of scope are only declared. The checker options,
+  //   `MainFileOnly`      skip the functions of the headers (e.g. static inline)
+  //   `FunctionInclude`   a regex: skip the functions whose name does not match
+  //   `FunctionExclude`   a regex: skip the functions whose name matches
+  //   `MaxFunctionLines`  skip the functions longer than this (0: no limit)
+  //   `ChangedLines`      a unified diff, or FILE:START-END lines (see
+  //                       SlangChangedLines.h): skip the functions that
+  //                       overlap no changed line, e.g. to check a patch
+  bool isInScope(const Decl *D, AnalysisManager &mgr) const {
+    AnalyzerOptions &options = mgr.getAnalyzerOptions();
+    const SourceManager &sourceManager = D->getASTContext().getSourceManager();
+    SourceLocation begin = sourceManager.getExpansionLoc(D->getBeginLoc());
+    SourceLocation end = sourceManager.getExpansionLoc(D->getEndLoc());
+
+    if (options.getCheckerBooleanOption("MainFileOnly", false, this) &&
+        !sourceManager.isInMainFile(begin)) {
+      return false;
+    }
+
+    if (const FunctionDecl *funcDecl = dyn_cast<FunctionDecl>(D)) {
+      std::string funcName = funcDecl->getNameAsString();
+      const llvm::Regex *include = getFunctionRegex("FunctionInclude", mgr);
+      if (include && !include->match(funcName)) {
+        return false;
+      }
+      const llvm::Regex *exclude = getFunctionRegex("FunctionExclude", mgr);
+      if (exclude && exclude->match(funcName)) {
+        return false;
+      }
+    }
+
+    uint32_t beginLine = sourceManager.getExpansionLineNumber(begin);
+    uint32_t endLine = sourceManager.getExpansionLineNumber(end);
+    int maxLines = options.getCheckerIntegerOption("MaxFunctionLines", 0, this);
+    if (maxLines > 0 && endLine - beginLine + 1 > (uint32_t)maxLines) {
+      return false;
+    }
+
+    const ChangedLines *changedLines = getChangedLines(mgr);
+    if (changedLines &&
+        !changedLines->intersects(sourceManager.getFilename(begin), beginLine, endLine)) {
+      return false;
+    }
+
+    std::string entryNames = options.getCheckerStringOption("EntryFunctions", "", this).str();
+    if (entryNames.size() && !isReachable(D, entryNames)) {
+      return false;
+    }
+    return true;
+  } // isInScope()
+
+  // With the checker option `EntryFunctions` (e.g. "main,api_init") only the
+  // functions reachable from them in the TU are lowered. The direct call graph
+  // is built, once per TU, from the references to functions in the bodies: a
+  // call, or taking the address (for the indirect calls). The functions whose
+  // address is taken in a global initializer (e.g. a table of handlers) are
+  // roots too. (A function only called from another TU must be named.)
+  bool isReachable(const Decl *D, const std::string &entryNames) const {
+    if (stu.reachableFrom != entryNames) {
+      computeReachableFuncs(D->getASTContext().getTranslationUnitDecl(), entryNames);
+    }
+    return stu.reachableFuncs.count((uint64_t)D->getCanonicalDecl());
+  }
+
+  void computeReachableFuncs(const TranslationUnitDecl *tuDecl,
+                             const std::string &entryNames) const {
+    std::set<std::string> entries;
+    llvm::SmallVector<llvm::StringRef, 8> names;
+    llvm::StringRef(entryNames).split(names, ',', -1, /*KeepEmpty=*/false);
+    for (llvm::StringRef name : names) {
+      entries.insert(name.trim().str());
+    }
+
+    // STEP 1: the functions each function refers to, and the roots.
+    DeclMap<std::vector<const FunctionDecl *>> funcRefs;
+    std::vector<const FunctionDecl *> worklist;
+    uint32_t definedCount = 0;
+    for (const Decl *decl : tuDecl->decls()) {
+      if (const FunctionDecl *funcDecl = dyn_cast<FunctionDecl>(decl)) {
+        if (!funcDecl->doesThisDeclarationHaveABody()) {
+          continue;
+        }
+        definedCount += 1;
+        collectFuncRefs(funcDecl->getBody(),
+                        funcRefs[(uint64_t)funcDecl->getCanonicalDecl()]);
+        if (entries.count(funcDecl->getNameAsString())) {
+          worklist.push_back(funcDecl->getCanonicalDecl());
+        }
+      } else if (const VarDecl *varDecl = dyn_cast<VarDecl>(decl)) {
+        if (varDecl->hasInit()) {
+          collectFuncRefs(varDecl->getInit(), worklist); // address taken
+        }
+      }
+    }
+
+    // STEP 2: the transitive closure.
+    stu.reachableFrom = entryNames;
+    stu.reachableFuncs.clear();
+    while (!worklist.empty()) {
+      const FunctionDecl *funcDecl = worklist.back();
+      worklist.pop_back();
+      if (stu.reachableFuncs.count((uint64_t)funcDecl)) {
+        continue;
+      }
+      stu.reachableFuncs[(uint64_t)funcDecl] = true;
+
+      auto refs = funcRefs.find((uint64_t)funcDecl);
+      if (refs != funcRefs.end()) {
+        worklist.insert(worklist.end(), refs->second.begin(), refs->second.end());
+      }
+    }
+
+    SLANG_EVENT("SLANG: " << stu.reachableFuncs.size() << " functions reachable from '"
+                << entryNames << "' (of " << definedCount << " defined)")
+  } // computeReachableFuncs()
+
+  // appends the (canonical) functions referred to in stmt
+  static void collectFuncRefs(const Stmt *stmt, std::vector<const FunctionDecl *> &funcs) {
+    if (!stmt) {
+      return;
+    }
+    if (const DeclRefExpr *declRefExpr = dyn_cast<DeclRefExpr>(stmt)) {
+      if (const FunctionDecl *funcDecl = dyn_cast<FunctionDecl>(declRefExpr->getDecl())) {
+        funcs.push_back(funcDecl->getCanonicalDecl());
+      }
+    }
+    for (const Stmt *child : stmt->children()) {
+      collectFuncRefs(child, funcs);
+    }
+  } // collectFuncRefs()
+
+  // @return nullptr if the option is not set (or is not a valid regex)
+  const llvm::Regex *getFunctionRegex(llvm::StringRef optionName, AnalysisManager &mgr) const {
+    // compiled once: pattern -> regex (nullptr if invalid)
+    static std::map<std::string, std::unique_ptr<llvm::Regex>> regexes;
+
+    std::string pattern =
+        mgr.getAnalyzerOptions().getCheckerStringOption(optionName, "", this).str();
+    if (pattern.empty()) {
+      return nullptr;
+    }
+
+    auto found = regexes.find(pattern);
+    if (found == regexes.end()) {
+      std::unique_ptr<llvm::Regex> regex(new llvm::Regex(pattern));
+      std::string error;
+      if (!regex->isValid(error)) {
+        SLANG_ERROR("SLANG: ERROR: ignoring " << optionName << "='" << pattern << "': " << error)
+        regex.reset();
+      }
+      found = regexes.insert(std::make_pair(pattern, std::move(regex))).first;
+    }
+    return found->second.get();
+  } // getFunctionRegex()
+
+  // @return nullptr if the option `ChangedLines` is not set (or is unreadable)
+  const ChangedLines *getChangedLines(AnalysisManager &mgr) const {
+    // read once, the option is the same for the whole run
+    static std::string readPath;
+    static std::unique_ptr<ChangedLines> changedLines;
+
+    std::string path =
+        mgr.getAnalyzerOptions().getCheckerStringOption("ChangedLines", "", this).str();
+    if (path != readPath) {
+      readPath = path;
+      changedLines.reset();
+
+      std::string error;
+      std::unique_ptr<ChangedLines> newChangedLines(new ChangedLines());
+      if (path.empty()) {
+        // not scoped
+      } else if (newChangedLines->readFile(path, error)) {
+        changedLines = std::move(newChangedLines);
+      } else {
+        SLANG_ERROR("SLANG: ERROR: ignoring ChangedLines: " << error)
+      }
+    }
+    return changedLines.get();
+  } // getChangedLines()
+
+  // records only the signature of the function D: it is emitted as a declaration
+  void declareFunction(const Decl *D) const {
+    if (stu.fileName.size() == 0) {
+      stu.fileName = D->getASTContext().getSourceManager().getFilename(D->getBeginLoc()).str();
+    }
+
+    FD = dyn_cast<FunctionDecl>(D);
+    if (FD) {
+      FD = FD->getCanonicalDecl(); // the conversion routines use FD
+      handleFuncNameAndType(FD);
+      stu.skippedFuncCount += 1;
+    }
+  } // declareFunction()
+
+  // Lowers the function D into stu.currFunc.
+  // With a cacheDir, a function whose body (and the types it uses) is
+  // unchanged since it was last lowered is reused from the SummaryCache.
+  void lowerFunction(const Decl *D, const std::string &cacheDir) const {
     SLANG_EVENT("BOUND START: SLANG_Generated_Output.\n")
 
     // SLANG_DEBUG("slang_add_nums: " << slang_add_nums(1,2) << "only\n"; // lib testing
@@ -552,23 +1779,276 @@ public:
     FD = dyn_cast<FunctionDecl>(D);
     if (FD) {
       FD = FD->getCanonicalDecl();
+
+      // Lowered already, by the other checker sharing stu: it is not lowered
+      // again, as its locals are no longer new (see handleValueDecl()) and
+      // their initializers would be lost.
+      const FunctionDecl *funcDef = FD->isDefined() ? FD->getDefinition() : FD;
+      if (stu.funcMap.count((uint64_t)funcDef) && stu.funcMap[(uint64_t)funcDef].lowered) {
+        FD = funcDef;
+        stu.currFunc = &stu.funcMap[(uint64_t)FD];
+        return;
+      }
+
       FD = handleFuncNameAndType(FD, true);
       stu.currFunc = &stu.funcMap[(uint64_t) FD];
+      stu.currFunc->inHeader = isInHeader(D); // D has the body
       SLANG_DEBUG("Current Function: " << stu.currFunc->name << " " << (uint64_t)FD->getCanonicalDecl())
+
+      std::string bodyHash;
+      if (cacheDir.size() && FD->hasBody()) {
+        bodyHash = computeBodyHash(FD);
+        // the name of an anonymous record moves with the record, unlike the function
+        if (stu.currFunc->usesAnonymousRecord) {
+          bodyHash = "";
+        }
+      }
+
+      std::string entry;
+      if (bodyHash.size() &&
+          SummaryCache(cacheDir).lookup(SPAN_IR_CACHE_ID, bodyHash, entry) &&
+          stu.reuseFuncIr(entry)) {
+        stu.currFunc->lowered = true;
+        stu.reusedFuncCount += 1;
+        return; // handleFunctionBody() is skipped
+      }
+
+      stu.logVars = bodyHash.size() > 0;
       handleFunctionBody(FD);
+      stu.logVars = false;
+      stu.currFunc->lowered = true;
+      stu.loweredFuncCount += 1;
+
+      if (bodyHash.size() && !stu.currFunc->usesAnonymousRecord) {
+        entry = stu.serializeFuncIr(*stu.currFunc);
+        if (entry.size()) {
+          SummaryCache(cacheDir).store(SPAN_IR_CACHE_ID, bodyHash, entry);
+        }
+      }
+      stu.loggedVars.clear();
+      stu.loggedTypes.clear();
     } else {
       SLANG_ERROR("Decl is not a Function")
     }
-  } // checkASTCodeBody()
+  } // lowerFunction()
 
   // invoked when the whole translation unit has been processed
   void checkEndOfTranslationUnit(const TranslationUnitDecl *TU, AnalysisManager &Mgr,
                                  BugReporter &BR) const {
-    stu.dumpSlangIr();
+    std::string shardDir = getShardDir(Mgr);
+    if (shardDir.size()) {
+      stu.dumpShards(shardDir,
+                     Mgr.getAnalyzerOptions().getCheckerIntegerOption("ShardSize", 1 << 20, this));
+    } else {
+      stu.sharedIrDir = getSharedIrDir(Mgr);
+      stu.typeTableUsed = getTypeTableUsed(Mgr);
+      stu.dumpSlangIr(getOutputSpec(Mgr), getAsyncOutput(Mgr),
+                      Mgr.getAnalyzerOptions().getCheckerBooleanOption("IrIndex", false, this));
+    }
+    if (getPointsTo(Mgr)) {
+      stu.dumpPointsTo();
+    }
+    std::string diagnoses = getDiagnoses(Mgr);
+    if (diagnoses.size()) {
+      runSpanDiagnoses(diagnoses, Mgr, BR);
+    }
+    releaseStmtsIfLast();
     SLANG_EVENT("Translation Unit Ended.\n")
     SLANG_EVENT("BOUND END  : SLANG_Generated_Output.\n")
   } // checkEndOfTranslationUnit()
 
+  // see SlangOutputSink.h, e.g. "file:out.spanir", "fd:3", "pipe:/tmp/span.fifo", "null"
+  // (the SPAN diagnoses need the IR in memory)
+  std::string getOutputSpec(AnalysisManager &mgr) const {
+    std::string outputSpec =
+        mgr.getAnalyzerOptions().getCheckerStringOption("Output", "", this).str();
+    if (outputSpec.empty() && getDiagnoses(mgr).size()) {
+      return "memory";
+    }
+    return outputSpec;
+  }
+
+  // the directory of the "shards" output (see dumpShards()), or ""
+  std::string getShardDir(AnalysisManager &mgr) const {
+    llvm::StringRef outputSpec = mgr.getAnalyzerOptions().getCheckerStringOption("Output", "", this);
+    if (outputSpec.split(':').first != "shards") {
+      return "";
+    }
+    std::string shardDir = outputSpec.split(':').second.str();
+    return shardDir.size() ? shardDir : stu.fileName + ".shards";
+  }
+
+  // the SPAN diagnoses to run in the embedded python, e.g. "DeadStore"
+  std::string getDiagnoses(AnalysisManager &mgr) const {
+    return mgr.getAnalyzerOptions().getCheckerStringOption("Diagnoses", "", this).str();
+  }
+
+  // Runs the SPAN diagnoses on the IR of the TU (in memory), and reports
+  // their bugs; see SlangEmbeddedPython.h.
+  void runSpanDiagnoses(const std::string &diagnoses, AnalysisManager &mgr,
+                        BugReporter &BR) const {
+#ifdef SLANG_EMBED_PYTHON
+    AnalyzerOptions &options = mgr.getAnalyzerOptions();
+    if (getOutputSpec(mgr) != "memory") {
+      SLANG_ERROR("SLANG: ERROR: Diagnoses needs the SPAN IR in memory (Output=memory)")
+      return;
+    }
+
+    std::vector<Bug> bugs;
+    std::string error;
+    std::string spanPath = options.getCheckerStringOption("SpanPath", "", this).str();
+    bool ok = slang::runSpanDiagnoses(stu.memoryIr, diagnoses, spanPath, bugs, error);
+    if (options.getCheckerStringOption("Output", "", this).empty()) {
+      stu.memoryIr.clear(); // only kept for the diagnoses
+    }
+    if (!ok) {
+      SLANG_ERROR("SLANG: ERROR: SPAN diagnoses " << diagnoses << ": " << error)
+      return;
+    }
+
+    // the IR has the line:col of the main file
+    FileID fileId = BR.getSourceManager().getMainFileID();
+    std::stable_sort(bugs.begin(), bugs.end());
+    for (const Bug &bug : bugs) {
+      std::unique_ptr<BugType> &bugType = spanBugTypes[bug.bugName + "\n" + bug.bugCategory];
+      if (!bugType) {
+        bugType.reset(new BugType(this, bug.bugName, bug.bugCategory));
+      }
+      emitBugReport(*bugType, bug, fileId, nullptr, BR);
+    }
+    SLANG_EVENT("SLANG: " << stu.fileName << ": " << bugs.size() << " bugs from " << diagnoses)
+#else
+    SLANG_ERROR("SLANG: ERROR: Diagnoses needs SLANG built with SLANG_EMBED_PYTHON")
+#endif
+  } // runSpanDiagnoses()
+
+  // emits the bug, its line:col positions taken in the file fileId
+  // (D, if given, is the function with the issue)
+  static void emitBugReport(BugType &bugType, const Bug &bug, FileID fileId,
+                            const Decl *D, BugReporter &BR) {
+    const SourceManager &SM = BR.getSourceManager();
+    auto getLoc = [&](const BugMessage &message) {
+      return PathDiagnosticLocation(
+          SM.translateLineCol(fileId, message.getLine(), message.getCol()), SM);
+    };
+
+    auto R = llvm::make_unique<BugReport>(bugType,
+        llvm::StringRef(bug.messages[0].getMessageString()), getLoc(bug.messages[0]));
+    for (size_t i = 1; i < bug.messages.size(); ++i) {
+      R->addNote(llvm::StringRef(bug.messages[i].getMessageString()), getLoc(bug.messages[i]));
+    }
+    if (D) {
+      R->setDeclWithIssue(D);
+    }
+    BR.emitReport(std::move(R));
+  } // emitBugReport()
+
+  // write on a background thread
+  bool getAsyncOutput(AnalysisManager &mgr) const {
+    return mgr.getAnalyzerOptions().getCheckerBooleanOption("AsyncOutput", true, this);
+  }
+
+  // dump the points-to result of the TU (see dumpPointsTo())
+  bool getPointsTo(AnalysisManager &mgr) const {
+    return mgr.getAnalyzerOptions().getCheckerBooleanOption("PointsTo", false, this);
+  }
+
+  // refer to the types by index (see SlangTypeTable.h)
+  bool getTypeTableUsed(AnalysisManager &mgr) const {
+    return mgr.getAnalyzerOptions().getCheckerBooleanOption("TypeTable", true, this);
+  }
+
+  // the store of the functions and records of the headers (see emitShared());
+  // not used with the "memory" output (the SPAN diagnoses read the IR whole)
+  std::string getSharedIrDir(AnalysisManager &mgr) const {
+    if (getOutputSpec(mgr) == "memory") {
+      return "";
+    }
+    return mgr.getAnalyzerOptions().getCheckerStringOption("SharedIrDir", "", this).str();
+  }
+
+  // a Decl of an included file, e.g. a static inline function of a header
+  static bool isInHeader(const Decl *D) {
+    const SourceManager &sourceManager = D->getASTContext().getSourceManager();
+    return !sourceManager.isInMainFile(sourceManager.getExpansionLoc(D->getBeginLoc()));
+  }
+
+  // see SummaryCache; it is shared by the lowering and the analyses
+  std::string getCacheDir(AnalysisManager &mgr) const {
+    return mgr.getAnalyzerOptions().getCheckerStringOption("SummaryCacheDir", "", this).str();
+  }
+
+  // A hash of what the lowering of the function depends on: its source text
+  // (not its position, see reuseFuncIr()), its ODR hash (so the macros it
+  // expands are covered too), its signature and the types its expressions use.
+  // It also adds the records, the globals and the functions (e.g. a callee
+  // only declared) the body uses, as the lowering would.
+  // @return "" if the function cannot be cached (e.g. it is in a macro).
+  std::string computeBodyHash(const FunctionDecl *funcDecl) const {
+    const SourceManager &sourceManager = funcDecl->getASTContext().getSourceManager();
+    SourceRange range = funcDecl->getSourceRange();
+    if (range.getBegin().isMacroID() || range.getEnd().isMacroID()) {
+      return "";
+    }
+    llvm::StringRef text = Lexer::getSourceText(CharSourceRange::getTokenRange(range),
+        sourceManager, funcDecl->getASTContext().getLangOpts());
+    if (text.empty()) {
+      return "";
+    }
+
+    ODRHash odrHash;
+    odrHash.AddFunctionDecl(funcDecl);
+
+    AppendBuffer ss;
+    ss << stu.currFunc->fullName << "\n" << stu.currFunc->funcSig << "\n";
+    ss << stu.currFunc->retType << "\n" << stu.currFunc->col << "\n";
+    ss << odrHash.CalculateHash() << "\n" << text << "\n";
+    hashBodyTypes(funcDecl->getBody(), ss);
+
+    return SummaryCache::hashText(ss.str());
+  } // computeBodyHash()
+
+  // appends the types of the expressions and declarations in stmt,
+  // and the values of the enum constants (they are not in the body text)
+  void hashBodyTypes(const Stmt *stmt, AppendBuffer &ss) const {
+    if (!stmt) {
+      return;
+    }
+
+    if (const DeclStmt *declStmt = dyn_cast<DeclStmt>(stmt)) {
+      for (auto it = declStmt->decl_begin(); it != declStmt->decl_end(); ++it) {
+        if (const ValueDecl *valueDecl = dyn_cast<ValueDecl>(*it)) {
+          ss << convertClangType(valueDecl->getType()) << "\n";
+        }
+      }
+    } else if (const DeclRefExpr *declRefExpr = dyn_cast<DeclRefExpr>(stmt)) {
+      const ValueDecl *valueDecl = declRefExpr->getDecl();
+      if (const EnumConstantDecl *enumConstantDecl = dyn_cast<EnumConstantDecl>(valueDecl)) {
+        ss << enumConstantDecl->getInitVal().toString(10) << "\n";
+      } else if (const VarDecl *varDecl = dyn_cast<VarDecl>(valueDecl)) {
+        if (varDecl->hasGlobalStorage() && !varDecl->isStaticLocal()) {
+          handleValueDecl(varDecl, stu.currFunc->name); // a reused function needs it too
+        }
+      } else if (isa<FunctionDecl>(valueDecl)) {
+        // in funcMap, hence in allConstructs, even if only declared in this TU
+        handleValueDecl(valueDecl, stu.currFunc->name);
+      }
+    } else if (const UnaryExprOrTypeTraitExpr *traitExpr =
+                   dyn_cast<UnaryExprOrTypeTraitExpr>(stmt)) {
+      if (traitExpr->isArgumentType()) {
+        ss << convertClangType(traitExpr->getArgumentType()) << "\n";
+      }
+    }
+
+    if (const Expr *expr = dyn_cast<Expr>(stmt)) {
+      ss << convertClangType(expr->getType()) << "\n";
+    }
+
+    for (const Stmt *child : stmt->children()) {
+      hashBodyTypes(child, ss);
+    }
+  } // hashBodyTypes()
+
   // BOUND END  : top_level_routines
 
   // BOUND START: handling_routines
@@ -593,12 +2073,13 @@ public:
       // funcDecl = funcDecl->getCanonicalDecl();
     }
 
-    if (stu.funcMap.find((uint64_t)funcDecl) == stu.funcMap.end() || force) {
+    if (!stu.funcMap.count((uint64_t)funcDecl) || force) {
       // if here, function not already present. Add its details.
 
       SlangFunc slangFunc{};
       slangFunc.name = funcDecl->getNameInfo().getAsString();
       slangFunc.fullName = stu.convertFuncName(slangFunc.name);
+      getLineCol(funcDecl->getBeginLoc(), slangFunc.line, slangFunc.col);
       SLANG_DEBUG("AddingFunction: " << slangFunc.name << " " << (uint64_t)funcDecl\
       << " " << funcDecl->isDefined() << " " << (uint64_t)funcDecl->getCanonicalDecl())
 
@@ -608,15 +2089,16 @@ public:
       for (unsigned i = 0, e = funcDecl->getNumParams(); i != e; ++i) {
         const ParmVarDecl *paramVarDecl = funcDecl->getParamDecl(i);
         handleValueDecl(paramVarDecl, slangFunc.name); // adds the var too
-        slangFunc.paramNames.push_back(stu.getVar((uint64_t)paramVarDecl).name);
+        slangFunc.paramNameIds.push_back(stu.getVar((uint64_t)paramVarDecl).nameId);
       }
       slangFunc.variadic = funcDecl->isVariadic();
+      slangFunc.funcSig = convertFunctionProtoType(funcDecl->getType());
 
       // STEP 1.3: Get function return type.
       slangFunc.retType = convertClangType(funcDecl->getReturnType());
 
       // STEP 2: Copy the function to the map.
-      stu.funcMap[(uint64_t)funcDecl] = slangFunc;
+      stu.funcMap[(uint64_t)funcDecl] = std::move(slangFunc);
     }
 
     return realFuncDecl;
@@ -644,21 +2126,27 @@ public:
         SLANG_DEBUG("NEW_VAR: " << slangVar.convertToString())
 
         if (varName == "") {
-          // used only to name anonymous function parameters
-          varName = Util::getNextUniqueIdStr() + "param";
+          // used only to name anonymous function parameters,
+          // by position, e.g. "2param" for the second one
+          if (const ParmVarDecl *parmVarDecl = dyn_cast<ParmVarDecl>(varDecl)) {
+            varName = std::to_string(parmVarDecl->getFunctionScopeIndex() + 1) + "param";
+          } else {
+            varName = Util::getNextUniqueIdStr() + "param";
+          }
         }
 
         if (varDecl->hasLocalStorage()) {
           slangVar.setLocalVarName(varName, funcName);
-          if (stu.varCountMap.find(slangVar.name) != stu.varCountMap.end()) {
-            stu.varCountMap[slangVar.name]++;
-            uint64_t newVarId = stu.varCountMap[slangVar.name];
+          auto count = stu.varCountMap.find(slangVar.nameId);
+          if (count != stu.varCountMap.end()) {
+            uint32_t newVarId = ++count->second;
             slangVar.setLocalVarName(std::to_string(newVarId) + "D" + varName, funcName);
           } else {
-            stu.varCountMap[slangVar.name] = 1;
+            stu.varCountMap[slangVar.nameId] = 1;
           }
         } else if (varDecl->hasGlobalStorage()) {
           slangVar.setGlobalVarName(varName);
+          slangVar.internal = !varDecl->hasExternalFormalLinkage();
         } else if (varDecl->hasExternalStorage()) {
           SLANG_ERROR("External Storage Not Handled.")
         } else {
@@ -675,10 +2163,10 @@ public:
                                                          arrayType->getElementType());
 
             SlangExpr allocExpr;
-            std::stringstream ss;
+            AppendBuffer ss;
             ss << "expr.AllocE(" << sizeExpr.expr;
             ss << ", " << getLocationString(valueDecl) << ")";
-            allocExpr.expr = ss.str();
+            allocExpr.expr = stu.save(ss.getRef());
             allocExpr.qualType = FD->getASTContext().VoidPtrTy;
             allocExpr.locStr = getLocationString(valueDecl);
             allocExpr.compound = true;
@@ -686,11 +2174,11 @@ public:
             SlangExpr tmpVoidPtr = convertToTmp(allocExpr);
 
             SlangExpr castExpr;
-            ss.str("");
+            ss.clear();
             ss << "expr.CastE(" << tmpVoidPtr.expr;
             ss << ", op.CastOp(" << convertClangType(valueDecl->getType()) << ")";
             ss << ", " << getLocationString(valueDecl) << ")";
-            castExpr.expr = ss.str();
+            castExpr.expr = stu.save(ss.getRef());
             castExpr.qualType = valueDecl->getType();
             castExpr.compound = true;
             castExpr.locStr = getLocationString(valueDecl);
@@ -712,13 +2200,13 @@ public:
             if (varDecl->hasLocalStorage()) {
               SlangExpr slangExpr = convertStmt(varDecl->getInit());
               std::string locStr = getLocationString(valueDecl);
-              std::stringstream ss;
+              AppendBuffer ss;
               ss << "instr.AssignI(";
-              ss << "expr.VarE(\"" << slangVar.name << "\"";
+              ss << "expr.VarE(\"" << slangVar.getName() << "\"";
               ss << ", " << locStr << ")"; // close expr.VarE(...
               ss << ", " << slangExpr.expr;
               ss << ", " << locStr << ")"; // close instr.AssignI(...
-              stu.addStmt(ss.str());
+              stu.addStmt(ss.getRef());
             }
           }
         }
@@ -737,7 +2225,7 @@ public:
     stu.setLastDeclStmtTo(declStmt);
     SLANG_DEBUG("Set last DeclStmt to DeclStmt at " << (uint64_t)(declStmt));
 
-    std::stringstream ss;
+    AppendBuffer ss;
     std::string locStr = getLocationString(declStmt);
 
     for (auto it = declStmt->decl_begin(); it != declStmt->decl_end(); ++it) {
@@ -892,10 +2380,10 @@ public:
           convertStmt(varArrayType->getSizeExpr()));
 
       SlangExpr sizeOfInnerNonVarArrType;
-      std::stringstream ss;
+      AppendBuffer ss;
       ss << "expr.LitE(" << size;
       ss << ", " << thisVarArrSizeExpr.locStr << ")";
-      sizeOfInnerNonVarArrType.expr = ss.str();
+      sizeOfInnerNonVarArrType.expr = stu.save(ss.getRef());
       sizeOfInnerNonVarArrType.qualType = FD->getASTContext().UnsignedIntTy;
       sizeOfInnerNonVarArrType.locStr = thisVarArrSizeExpr.locStr;
 
@@ -946,7 +2434,7 @@ public:
   SlangExpr genInitLhsExpr(SlangVar& slangVar,
       const VarDecl *varDecl, std::vector<uint32_t>& indexVector) const {
     SlangExpr slangExpr;
-    std::stringstream ss;
+    AppendBuffer ss;
 
     std::string prefix = "";
     if (varDecl->getType()->isArrayType()) {
@@ -957,14 +2445,14 @@ public:
         }
       }
 
-      ss << ", expr.VarE(\"" << slangVar.name << "\"";
+      ss << ", expr.VarE(\"" << slangVar.getName() << "\"";
       ss << ", " << getLocationString(varDecl) << ")";
 
       for (auto it = indexVector.begin(); it != indexVector.end(); ++it) {
         ss << ", " << getLocationString(varDecl) << ")";
       }
 
-      slangExpr.expr = ss.str();
+      slangExpr.expr = stu.save(ss.getRef());
       slangExpr.compound = true;
       slangExpr.qualType = varDecl->getType();
       slangExpr.locStr = getLocationString(varDecl);
@@ -984,14 +2472,14 @@ public:
           stu.getRecord((uint64_t)recordDecl).genMemberExpr(indexVector);
 
       ss << memberListStr;
-      ss << ", expr.VarE(\"" << slangVar.name << "\"";
+      ss << ", expr.VarE(\"" << slangVar.getName() << "\"";
       ss << ", " << getLocationString(varDecl) << ")";
 
       for (auto it = indexVector.begin(); it != indexVector.end(); ++it) {
         ss << ", " << getLocationString(varDecl) << ")";
       }
 
-      slangExpr.expr = ss.str();
+      slangExpr.expr = stu.save(ss.getRef());
       slangExpr.compound = true;
       slangExpr.qualType = varDecl->getType();
       slangExpr.locStr = getLocationString(varDecl);
@@ -1014,6 +2502,21 @@ public:
     return rightExpr;
   } // convertBinaryCommaOp()
 
+  // record the call in the call graph: a direct call names its callee,
+  // a call through a pointer is recorded by the callee's signature
+  void recordCallEdge(const CallExpr *callExpr) const {
+    if (const FunctionDecl *calleeDecl = callExpr->getDirectCallee()) {
+      stu.currFunc->callees.insert(
+          stu.convertFuncName(calleeDecl->getNameInfo().getAsString()));
+    } else {
+      QualType calleeType = callExpr->getCallee()->getType();
+      if (calleeType->isPointerType()) {
+        calleeType = calleeType->getPointeeType();
+      }
+      stu.currFunc->indirectCallSigs.insert(convertFunctionProtoType(calleeType));
+    }
+  } // recordCallEdge()
+
   SlangExpr convertCallExpr(const CallExpr *callExpr) const {
     SlangExpr slangExpr;
 
@@ -1021,6 +2524,7 @@ public:
 
     const Stmt *callee = *it;
     SlangExpr calleeExpr = convertToTmp(convertStmt(callee));
+    recordCallEdge(callExpr);
 
     std::vector<const Stmt*> args;
     ++it; // skip the callee expression
@@ -1028,7 +2532,7 @@ public:
       args.push_back(*it);
     }
 
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "expr.CallE(" << calleeExpr.expr;
     if (args.size()) {
       std::string prefix = "";
@@ -1047,15 +2551,15 @@ public:
 
     ss << ", " << getLocationString(callExpr) <<  ")"; // close expr.CallE(...
 
-    slangExpr.expr = ss.str();
+    slangExpr.expr = stu.save(ss.getRef());
     slangExpr.qualType = callExpr->getType();
     slangExpr.locStr = getLocationString(callExpr);
     slangExpr.compound = true;
-    ss.str("");
+    ss.clear();
 
     if (isTopLevel(callExpr)) {
       ss << "instr.CallI(" << slangExpr.expr << ", " << slangExpr.locStr << ")";
-      stu.addStmt(ss.str());
+      stu.addStmt(ss.getRef());
       return SlangExpr{}; // return empty expression
     }
 
@@ -1064,7 +2568,7 @@ public:
 
   SlangExpr convertArraySubscriptExpr(const ArraySubscriptExpr *arrayExpr) const {
     SlangExpr slangExpr;
-    std::stringstream ss;
+    AppendBuffer ss;
 
     auto it = arrayExpr->child_begin();
     const Stmt *object = *it;
@@ -1082,7 +2586,7 @@ public:
       ss << convertClangType(FD->getASTContext().getPointerType(arrayExpr->getType()));
       ss << ")";
       ss << ", " << getLocationString(arrayExpr) << ")";
-      tmpExpr.expr = ss.str();
+      tmpExpr.expr = stu.save(ss.getRef());
       tmpExpr.qualType = FD->getASTContext().getPointerType(arrayExpr->getType());
       tmpExpr.compound = true;
       tmpExpr.locStr = getLocationString(arrayExpr);
@@ -1099,12 +2603,12 @@ public:
     //   parentExpr = convertToTmp(parentExpr);
     // }
 
-    ss.str("");
+    ss.clear();
     ss << "expr.ArrayE(" << indexExpr.expr;
     ss << ", " << tmpExpr.expr;
     ss << ", " << getLocationString(arrayExpr) << ")";
 
-    slangExpr.expr = ss.str();
+    slangExpr.expr = stu.save(ss.getRef());
     slangExpr.qualType = arrayExpr->getType();
     slangExpr.locStr = getLocationString(arrayExpr);
     slangExpr.compound = true;
@@ -1118,7 +2622,7 @@ public:
     SlangExpr parentExpr = convertStmt(child);
     SlangExpr parentTmpExpr;
     SlangExpr memSlangExpr;
-    std::stringstream ss;
+    AppendBuffer ss;
 
     // store parent to a temporary
     parentTmpExpr = parentExpr;
@@ -1130,7 +2634,7 @@ public:
         ss << "expr.AddrOfE(" << parentExpr.expr;
         ss << ", " << getLocationString(memberExpr) << ")";
 
-        addrOfExpr.expr = ss.str();
+        addrOfExpr.expr = stu.save(ss.getRef());
         addrOfExpr.qualType = FD->getASTContext().getPointerType(parentExpr.qualType);
         addrOfExpr.locStr = getLocationString(memberExpr);
         addrOfExpr.compound = true;
@@ -1142,15 +2646,15 @@ public:
     std::string memberName;
     memberName = memberExpr->getMemberNameInfo().getAsString();
     if (memberName == "") {
-      memberName = stu.getVar((uint64_t)(memberExpr->getMemberDecl())).name;
+      memberName = stu.getVar((uint64_t)(memberExpr->getMemberDecl())).getName();
     }
 
-    ss.str("");
+    ss.clear();
     ss << "expr.MemberE(\"" << memberName << "\"";
     ss << ", " << parentTmpExpr.expr;
     ss << ", " << getLocationString(memberExpr) << ")";
 
-    memSlangExpr.expr = ss.str();
+    memSlangExpr.expr = stu.save(ss.getRef());
     memSlangExpr.qualType = memberExpr->getType();
     memSlangExpr.locStr = getLocationString(memberExpr);
     memSlangExpr.compound = true;
@@ -1164,12 +2668,12 @@ public:
     SlangExpr exprArg = convertToTmp(convertStmt(*it));
     std::string castTypeStr = convertClangType(cCast->getType());
 
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "expr.CastE(" << exprArg.expr;
     ss << ", op.CastOp(" << castTypeStr << ")";
     ss << ", " << getLocationString(cCast) << ")";
 
-    castExpr.expr = ss.str();
+    castExpr.expr = stu.save(ss.getRef());
     castExpr.compound = true;
     castExpr.qualType = cCast->getType();
     castExpr.locStr = getLocationString(cCast);
@@ -1227,7 +2731,7 @@ public:
       }
     }
 
-    std::stringstream ss;
+    AppendBuffer ss;
     std::string label;
     std::string nextLabel;
     size_t totalStmts = caseStmtsWithDefault.size();
@@ -1247,7 +2751,7 @@ public:
             if (isa<CaseStmt>(caseStmtsWithDefault[i])) {
               ss << caseCondLabel << i;
               falseLabel = ss.str();
-              ss.str("");
+              ss.clear();
               break;
             }
           }
@@ -1256,7 +2760,7 @@ public:
         // armed with the falseLabel add the condition
         ss << caseCondLabel << index;
         std::string condLabel = ss.str();
-        ss.str("");
+        ss.clear();
 
         const Stmt *cond = *(caseStmt->child_begin());
         // llvm::errs() << "CASE-CASE-CASE\n"; cond->dump();
@@ -1265,7 +2769,7 @@ public:
         // generate body label
         ss << caseBodyLabel << index;
         std::string bodyLabel = ss.str();
-        ss.str("");
+        ss.clear();
 
         addLabelInstr(condLabel); // condition label
         // add the actual condition
@@ -1291,7 +2795,7 @@ public:
             if (isa<CaseStmt>(caseStmtsWithDefault[index + 1])) {
               ss << caseBodyLabel << index + 1;
               addGotoInstr(ss.str());
-              ss.str("");
+              ss.clear();
             } else {
               // must be default then, hence fall through to it
             }
@@ -1317,7 +2821,7 @@ public:
             // must be a case stmt, since this is a default stmt :)
             ss << caseBodyLabel << index+1;
             addGotoInstr(ss.str());
-            ss.str("");
+            ss.clear();
           }
         }
       }
@@ -1451,13 +2955,13 @@ public:
 
     SlangExpr retExpr = convertToTmp(convertStmt(retVal));
 
-    std::stringstream ss;
+    AppendBuffer ss;
     if (retExpr.expr.size() == 0) {
       retExpr.expr = "None";
     }
     ss << "instr.ReturnI(" << retExpr.expr;
     ss << ", " << getLocationString(returnStmt) << ")";
-    stu.addStmt(ss.str());
+    stu.addStmt(ss.getRef());
 
     return SlangExpr{};
   }
@@ -1470,12 +2974,12 @@ public:
     SlangExpr falseExpr = convertToTmp(convertStmt(condOp->getFalseExpr()));
 
     SlangExpr slangExpr;
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "expr.SelectE(" << cond.expr;
     ss << ", " << trueExpr.expr;
     ss << ", " << falseExpr.expr;
     ss << ", " << getLocationString(condition) << ")";
-    slangExpr.expr = ss.str();
+    slangExpr.expr = stu.save(ss.getRef());
     slangExpr.compound = true;
     slangExpr.qualType = condition->getType();
 
@@ -1627,12 +3131,12 @@ public:
         SlangExpr exprArg = convertToTmp(convertStmt(*it));
         std::string castTypeStr = convertClangType(iCast->getType());
 
-        std::stringstream ss;
+        AppendBuffer ss;
         ss << "expr.CastE(" << exprArg.expr;
         ss << ", op.CastOp(" << castTypeStr << ")";
         ss << ", " << getLocationString(iCast) << ")";
 
-        castExpr.expr = ss.str();
+        castExpr.expr = stu.save(ss.getRef());
         castExpr.compound = true;
         castExpr.qualType = iCast->getType();
         castExpr.locStr = getLocationString(iCast);
@@ -1645,12 +3149,12 @@ public:
   }
 
   SlangExpr convertCharacterLiteral(const CharacterLiteral *cl) const {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "expr.LitE(" << cl->getValue();
     ss << ", " << getLocationString(cl) << ")";
 
     SlangExpr slangExpr;
-    slangExpr.expr = ss.str();
+    slangExpr.expr = stu.save(ss.getRef());
     slangExpr.locStr = getLocationString(cl);
     slangExpr.qualType = cl->getType();
 
@@ -1663,7 +3167,7 @@ public:
   } // convertConstantExpr()
 
   SlangExpr convertIntegerLiteral(const IntegerLiteral *il) const {
-    std::stringstream ss;
+    AppendBuffer ss;
     std::string suffix = ""; // helps make int appear float
 
     std::string locStr = getLocationString(il);
@@ -1697,7 +3201,7 @@ public:
     SLANG_TRACE(ss.str())
 
     SlangExpr slangExpr;
-    slangExpr.expr = ss.str();
+    slangExpr.expr = stu.save(ss.getRef());
     slangExpr.qualType = il->getType();
     slangExpr.locStr = getLocationString(il);
 
@@ -1705,7 +3209,7 @@ public:
   } // convertIntegerLiteral()
 
   SlangExpr convertFloatingLiteral(const FloatingLiteral *fl) const {
-    std::stringstream ss;
+    AppendBuffer ss;
     bool toInt = false;
 
     std::string locStr = getLocationString(fl);
@@ -1736,13 +3240,13 @@ public:
     if (toInt) {
       ss << (int64_t)fl->getValue().convertToDouble();
     } else {
-      ss << std::fixed << fl->getValue().convertToDouble();
+      ss.appendFixed(fl->getValue().convertToDouble());
     }
     ss << ", " << locStr << ")";
     SLANG_TRACE(ss.str())
 
     SlangExpr slangExpr;
-    slangExpr.expr = ss.str();
+    slangExpr.expr = stu.save(ss.getRef());
     slangExpr.qualType = fl->getType();
     slangExpr.locStr = getLocationString(fl);
 
@@ -1751,7 +3255,7 @@ public:
 
   SlangExpr convertStringLiteral(const StringLiteral *sl) const {
     SlangExpr slangExpr;
-    std::stringstream ss;
+    AppendBuffer ss;
 
     std::string locStr = getLocationString(sl);
 
@@ -1761,7 +3265,7 @@ public:
     // making the string invalid in python
     ss << "expr.LitE(\"\"\"" << sl->getBytes().str() << "XXX\"\"\"";
     ss << ", " << locStr << ")";
-    slangExpr.expr = ss.str();
+    slangExpr.expr = stu.save(ss.getRef());
     slangExpr.locStr = locStr;
 
     return slangExpr;
@@ -1769,12 +3273,12 @@ public:
 
   SlangExpr convertVariable(const VarDecl *varDecl,
       std::string locStr = "Loc(3,3)") const {
-    std::stringstream ss;
+    AppendBuffer ss;
     SlangExpr slangExpr;
 
     ss << "expr.VarE(\"" << stu.convertVarExpr((uint64_t)varDecl) << "\"";
     ss << ", " << locStr << ")";
-    slangExpr.expr = ss.str();
+    slangExpr.expr = stu.save(ss.getRef());
     slangExpr.qualType = varDecl->getType();
     slangExpr.varId = (uint64_t)varDecl;
     slangExpr.locStr = getLocationString(varDecl);
@@ -1785,11 +3289,11 @@ public:
   SlangExpr convertEnumConst(const EnumConstantDecl *ecd, std::string &locStr) const {
     SlangExpr slangExpr;
 
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "expr.LitE(" << (ecd->getInitVal()).toString(10);
     ss << ", " << locStr << ")";
 
-    slangExpr.expr = ss.str();
+    slangExpr.expr = stu.save(ss.getRef());
     slangExpr.locStr = locStr;
     slangExpr.qualType = ecd->getType();
 
@@ -1798,7 +3302,7 @@ public:
 
   SlangExpr convertDeclRefExpr(const DeclRefExpr *dre) const {
     SlangExpr slangExpr;
-    std::stringstream ss;
+    AppendBuffer ss;
 
     std::string locStr = getLocationString(dre);
 
@@ -1819,7 +3323,7 @@ public:
       std::string funcName = funcDecl->getNameInfo().getAsString();
       ss << "expr.FuncE(\"" << stu.convertFuncName(funcName) << "\"";
       ss << ", " << locStr << ")";
-      slangExpr.expr = ss.str();
+      slangExpr.expr = stu.save(ss.getRef());
       slangExpr.qualType = funcDecl->getType();
       slangExpr.locStr = locStr;
       return slangExpr;
@@ -1862,8 +3366,8 @@ public:
 
     SlangExpr trueValue;
     SlangExpr falseValue;
-    trueValue.expr = "expr.LitE(1, " + getLocationString(binOp) + ")";
-    falseValue.expr = "expr.LitE(0, " + getLocationString(binOp) + ")";
+    trueValue.expr = stu.save("expr.LitE(1, " + getLocationString(binOp) + ")");
+    falseValue.expr = stu.save("expr.LitE(0, " + getLocationString(binOp) + ")");
     trueValue.locStr = falseValue.locStr = getLocationString(binOp);
 
     // assign tmp = 1
@@ -1907,7 +3411,7 @@ public:
     }
 
     SlangExpr litOne;
-    litOne.expr = "expr.LitE(1, " + getLocationString(unOp) + ")";
+    litOne.expr = stu.save("expr.LitE(1, " + getLocationString(unOp) + ")");
     litOne.locStr = getLocationString(unOp);
 
     SlangExpr incDecExpr = createBinaryExpr(exprArg, op,
@@ -1967,7 +3471,7 @@ public:
       case UO_LNot: op = "op.UO_LNOT"; break;
       case UO_Not: op = "op.UO_BIT_NOT"; break;
       case UO_Extension:
-        exprArg.expr = "expr.LitE(0," + getLocationString(unOp) + ")";
+        exprArg.expr = stu.save("expr.LitE(0," + getLocationString(unOp) + ")");
         exprArg.qualType = unOp->getType();
         exprArg.locStr = getLocationString(unOp);
         exprArg.compound = false;
@@ -1980,7 +3484,7 @@ public:
   SlangExpr convertUnaryExprOrTypeTraitExpr(const UnaryExprOrTypeTraitExpr *stmt) const {
     SlangExpr slangExpr;
     SlangExpr innerExpr;
-    std::stringstream ss;
+    AppendBuffer ss;
     uint64_t size = 0;
 
     std::string locStr = getLocationString(stmt);
@@ -2021,7 +3525,7 @@ public:
             ss << size;
         }
         ss << ", " << locStr << ")";
-        slangExpr.expr = ss.str();
+        slangExpr.expr = stu.save(ss.getRef());
         break;
     }
 
@@ -2095,11 +3599,11 @@ public:
       } else {
         tmpExpr = genTmpVariable("t", slangExpr.qualType, slangExpr.locStr);
       }
-      std::stringstream ss;
+      AppendBuffer ss;
 
       ss << "instr.AssignI(" << tmpExpr.expr << ", " << slangExpr.expr;
       ss << ", " << slangExpr.locStr << ")"; // close instr.AssignI(...
-      stu.addStmt(ss.str());
+      stu.addStmt(ss.getRef());
 
       return tmpExpr;
     } else {
@@ -2116,11 +3620,11 @@ public:
       } else {
         tmpExpr = genTmpVariable("if", slangExpr.qualType, slangExpr.locStr);
       }
-      std::stringstream ss;
+      AppendBuffer ss;
 
       ss << "instr.AssignI(" << tmpExpr.expr << ", " << slangExpr.expr;
       ss << ", " << slangExpr.locStr << ")"; // close instr.AssignI(...
-      stu.addStmt(ss.str());
+      stu.addStmt(ss.getRef());
 
       return tmpExpr;
     } else {
@@ -2211,13 +3715,13 @@ public:
 
   SlangExpr convertLabel(const LabelStmt *labelStmt) const {
     SlangExpr slangExpr;
-    std::stringstream ss;
+    AppendBuffer ss;
 
     std::string locStr = getLocationString(labelStmt);
 
     ss << "instr.LabelI(\"" << labelStmt->getName() << "\"";
     ss << ", " << locStr << ")"; // close instr.LabelI(...
-    stu.addStmt(ss.str());
+    stu.addStmt(ss.getRef());
 
     for (auto it = labelStmt->child_begin(); it != labelStmt->child_end(); ++it) {
       convertStmt(*it);
@@ -2228,9 +3732,29 @@ public:
 
   // BOUND START: type_conversion_routines
 
-  // converts clang type to span ir types
+  // converts clang type to span ir types (and adds its layout, see dumpTypeLayouts())
   std::string convertClangType(QualType qt) const {
-    std::stringstream ss;
+    std::string typeStr = convertClangTypeStr(qt);
+    addTypeLayout(getCleanedQualType(qt), typeStr);
+    return typeStr;
+  }
+
+  // the layout of a complete type, but of a record (see SlangRecord::layoutToString())
+  void addTypeLayout(QualType qt, const std::string &typeStr) const {
+    if (qt.isNull() || !FD || !llvm::StringRef(typeStr).startswith("types.")) {
+      return; // e.g. "UnknownType."
+    }
+    const Type *type = qt.getTypePtr();
+    if (type->isRecordType() || type->isFunctionType() || type->isIncompleteType() ||
+        !type->isConstantSizeType()) {
+      return; // e.g. void, int[], int[n]
+    }
+    TypeInfo typeInfo = FD->getASTContext().getTypeInfo(qt);
+    stu.addTypeLayout(typeStr, typeInfo.Width / 8, typeInfo.Align / 8);
+  }
+
+  std::string convertClangTypeStr(QualType qt) const {
+    AppendBuffer ss;
 
     if (qt.isNull()) {
       return "types.Int32"; // the default type
@@ -2279,10 +3803,10 @@ public:
     }
 
     return ss.str();
-  } // convertClangType()
+  } // convertClangTypeStr()
 
   std::string convertClangBuiltinType(QualType qt) const {
-    std::stringstream ss;
+    AppendBuffer ss;
 
     const Type *type = qt.getTypePtr();
 
@@ -2312,10 +3836,11 @@ public:
         ss << "UnknownUnsignedIntType.";
       }
 
-    } else if (type->isFloatingType()) {
-      ss << "types.Float32";
     } else if (type->isRealFloatingType()) {
-      ss << "types.Float64"; // FIXME: is realfloat a double?
+      // by the bits of the format: e.g. types.Float80 for an x87 long double,
+      // whose size (see dumpTypeLayouts()) is 16 bytes
+      const llvm::fltSemantics &semantics = FD->getASTContext().getFloatTypeSemantics(qt);
+      ss << "types.Float" << llvm::APFloat::semanticsSizeInBits(semantics);
 
     } else if (type->isVoidType()) {
       ss << "types.Void";
@@ -2336,36 +3861,51 @@ public:
       return convertClangRecordType(lastAnonymousRecordDecl, returnSlangRecord);
     }
 
+    if (recordDecl->getName().empty() && stu.currFunc) {
+      stu.currFunc->usesAnonymousRecord = true; // see lowerFunction()
+    }
+
     if (stu.isRecordPresent((uint64_t)recordDecl)) {
       returnSlangRecord = &stu.getRecord((uint64_t)recordDecl); // return pointer back
       return stu.getRecord((uint64_t)recordDecl).toShortString();
     }
 
-    std::string namePrefix;
     SlangRecord slangRecord;
 
     if (recordDecl->isStruct()) {
-      namePrefix = "s:";
       slangRecord.recordKind = Struct;
     } else if (recordDecl->isUnion()) {
-      namePrefix = "u:";
       slangRecord.recordKind = Union;
     }
 
-    if (recordDecl->getNameAsString() == "") {
+    getLineCol(recordDecl->getBeginLoc(), slangRecord.line, slangRecord.col);
+
+    SymbolId recordName;
+    if (recordDecl->getName().empty()) {
       slangRecord.anonymous = true;
-      slangRecord.name = namePrefix + stu.getNextRecordIdStr();
+      recordName = stu.getAnonymousRecordName(slangRecord.line, slangRecord.col);
     } else {
       slangRecord.anonymous = false;
-      slangRecord.name = namePrefix + recordDecl->getNameAsString();
+      recordName = symbols.getString(recordDecl->getName());
     }
+    slangRecord.nameId = symbols.getRecord(slangRecord.recordKind == Union, recordName);
 
     slangRecord.locStr = getLocationString(recordDecl);
+    slangRecord.inHeader = isInHeader(recordDecl);
 
     stu.addRecord((uint64_t)recordDecl, slangRecord);                  // IMPORTANT
     SlangRecord &newSlangRecord = stu.getRecord((uint64_t)recordDecl); // IMPORTANT
     returnSlangRecord = &newSlangRecord; // IMPORTANT
 
+    // the layout (of a record defined, see dumpTypeLayouts())
+    const ASTContext &context = recordDecl->getASTContext();
+    const ASTRecordLayout *layout = nullptr;
+    if (recordDecl->isCompleteDefinition() && !recordDecl->isInvalidDecl()) {
+      layout = &context.getASTRecordLayout(recordDecl);
+      newSlangRecord.size = layout->getSize().getQuantity();
+      newSlangRecord.align = layout->getAlignment().getQuantity();
+    }
+
     SlangRecordField slangRecordField;
 
     SlangRecord *getBackSlangRecord;
@@ -2378,17 +3918,23 @@ public:
 
         slangRecordField.clear();
 
-        if (fieldDecl->getNameAsString() == "") {
-          slangRecordField.name = newSlangRecord.getNextAnonymousFieldIdStr() + "a";
+        if (fieldDecl->getName().empty()) {
+          slangRecordField.nameId =
+              symbols.getString(newSlangRecord.getNextAnonymousFieldIdStr() + "a");
           slangRecordField.anonymous = true;
         } else {
-          slangRecordField.name = fieldDecl->getNameAsString();
+          slangRecordField.nameId = symbols.getString(fieldDecl->getName());
           slangRecordField.anonymous = false;
         }
 
         slangRecordField.type = fieldDecl->getType();
+        if (layout) {
+          slangRecordField.offset = layout->getFieldOffset(fieldDecl->getFieldIndex());
+          slangRecordField.bitWidth =
+              fieldDecl->isBitField() ? fieldDecl->getBitWidthValue(context) : 0;
+        }
         if (slangRecordField.anonymous) {
-          auto slangVar = SlangVar((uint64_t) fieldDecl, slangRecordField.name);
+          auto slangVar = SlangVar((uint64_t) fieldDecl, slangRecordField.getName());
           stu.addVar((uint64_t) fieldDecl, slangVar);
           slangRecordField.typeStr = convertClangRecordType(nullptr,
               slangRecordField.slangRecord);
@@ -2420,7 +3966,7 @@ public:
   } // convertClangRecordType()
 
   std::string convertClangArrayType(QualType qt) const {
-    std::stringstream ss;
+    AppendBuffer ss;
 
     const Type *type = qt.getTypePtr();
     const ArrayType *arrayType = type->getAsArrayTypeUnsafe();
@@ -2451,7 +3997,7 @@ public:
   } // convertClangArrayType()
 
   std::string convertFunctionProtoType(QualType qt) const {
-    std::stringstream ss;
+    AppendBuffer ss;
 
     const Type *funcType = qt.getTypePtr();
 
@@ -2474,6 +4020,12 @@ public:
       }
       ss << ")"; // close types.FuncSig(...
 
+    } else if (auto funcNoProtoType = dyn_cast<FunctionNoProtoType>(funcType)) {
+      // no paramTypes: the call graph resolves a call through a pointer
+      // to it to the functions with its return type (see SlangCallGraph.h)
+      ss << "types.FuncSig(returnType=";
+      ss << convertClangType(funcNoProtoType->getReturnType()) << ")";
+
     } else {
       ss << "UnknownFunctionProtoType";
     }
@@ -2482,7 +4034,7 @@ public:
   } // convertFunctionPointerType()
 
   std::string convertFunctionPointerType(QualType qt) const {
-    std::stringstream ss;
+    AppendBuffer ss;
 
     const Type *type = qt.getTypePtr();
 
@@ -2508,8 +4060,9 @@ public:
       ss << ")"; // close types.FuncSig(...
       ss << ")"; // close types.Ptr(...
 
-    } else if (isa<FunctionNoProtoType>(funcType)) {
-      ss << "types.FuncSig(returnType=types.Int32)";
+    } else if (auto funcNoProtoType = dyn_cast<FunctionNoProtoType>(funcType)) {
+      ss << "types.FuncSig(returnType=";
+      ss << convertClangType(funcNoProtoType->getReturnType()) << ")";
       ss << ")"; // close types.Ptr(...
 
     } else if (isa<FunctionType>(funcType)) {
@@ -2529,15 +4082,14 @@ public:
 
   SlangExpr genTmpVariable(std::string suffix, std::string typeStr,
       std::string locStr) const {
-    std::stringstream ss;
+    AppendBuffer ss;
     SlangExpr slangExpr{};
 
     // STEP 1: Populate a SlangVar object with unique name.
     SlangVar slangVar{};
     slangVar.id = stu.nextUniqueId();
     uint64_t tmpNumbering = stu.nextTmpId();
-    ss << "" << tmpNumbering << suffix;
-    slangVar.setLocalVarName(ss.str(), stu.getCurrFuncName());
+    slangVar.setLocalVarName(std::to_string(tmpNumbering) + suffix, stu.getCurrFuncName());
     slangVar.typeStr = typeStr;
 
     // STEP 2: Add to the var map.
@@ -2545,11 +4097,10 @@ public:
     stu.addVar(slangVar.id, slangVar);
 
     // STEP 3: generate var expression.
-    ss.str(""); // empty the stream
-    ss << "expr.VarE(\"" << slangVar.name << "\"";
+    ss << "expr.VarE(\"" << slangVar.getName() << "\"";
     ss << ", " << locStr << ")";
 
-    slangExpr.expr = ss.str();
+    slangExpr.expr = stu.save(ss.getRef());
     slangExpr.locStr = locStr;
     // slangExpr.qualType = qt;
     slangExpr.nonTmpVar = false;
@@ -2559,15 +4110,14 @@ public:
 
   SlangExpr genTmpVariable(std::string suffix,
       QualType qt, std::string locStr, bool ifTmp = false) const {
-    std::stringstream ss;
+    AppendBuffer ss;
     SlangExpr slangExpr{};
 
     // STEP 1: Populate a SlangVar object with unique name.
     SlangVar slangVar{};
     slangVar.id = stu.nextUniqueId();
     uint64_t tmpNumbering = stu.nextTmpId();
-    ss << "" << tmpNumbering << suffix;
-    slangVar.setLocalVarName(ss.str(), stu.getCurrFuncName());
+    slangVar.setLocalVarName(std::to_string(tmpNumbering) + suffix, stu.getCurrFuncName());
     slangVar.typeStr = convertClangType(qt);
 
     // STEP 2: Add to the var map.
@@ -2575,11 +4125,10 @@ public:
     stu.addVar(slangVar.id, slangVar);
 
     // STEP 3: generate var expression.
-    ss.str(""); // empty the stream
-    ss << "expr.VarE(\"" << slangVar.name << "\"";
+    ss << "expr.VarE(\"" << slangVar.getName() << "\"";
     ss << ", " << locStr << ")";
 
-    slangExpr.expr = ss.str();
+    slangExpr.expr = stu.save(ss.getRef());
     slangExpr.locStr = locStr;
     slangExpr.qualType = qt;
     slangExpr.nonTmpVar = false;
@@ -2587,8 +4136,14 @@ public:
     return slangExpr;
   } // genTmpVariable()
 
+  void getLineCol(SourceLocation loc, uint32_t &line, uint32_t &col) const {
+    const SourceManager &sourceManager = FD->getASTContext().getSourceManager();
+    line = sourceManager.getExpansionLineNumber(loc);
+    col = sourceManager.getExpansionColumnNumber(loc);
+  }
+
   std::string getLocationString(const Stmt *stmt) const {
-    std::stringstream ss;
+    AppendBuffer ss;
     uint32_t line = 0;
     uint32_t col = 0;
 
@@ -2602,7 +4157,7 @@ public:
   }
 
   std::string getLocationString(const RecordDecl *recordDecl) const {
-    std::stringstream ss;
+    AppendBuffer ss;
     uint32_t line = 0;
     uint32_t col = 0;
 
@@ -2617,7 +4172,7 @@ public:
   }
 
   std::string getLocationString(const ValueDecl *valueDecl) const {
-    std::stringstream ss;
+    AppendBuffer ss;
     uint32_t line = 0;
     uint32_t col = 0;
 
@@ -2642,35 +4197,35 @@ public:
   }
 
   void addGotoInstr(std::string label) const {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "instr.GotoI(\"" << label << "\")";
-    stu.addStmt(ss.str());
+    stu.addStmt(ss.getRef());
   }
 
   void addLabelInstr(std::string label) const {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "instr.LabelI(\"" << label << "\")";
-    stu.addStmt(ss.str());
+    stu.addStmt(ss.getRef());
   }
 
-  void addCondInstr(std::string expr,
+  void addCondInstr(llvm::StringRef expr,
       std::string trueLabel, std::string falseLabel, std::string locStr) const {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "instr.CondI(" << expr;
     ss << ", \"" << trueLabel << "\"";
     ss << ", \"" << falseLabel << "\"";
     ss << ", " << locStr << ")";
-    stu.addStmt(ss.str());
+    stu.addStmt(ss.getRef());
   }
 
   void addAssignInstr(SlangExpr& lhs, SlangExpr rhs, std::string locStr) const {
-    std::stringstream ss;
+    AppendBuffer ss;
     if (lhs.compound && rhs.compound) {
       rhs = convertToTmp(rhs);
     }
     ss << "instr.AssignI(" << lhs.expr;
     ss << ", " << rhs.expr << ", " << locStr << ")";
-    stu.addStmt(ss.str());
+    stu.addStmt(ss.getRef());
   }
 
   // Note: unlike createBinaryExpr, createUnaryExpr doesn't convert its expr to tmp expr.
@@ -2678,7 +4233,7 @@ public:
       SlangExpr expr, std::string locStr, QualType qt) const {
     SlangExpr unaryExpr;
 
-    std::stringstream ss;
+    AppendBuffer ss;
 
     if (op == "op.UO_ADDROF") {
       ss << "expr.AddrOfE(";
@@ -2690,7 +4245,7 @@ public:
       ss << ", " << locStr << ")";
     }
 
-    unaryExpr.expr = ss.str();
+    unaryExpr.expr = stu.save(ss.getRef());
     unaryExpr.qualType = qt;
     unaryExpr.compound = true;
     unaryExpr.locStr = locStr;
@@ -2705,13 +4260,13 @@ public:
     lhsExpr = convertToTmp(lhsExpr);
     rhsExpr = convertToTmp(rhsExpr);
 
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "expr.BinaryE(" << lhsExpr.expr;
     ss << ", " << op;
     ss << ", " << rhsExpr.expr;
     ss << ", " << locStr << ")";
 
-    binaryExpr.expr = ss.str();
+    binaryExpr.expr = stu.save(ss.getRef());
     binaryExpr.qualType = lhsExpr.qualType;
     binaryExpr.compound = true;
     binaryExpr.locStr = locStr;
@@ -2757,14 +4312,14 @@ public:
   } // isTopLevel()
 
   SlangExpr addAndReturnSizeOfInstrExpr(SlangExpr tmpElementVarArr) const {
-    std::stringstream ss;
+    AppendBuffer ss;
 
     SlangExpr tmpExpr = convertToTmp(tmpElementVarArr);
 
     SlangExpr sizeOfExpr;
     ss << "expr.SizeOfE(" << tmpExpr.expr;
     ss << ", " << tmpElementVarArr.locStr << ")";
-    sizeOfExpr.expr = ss.str();
+    sizeOfExpr.expr = stu.save(ss.getRef());
     sizeOfExpr.qualType = FD->getASTContext().UnsignedIntTy;
     sizeOfExpr.compound = true;
     sizeOfExpr.locStr = tmpElementVarArr.locStr;
@@ -2776,13 +4331,186 @@ public:
 
   // BOUND END  : helper_routines
 };
+
+// Lowers each function like SlangGenAstChecker, runs the native liveness
+// analysis on its instrSeq and reports the dead stores through BugReporter.
+// Nothing is written to the disk. (If both checkers are enabled together,
+// each function is lowered once, by the first, see lowerFunction().)
+class SlangDeadStoreChecker : public SlangGenAstChecker {
+  mutable std::unique_ptr<BugType> deadStoreBugType;
+
+  // the functions lowered, analyzed at the end of the TU (on Threads threads)
+  mutable std::vector<std::pair<const Decl *, const SlangFunc *>> pendingFuncs;
+
+  // the result of the analysis of a function, written by its task only
+  struct DeadStoreResult {
+    std::vector<DeadStore> deadStores;
+    bool cached = false; // read from the SummaryCache
+    std::string error;   // (logged on the main thread)
+  };
+
+public:
+  void checkASTCodeBody(const Decl *D, AnalysisManager &mgr, BugReporter &BR) const {
+    if (!isInScope(D, mgr)) {
+      declareFunction(D);
+      return;
+    }
+
+    lowerFunction(D, getCacheDir(mgr)); // nothing is written out
+
+    if (!FD || !FD->hasBody()) {
+      return;
+    }
+    pendingFuncs.push_back(std::make_pair(D, stu.currFunc));
+  } // checkASTCodeBody()
+
+  // Analyzes the pending functions on Threads threads. Only the analysis
+  // runs on the workers: the errors are logged, the results stored in the
+  // SummaryCache and the dead stores reported here, in the order of the
+  // function names, whatever the number of threads.
+  void checkEndOfTranslationUnit(const TranslationUnitDecl *TU, AnalysisManager &Mgr,
+                                 BugReporter &BR) const {
+    if (pendingFuncs.empty()) {
+      releaseStmtsIfLast();
+      return;
+    }
+
+    std::sort(pendingFuncs.begin(), pendingFuncs.end(),
+        [](const std::pair<const Decl *, const SlangFunc *> &a,
+           const std::pair<const Decl *, const SlangFunc *> &b) {
+          return a.second->fullName < b.second->fullName;
+        });
+
+    size_t count = pendingFuncs.size();
+    std::string cacheDir = getCacheDir(Mgr);
+    std::vector<std::string> irHashes(count);
+    std::vector<uint64_t> costs(count);
+    for (size_t i = 0; i < count; ++i) {
+      const SlangFunc &slangFunc = *pendingFuncs[i].second;
+      if (cacheDir.size()) {
+        irHashes[i] = stu.computeIrHash(slangFunc);
+      }
+      // cost: the instructions and the basic blocks (labels)
+      costs[i] = slangFunc.spanStmts.size();
+      for (llvm::StringRef stmt : slangFunc.spanStmts) {
+        costs[i] += stmt.startswith(LABEL_PREFIX);
+      }
+    }
+
+    // each task writes only its own slot, so the merge is deterministic
+    std::vector<DeadStoreResult> results(count);
+    TaskScheduler scheduler(std::max(getThreads(Mgr), 1));
+    scheduler.run(costs, [&](size_t i) {
+      analyzeFunction(*pendingFuncs[i].second, cacheDir, irHashes[i], results[i]);
+    });
+    SLANG_DEBUG("DeadStore: " << count << " functions on " << scheduler.getNumWorkers()
+                << " threads, " << scheduler.getStealCount() << " steals")
+
+    for (size_t i = 0; i < count; ++i) {
+      const DeadStoreResult &result = results[i];
+      if (result.error.size()) {
+        SLANG_ERROR(result.error)
+        continue;
+      }
+      if (cacheDir.size() && !result.cached) {
+        SummaryCache(cacheDir).store(DEAD_STORE_ANALYSIS_ID, irHashes[i],
+                                     serializeDeadStores(result.deadStores));
+      }
+      reportDeadStores(result.deadStores, pendingFuncs[i].first, BR);
+    }
+    pendingFuncs.clear();
+    releaseStmtsIfLast();
+  } // checkEndOfTranslationUnit()
+
+  int getThreads(AnalysisManager &mgr) const {
+    return mgr.getAnalyzerOptions().getCheckerIntegerOption("Threads", 1, this);
+  }
+
+  // Computes the dead stores of a lowered function. It only reads the
+  // SlangFunc (and the SummaryCache), and logs nothing, so it can run on a
+  // worker, in parallel on different functions. The result of a function
+  // already analyzed (e.g. in a header) is read from the SummaryCache, if
+  // cacheDir is given.
+  static void analyzeFunction(const SlangFunc &slangFunc, const std::string &cacheDir,
+      const std::string &irHash, DeadStoreResult &result) {
+    std::string summary;
+    if (cacheDir.size() &&
+        SummaryCache(cacheDir).lookup(DEAD_STORE_ANALYSIS_ID, irHash, summary)) {
+      result.deadStores = parseDeadStores(summary);
+      result.cached = true;
+      return;
+    }
+
+    LivenessAnalysis liveness;
+    if (!liveness.analyze(slangFunc.name, slangFunc.spanStmts)) {
+      result.error = "Liveness not computed for: " + slangFunc.fullName;
+      return;
+    }
+    result.deadStores = liveness.getDeadStores();
+  } // analyzeFunction()
+
+  void reportDeadStores(const std::vector<DeadStore> &deadStores, const Decl *D,
+                        BugReporter &BR) const {
+    for (const DeadStore &deadStore : deadStores) {
+      AppendBuffer ss;
+      ss << "Value stored to '" << LivenessAnalysis::getSourceVarName(deadStore.varName);
+      ss << "' is never read";
+
+      std::vector<BugMessage> messages;
+      messages.push_back(BugMessage(deadStore.line, deadStore.col, ss.str()));
+      generateBugReport(Bug("Dead Store", "Dead Variable", messages), D, BR);
+    }
+  }
+
+  // one dead store per line: "<varName> <line> <col>"
+  static std::string serializeDeadStores(const std::vector<DeadStore> &deadStores) {
+    AppendBuffer ss;
+    for (const DeadStore &deadStore : deadStores) {
+      ss << deadStore.varName << " " << deadStore.line << " " << deadStore.col << "\n";
+    }
+    return ss.str();
+  }
+
+  static std::vector<DeadStore> parseDeadStores(const std::string &summary) {
+    std::vector<DeadStore> deadStores;
+    std::stringstream ss(summary);
+    DeadStore deadStore;
+    while (ss >> deadStore.varName >> deadStore.line >> deadStore.col) {
+      deadStores.push_back(deadStore);
+    }
+    return deadStores;
+  }
+
+  void generateBugReport(const Bug &bug, const Decl *D, BugReporter &BR) const {
+    if (!deadStoreBugType) {
+      deadStoreBugType.reset(new BugType(this, bug.bugName, bug.bugCategory));
+    }
+
+    // the IR only has line:col, so map it back into the function's file
+    const SourceManager &SM = BR.getSourceManager();
+    FileID fileId = SM.getFileID(SM.getExpansionLoc(D->getBeginLoc()));
+    emitBugReport(*deadStoreBugType, bug, fileId, D, BR);
+  } // generateBugReport()
+};
 } // anonymous namespace
 
 // static_members initialized
 SlangTranslationUnit SlangGenAstChecker::stu = SlangTranslationUnit();
 const FunctionDecl *SlangGenAstChecker::FD = nullptr;
+int SlangGenAstChecker::stuUsers = 0;
+int SlangGenAstChecker::stuUsersDone = 0;
+
+std::string slang::takeMemoryIr() {
+  std::string memoryIr = std::move(SlangGenAstChecker::stu.memoryIr);
+  SlangGenAstChecker::stu.memoryIr.clear();
+  return memoryIr;
+}
 
 // Register the Checker
 void ento::registerSlangGenAstChecker(CheckerManager &mgr) {
   mgr.registerChecker<SlangGenAstChecker>();
 }
+
+void ento::registerSlangDeadStoreChecker(CheckerManager &mgr) {
+  mgr.registerChecker<SlangDeadStoreChecker>();
+}
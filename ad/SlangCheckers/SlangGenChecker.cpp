@@ -181,7 +181,7 @@ void SlangGenChecker::handleFunctionDef(const FunctionDecl *funcDecl) const {
 } // handleFunctionDef()
 
 void SlangGenChecker::handleFunction(const FunctionDecl *funcDecl) const {
-    if (stu.funcMap.find((uint64_t)funcDecl) == stu.funcMap.end()) {
+    if (!stu.funcMap.count((uint64_t)funcDecl)) {
         // if here, function not already present. Add its details.
         SlangFunc slangFunc{};
         slangFunc.name = funcDecl->getNameInfo().getAsString();
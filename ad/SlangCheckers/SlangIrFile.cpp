@@ -0,0 +1,535 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// A whole .spanir file, parsed and validated, for the C++ tools.
+//===----------------------------------------------------------------------===//
+
+#include "SlangIrFile.h"
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+#include "llvm/ADT/SmallVector.h"
+
+using namespace slang;
+
+bool IrFile::readFile(const std::string &path, std::string &error) {
+    // a large file is memory mapped (it needs no terminating null)
+    auto mapped = llvm::MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                                              /*RequiresNullTerminator=*/false);
+    if (!mapped) {
+        error = path + ": cannot read: " + mapped.getError().message();
+        return false;
+    }
+    buffer = std::move(*mapped);
+    return parse(buffer->getBuffer(), path, error);
+}
+
+bool IrFile::parse(llvm::StringRef text, llvm::StringRef fileName, std::string &error) {
+    this->fileName = fileName.str();
+    this->text = text;
+    textSize = text.size();
+    name.clear();
+    funcs.clear();
+    records.clear();
+    vars.clear();
+    typeLayouts.clear();
+    sharedRefs.clear();
+    funcIndex.clear();
+    this->error.clear();
+
+    parser.reset();
+    if (!parser.parse(text, root)) {
+        error = this->fileName + ":" + parser.getError();
+        return false;
+    }
+    if (!expandTypeRefs() || !validate()) {
+        error = this->error;
+        return false;
+    }
+    return true;
+}
+
+const IrFunc *IrFile::findFunc(llvm::StringRef funcName) const {
+    auto found = funcIndex.find(funcName);
+    return found == funcIndex.end() ? nullptr : &funcs[found->second];
+}
+
+bool IrFile::checkIndex(llvm::StringRef indexText, llvm::StringRef indexName,
+                        std::string &error) const {
+    llvm::SmallVector<llvm::StringRef, 64> lines;
+    indexText.split(lines, '\n');
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        llvm::SmallVector<llvm::StringRef, 8> fields;
+        lines[i].split(fields, '\t');
+        std::stringstream where;
+        where << indexName.str() << ":" << (i + 1) << ": ";
+
+        uint64_t offset = 0, length = 0;
+        if (lines[i].empty() || lines[i].startswith("#")) {
+            continue;
+        } else if (fields[0] == "spanir") {
+            if (fields.size() != 3 || fields[2].getAsInteger(10, length) || length != textSize) {
+                error = where.str() + "the index is stale (the size differs)";
+                return false;
+            }
+        } else if (fields[0] == "vars" || fields[0] == "records" || fields[0] == "types") {
+            if (fields.size() != 3 || fields[1].getAsInteger(10, offset) ||
+                fields[2].getAsInteger(10, length) || offset + length > textSize) {
+                error = where.str() + "bad offset or length";
+                return false;
+            }
+        } else if (fields[0] == "func") {
+            uint32_t instrs = 0;
+            if (fields.size() != 7 || fields[2].getAsInteger(10, offset) ||
+                fields[3].getAsInteger(10, length) || fields[5].getAsInteger(10, instrs)) {
+                error = where.str() + "bad function entry";
+                return false;
+            }
+            const IrFunc *func = findFunc(fields[1]);
+            if (!func) {
+                error = where.str() + "no function '" + fields[1].str() + "'";
+                return false;
+            }
+            // the entry spans the constructs.Func(...) value
+            if (offset != func->node->offset || offset + length > textSize ||
+                text[offset + length - 1] != ')') {
+                error = where.str() + "the offset or length of '" + func->name +
+                        "' differs (the function is at " + getPosition(*func->node) + ")";
+                return false;
+            }
+            uint32_t funcInstrs = 0;
+            if (func->instrSeq) {
+                for (const IrNode &instr : func->instrSeq->children) {
+                    funcInstrs += !instr.isCall("instr.LabelI");
+                }
+            }
+            if (instrs != funcInstrs) {
+                error = where.str() + "the instruction count of '" + func->name + "' differs";
+                return false;
+            }
+        } else {
+            error = where.str() + "unknown entry '" + fields[0].str() + "'";
+            return false;
+        }
+    }
+    return true;
+} // checkIndex()
+
+std::string IrFile::getPosition(const IrNode &node) const {
+    uint32_t line, col;
+    parser.getLineCol(node.offset, line, col);
+    std::stringstream ss;
+    ss << line << ":" << col;
+    return ss.str();
+}
+
+bool IrFile::fail(const IrNode &node, const std::string &message) {
+    if (error.empty()) {
+        error = fileName + ":" + getPosition(node) + ": " + message;
+    }
+    return false;
+}
+
+// BOUND START: validation
+
+// Replaces each T(<index>) of the tree by (a copy of) the type in the
+// allTypes list (see SlangTypeTable.h), and drops the list: the tools see
+// the types in full.
+bool IrFile::expandTypeRefs() {
+    if (root.kind != IrCall) {
+        return true; // see validate()
+    }
+    auto found = std::find_if(root.children.begin(), root.children.end(),
+                              [](const IrNode &arg) { return arg.keyword == "allTypes"; });
+    if (found == root.children.end()) {
+        return true;
+    }
+    IrNode allTypes = *found;
+    std::copy(found + 1, root.children.end(), found);
+    root.children = root.children.drop_back();
+    if (allTypes.kind != IrList) {
+        return fail(allTypes, "expected a list of the types");
+    }
+    for (const IrNode &type : allTypes.children) {
+        if (!isType(type)) {
+            return fail(type, "expected a type");
+        }
+    }
+    return expandTypeRefs(root, allTypes.children);
+}
+
+bool IrFile::expandTypeRefs(IrNode &node, llvm::ArrayRef<IrNode> types) {
+    if (!node.isCall("T")) {
+        for (IrNode &child : node.children) {
+            if (!expandTypeRefs(child, types)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint64_t index;
+    if (node.children.size() != 1 || node.children[0].kind != IrNum ||
+        node.children[0].text.getAsInteger(10, index) || index >= types.size()) {
+        return fail(node, "bad type reference");
+    }
+    llvm::StringRef keyword = node.keyword;
+    uint32_t offset = node.offset;
+    node = types[index]; // (shares the children of the type)
+    node.keyword = keyword;
+    node.offset = offset;
+    return true;
+}
+
+// the root: a call with only keyword arguments (see SlangIrFile.h)
+bool IrFile::validate() {
+    if (!root.isCall("tunit.TranslationUnit") && !root.isCall("irTUnit.TUnit") &&
+        !root.isCall("ir.TranslationUnit")) {
+        return fail(root, "expected tunit.TranslationUnit(...)");
+    }
+
+    std::set<std::string> keywords;
+    bool hasConstructs = false;
+    const IrNode *internalVars = nullptr; // (after allVars)
+    for (const IrNode &arg : root.children) {
+        if (arg.keyword.empty()) {
+            return fail(arg, "expected a keyword argument");
+        }
+        if (!keywords.insert(arg.keyword.str()).second) {
+            return fail(arg, "repeated argument '" + arg.keyword.str() + "'");
+        }
+
+        if (arg.keyword == "name" || arg.keyword == "description") {
+            if (arg.kind != IrStr) {
+                return fail(arg, "expected a string for '" + arg.keyword.str() + "'");
+            }
+            if (arg.keyword == "name") {
+                name = arg.text.str();
+            }
+        } else if (arg.keyword == "allConstructs" || arg.keyword == "allObjs") {
+            hasConstructs = true;
+            if (!validateConstructs(arg)) {
+                return false;
+            }
+        } else if (arg.keyword == "allVars") {
+            if (!validateVars(arg)) {
+                return false;
+            }
+        } else if (arg.keyword == "callGraph") {
+            if (!validateCallGraph(arg)) {
+                return false;
+            }
+        } else if (arg.keyword == "callGraphSccs") {
+            if (!validateSccs(arg)) {
+                return false;
+            }
+        } else if (arg.keyword == "typeLayouts") {
+            if (!validateTypeLayouts(arg)) {
+                return false;
+            }
+        } else if (arg.keyword == "sharedConstructs") {
+            if (!validateSharedRefs(arg)) {
+                return false;
+            }
+        } else if (arg.keyword == "internalVars") {
+            internalVars = &arg;
+        } else {
+            return fail(arg, "unknown argument '" + arg.keyword.str() + "'");
+        }
+    }
+
+    if (!keywords.count("name")) {
+        return fail(root, "the argument 'name' is missing");
+    }
+    if (!hasConstructs) {
+        return fail(root, "the argument 'allConstructs' is missing");
+    }
+    return !internalVars || validateInternalVars(*internalVars);
+} // validate()
+
+// "NAME": constructs.Func(...) or types.Struct(...)/types.Union(...)
+bool IrFile::validateConstructs(const IrNode &dict) {
+    if (dict.kind != IrDict) {
+        return fail(dict, "expected a dict of the constructs");
+    }
+    for (size_t i = 0; i + 1 < dict.children.size(); i += 2) {
+        const IrNode &key = dict.children[i];
+        const IrNode &value = dict.children[i + 1];
+        if (key.kind != IrStr) {
+            return fail(key, "expected a string key");
+        }
+
+        if (value.isCall("constructs.Func") || value.isCall("obj.Func")) {
+            if (!validateFunc(key, value)) {
+                return false;
+            }
+        } else if (value.isCall("types.Struct") || value.isCall("types.Union")) {
+            if (!validateRecord(key, value)) {
+                return false;
+            }
+        } else {
+            return fail(value, "expected constructs.Func(...) or a record");
+        }
+    }
+    return true;
+} // validateConstructs()
+
+bool IrFile::validateFunc(const IrNode &key, const IrNode &node) {
+    IrFunc func;
+    func.node = &node;
+
+    const IrNode *nameArg = node.getKeywordArg("name");
+    if (!nameArg || nameArg->kind != IrStr || nameArg->text != key.text) {
+        return fail(nameArg ? *nameArg : node, "expected name = \"" + key.text.str() + "\"");
+    }
+    func.name = nameArg->text.str();
+    if (funcIndex.count(func.name)) {
+        return fail(key, "repeated function '" + func.name + "'");
+    }
+
+    const IrNode *params = node.getKeywordArg("paramNames");
+    if (params) {
+        if (params->kind != IrList) {
+            return fail(*params, "expected a list of the parameter names");
+        }
+        for (const IrNode &param : params->children) {
+            if (param.kind != IrStr) {
+                return fail(param, "expected a parameter name");
+            }
+            func.paramNames.push_back(param.text.str());
+        }
+    }
+
+    const IrNode *variadic = node.getKeywordArg("variadic");
+    if (variadic) {
+        if (!variadic->isName("True") && !variadic->isName("False")) {
+            return fail(*variadic, "expected True or False");
+        }
+        func.variadic = variadic->isName("True");
+    }
+
+    func.returnType = node.getKeywordArg("returnType");
+    if (!func.returnType || !isType(*func.returnType)) {
+        return fail(func.returnType ? *func.returnType : node, "expected returnType = a type");
+    }
+
+    const IrNode *irHash = node.getKeywordArg("irHash");
+    if (irHash) {
+        if (irHash->kind != IrStr) {
+            return fail(*irHash, "expected a string");
+        }
+        func.irHash = irHash->text.str();
+    }
+
+    const IrNode *instrSeq = node.getKeywordArg("instrSeq");
+    const IrNode *basicBlocks = node.getKeywordArg("basicBlocks");
+    if (instrSeq) {
+        if (instrSeq->kind != IrList) {
+            return fail(*instrSeq, "expected instrSeq = [...]");
+        }
+        for (const IrNode &instr : instrSeq->children) {
+            if (instr.kind != IrCall || !instr.text.startswith("instr.")) {
+                return fail(instr, "expected an instruction (instr.*)");
+            }
+        }
+        func.instrSeq = instrSeq;
+    } else if (!basicBlocks || basicBlocks->kind != IrDict) {
+        return fail(basicBlocks ? *basicBlocks : node, "expected instrSeq = [...]");
+    }
+
+    funcIndex[func.name] = funcs.size();
+    funcs.push_back(std::move(func));
+    return true;
+} // validateFunc()
+
+bool IrFile::validateRecord(const IrNode &key, const IrNode &node) {
+    IrRecord record;
+    record.node = &node;
+    record.isUnion = node.isCall("types.Union");
+
+    const IrNode *nameArg = node.getKeywordArg("name");
+    if (!nameArg || nameArg->kind != IrStr || nameArg->text != key.text) {
+        return fail(nameArg ? *nameArg : node, "expected name = \"" + key.text.str() + "\"");
+    }
+    record.name = nameArg->text.str();
+
+    const IrNode *members = node.getKeywordArg("members");
+    if (!members) {
+        members = node.getKeywordArg("fields"); // the older name
+    }
+    if (!members || members->kind != IrList) {
+        return fail(members ? *members : node, "expected members = [...]");
+    }
+    for (const IrNode &member : members->children) {
+        if (member.kind != IrTuple || member.children.size() != 2 ||
+            member.children[0].kind != IrStr || !isType(member.children[1])) {
+            return fail(member, "expected a (name, type) member");
+        }
+        record.members.push_back(
+            std::make_pair(member.children[0].text.str(), &member.children[1]));
+    }
+
+    const IrNode *loc = node.getKeywordArg("loc");
+    if (loc) {
+        if (!loc->isCall("Loc") || loc->children.size() != 2 ||
+            loc->children[0].kind != IrNum || loc->children[1].kind != IrNum) {
+            return fail(*loc, "expected Loc(LINE,COL)");
+        }
+        record.line = (uint32_t)loc->children[0].getUInt();
+        record.col = (uint32_t)loc->children[1].getUInt();
+    }
+
+    records.push_back(std::move(record));
+    return true;
+} // validateRecord()
+
+// "v:main:x": TYPE
+bool IrFile::validateVars(const IrNode &dict) {
+    if (dict.kind != IrDict) {
+        return fail(dict, "expected a dict of the variables");
+    }
+    for (size_t i = 0; i + 1 < dict.children.size(); i += 2) {
+        const IrNode &key = dict.children[i];
+        const IrNode &value = dict.children[i + 1];
+        if (key.kind != IrStr) {
+            return fail(key, "expected a variable name");
+        }
+        if (!isType(value)) {
+            return fail(value, "expected the type of '" + key.text.str() + "'");
+        }
+        IrVar var;
+        var.name = key.text.str();
+        var.type = &value;
+        vars.push_back(std::move(var));
+    }
+    return true;
+} // validateVars()
+
+// "f:main": ["f:foo", ...]
+bool IrFile::validateCallGraph(const IrNode &dict) {
+    if (dict.kind != IrDict) {
+        return fail(dict, "expected a dict of the callees");
+    }
+    for (size_t i = 0; i + 1 < dict.children.size(); i += 2) {
+        const IrNode &key = dict.children[i];
+        const IrNode &callees = dict.children[i + 1];
+        if (key.kind != IrStr) {
+            return fail(key, "expected a function name");
+        }
+        if (callees.kind != IrList) {
+            return fail(callees, "expected a list of the callees");
+        }
+        for (const IrNode &callee : callees.children) {
+            if (callee.kind != IrStr) {
+                return fail(callee, "expected a function name");
+            }
+        }
+    }
+    return true;
+} // validateCallGraph()
+
+// (LEVEL, ["f:main", ...])
+bool IrFile::validateSccs(const IrNode &list) {
+    if (list.kind != IrList) {
+        return fail(list, "expected a list of the SCCs");
+    }
+    for (const IrNode &scc : list.children) {
+        if (scc.kind != IrTuple || scc.children.size() != 2 || scc.children[0].kind != IrNum ||
+            scc.children[1].kind != IrList) {
+            return fail(scc, "expected a (level, [functions]) SCC");
+        }
+        for (const IrNode &funcName : scc.children[1].children) {
+            if (funcName.kind != IrStr) {
+                return fail(funcName, "expected a function name");
+            }
+        }
+    }
+    return true;
+} // validateSccs()
+
+// "f:inl": "HASH"
+bool IrFile::validateSharedRefs(const IrNode &dict) {
+    if (dict.kind != IrDict) {
+        return fail(dict, "expected a dict of the shared constructs");
+    }
+    for (size_t i = 0; i + 1 < dict.children.size(); i += 2) {
+        const IrNode &key = dict.children[i];
+        const IrNode &hash = dict.children[i + 1];
+        if (key.kind != IrStr || hash.kind != IrStr) {
+            return fail(key, "expected \"NAME\": \"HASH\"");
+        }
+        sharedRefs.push_back(std::make_pair(key.text.str(), hash.text.str()));
+    }
+    return true;
+} // validateSharedRefs()
+
+// ["v:count", ...]: marks these variables internal
+bool IrFile::validateInternalVars(const IrNode &list) {
+    if (list.kind != IrList) {
+        return fail(list, "expected a list of the internal variables");
+    }
+    std::set<std::string> names;
+    for (const IrNode &varName : list.children) {
+        if (varName.kind != IrStr) {
+            return fail(varName, "expected a variable name");
+        }
+        names.insert(varName.text.str());
+    }
+    for (IrVar &var : vars) {
+        var.internal = names.count(var.name) != 0;
+    }
+    return true;
+} // validateInternalVars()
+
+// "s:node": (SIZE, ALIGN, [(OFFSET, BITWIDTH), ...]), or TYPE: (SIZE, ALIGN)
+bool IrFile::validateTypeLayouts(const IrNode &dict) {
+    if (dict.kind != IrDict) {
+        return fail(dict, "expected a dict of the type layouts");
+    }
+    auto isNum = [](const IrNode &node) { return node.kind == IrNum && node.text[0] != '-'; };
+    for (size_t i = 0; i + 1 < dict.children.size(); i += 2) {
+        const IrNode &key = dict.children[i];
+        const IrNode &value = dict.children[i + 1];
+        bool isRecord = key.kind == IrStr;
+        if (!isRecord && !isType(key)) {
+            return fail(key, "expected a record name or a type");
+        }
+        if (value.kind != IrTuple || value.children.size() != (isRecord ? 3 : 2) ||
+            !isNum(value.children[0]) || !isNum(value.children[1]) ||
+            (isRecord && value.children[2].kind != IrList)) {
+            return fail(value, isRecord ? "expected (SIZE, ALIGN, [(OFFSET, BITWIDTH), ...])"
+                                        : "expected (SIZE, ALIGN)");
+        }
+
+        IrTypeLayout layout;
+        layout.key = &key;
+        layout.node = &value;
+        layout.size = value.children[0].getUInt();
+        layout.align = value.children[1].getUInt();
+        for (size_t m = 0; isRecord && m < value.children[2].children.size(); ++m) {
+            const IrNode &member = value.children[2].children[m];
+            if (member.kind != IrTuple || member.children.size() != 2 ||
+                !isNum(member.children[0]) || !isNum(member.children[1])) {
+                return fail(member, "expected (OFFSET, BITWIDTH)");
+            }
+            layout.members.push_back(std::make_pair(member.children[0].getUInt(),
+                                                    (uint32_t)member.children[1].getUInt()));
+        }
+        typeLayouts.push_back(std::move(layout));
+    }
+    return true;
+} // validateTypeLayouts()
+
+// e.g. types.Int32, types.Ptr(to=types.Int8)
+bool IrFile::isType(const IrNode &node) const {
+    return (node.kind == IrName || node.kind == IrCall) && node.text.startswith("types.");
+}
+
+// BOUND END  : validation
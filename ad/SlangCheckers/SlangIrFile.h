@@ -0,0 +1,186 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// A whole .spanir file, parsed and validated, for the C++ tools.
+//
+// The file is memory mapped and parsed with IrParser. Its structure is
+// then checked against what the SLANG checkers emit (see dumpHeader() and
+// the other dump routines of SlangTranslationUnit),
+//
+//     tunit.TranslationUnit(            (or the older irTUnit.TUnit, ir.TranslationUnit)
+//       name = "test.c",
+//       description = "...",
+//       allConstructs = {"f:main": constructs.Func(...), "s:node": types.Struct(...)},
+//       allVars = {"v:main:x": types.Int32, ...},
+//       callGraph = {"f:main": ["f:foo"], ...},
+//       callGraphSccs = [(0, ["f:foo"]), ...],
+//       typeLayouts = {"s:node": (16, 8, [(0, 0), (64, 0)]), types.Int32: (4, 4), ...},
+//       internalVars = ["v:count", ...],            (optional, see IrVar::internal)
+//       sharedConstructs = {"f:inl": "HASH", ...},   (optional, see getSharedRefs())
+//     )
+//
+// The types referred to by index, T(<index>), are first replaced by those of
+// the allTypes list (see SlangTypeTable.h).
+//
+// The functions, records, variables and layouts are then made available as
+// IrFunc, IrRecord, IrVar and IrTypeLayout (pointing into the parsed tree).
+// A malformed file is rejected with the FILE:LINE:COL of the offending node.
+//
+// checkIndex() checks the index of the file (the .spanir.idx file written
+// with the checker option IrIndex=true, see dumpIrIndex() of
+// SlangGenAstChecker.cpp) against the parsed file.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_IRFILE_H
+#define SLANG_IRFILE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "SlangIrParser.h"
+
+namespace slang {
+
+/** A function (constructs.Func) of a SPAN IR file. */
+class IrFunc {
+  public:
+    std::string name; // e.g. "f:main"
+    std::vector<std::string> paramNames;
+    bool variadic;
+    const IrNode *returnType;
+    std::string irHash;                 // "" if absent
+    // the list of the instructions (empty for a declaration; nullptr in the
+    // older basicBlocks form, see node)
+    const IrNode *instrSeq;
+    const IrNode *node;
+
+    IrFunc() : variadic{false}, returnType{nullptr}, instrSeq{nullptr}, node{nullptr} {}
+};
+
+/** A record (types.Struct or types.Union) of a SPAN IR file. */
+class IrRecord {
+  public:
+    std::string name; // e.g. "s:node"
+    bool isUnion;
+    // (member name, member type)
+    std::vector<std::pair<std::string, const IrNode *>> members;
+    uint32_t line, col; // its Loc
+    const IrNode *node;
+
+    IrRecord() : isUnion{false}, line{0}, col{0}, node{nullptr} {}
+};
+
+/** A variable (an allVars entry) of a SPAN IR file. */
+class IrVar {
+  public:
+    std::string name; // e.g. "v:main:x"
+    const IrNode *type;
+    // a global of internal linkage (listed in internalVars, e.g. static)
+    bool internal;
+
+    IrVar() : type{nullptr}, internal{false} {}
+};
+
+/** A typeLayouts entry of a SPAN IR file (see dumpTypeLayouts() of
+ *  SlangGenAstChecker.cpp): the layout of a record, or of another type.
+ */
+class IrTypeLayout {
+  public:
+    const IrNode *key;    // the record name ("s:node"), or the type
+    uint64_t size, align; // in bytes
+    // of a record, the (offset in bits, bit width) of each member
+    std::vector<std::pair<uint64_t, uint32_t>> members;
+    const IrNode *node;
+
+    IrTypeLayout() : key{nullptr}, size{0}, align{0}, node{nullptr} {}
+};
+
+class IrFile {
+  public:
+    IrFile() : textSize{0} {}
+
+    /** Reads (memory maps) and parses the file, and validates it.
+     *  @return false on an error ("FILE:LINE:COL: message" in error).
+     */
+    bool readFile(const std::string &path, std::string &error);
+
+    /** Parses the text (kept by the caller while this IrFile is used). */
+    bool parse(llvm::StringRef text, llvm::StringRef fileName, std::string &error);
+
+    const std::string &getName() const { return name; }
+    uint64_t getTextSize() const { return textSize; }
+    const IrNode &getRoot() const { return root; }
+    const std::vector<IrFunc> &getFuncs() const { return funcs; }
+    const std::vector<IrRecord> &getRecords() const { return records; }
+    const std::vector<IrVar> &getVars() const { return vars; }
+    const std::vector<IrTypeLayout> &getTypeLayouts() const { return typeLayouts; }
+
+    /** The constructs of the headers, kept in the SharedIrDir (see the
+     *  checker option): (name, hash of the entry). The entries, in the
+     *  SummaryCache layout with the SHARED_IR_CACHE_ID, are IR files too.
+     */
+    const std::vector<std::pair<std::string, std::string>> &getSharedRefs() const {
+        return sharedRefs;
+    }
+
+    /** @return the function named, or nullptr. */
+    const IrFunc *findFunc(llvm::StringRef funcName) const;
+
+    /** Checks that the index (the text of a .spanir.idx file) matches
+     *  the file: its size, and the offset, length and counts of each function.
+     *  @return false on a mismatch ("INDEX:LINE: message" in error).
+     */
+    bool checkIndex(llvm::StringRef indexText, llvm::StringRef indexName,
+                    std::string &error) const;
+
+    /** @return the "LINE:COL" of a node of the tree. */
+    std::string getPosition(const IrNode &node) const;
+
+  private:
+    std::unique_ptr<llvm::MemoryBuffer> buffer;
+    llvm::StringRef text;
+    std::string fileName;
+    uint64_t textSize;
+    IrParser parser;
+    IrNode root;
+
+    std::string name;
+    std::vector<IrFunc> funcs;
+    std::vector<IrRecord> records;
+    std::vector<IrVar> vars;
+    std::vector<IrTypeLayout> typeLayouts;
+    std::vector<std::pair<std::string, std::string>> sharedRefs;
+    llvm::StringMap<size_t> funcIndex; // name -> index in funcs
+
+    // the first validation error
+    std::string error;
+
+    bool expandTypeRefs();
+    bool expandTypeRefs(IrNode &node, llvm::ArrayRef<IrNode> types);
+    bool validate();
+    bool validateConstructs(const IrNode &dict);
+    bool validateFunc(const IrNode &key, const IrNode &node);
+    bool validateRecord(const IrNode &key, const IrNode &node);
+    bool validateVars(const IrNode &dict);
+    bool validateCallGraph(const IrNode &dict);
+    bool validateSccs(const IrNode &list);
+    bool validateSharedRefs(const IrNode &dict);
+    bool validateInternalVars(const IrNode &list);
+    bool validateTypeLayouts(const IrNode &dict);
+    bool isType(const IrNode &node) const;
+    bool fail(const IrNode &node, const std::string &message);
+};
+
+} // namespace slang
+
+#endif // SLANG_IRFILE_H
@@ -0,0 +1,442 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// Links the SPAN IR of many translation units into one program.
+//===----------------------------------------------------------------------===//
+
+#include "SlangIrLinker.h"
+
+#include <functional>
+
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/xxhash.h"
+
+#include "SlangCallGraph.h"
+#include "SlangSummaryCache.h"
+
+using namespace slang;
+
+typedef std::function<std::string(const std::string &)> RenameFunc;
+
+// a function with instructions (in the older form, with basic blocks)
+static bool isDefinition(const IrFunc &func) {
+    if (func.instrSeq) {
+        return !func.instrSeq->children.empty();
+    }
+    const IrNode *basicBlocks = func.node->getKeywordArg("basicBlocks");
+    return basicBlocks && !basicBlocks->children.empty();
+}
+
+// a type or record that a complete one of the same name may replace,
+// e.g. `extern int a[];` or a record only declared
+static bool isIncomplete(llvm::StringRef text) {
+    return text.startswith("types.IncompleteArray(") || text.endswith("members=[])") ||
+           text.contains("members=[], ");
+}
+
+// prints the names with their renames (a local of a renamed function too,
+// "v:foo:x" -> "v:foo@1:x"); nullptr if there are none
+static RenameFunc getRenameFunc(const llvm::StringMap<std::string> &renames) {
+    if (renames.empty()) {
+        return nullptr;
+    }
+    return [&renames](const std::string &str) -> std::string {
+        auto found = renames.find(str);
+        if (found != renames.end()) {
+            return found->second;
+        }
+        size_t colon = str.find(':', 2);
+        if (str.compare(0, 2, "v:") == 0 && colon != std::string::npos) {
+            found = renames.find("f:" + str.substr(2, colon - 2));
+            if (found != renames.end()) {
+                return "v:" + found->second.substr(2) + str.substr(colon);
+            }
+        }
+        return str;
+    };
+}
+
+// the items of all the parts (IrFile) of a TU, in order
+template <typename T>
+static std::vector<std::reference_wrapper<const T>>
+collect(const std::vector<const IrFile *> &parts, const std::vector<T> &(IrFile::*get)() const) {
+    std::vector<std::reference_wrapper<const T>> all;
+    for (const IrFile *part : parts) {
+        all.insert(all.end(), (part->*get)().begin(), (part->*get)().end());
+    }
+    return all;
+}
+
+// BOUND START: IrLinker
+
+IrLinker::IrLinker() : offset{0}, sharedCount{0} {}
+
+bool IrLinker::open(const std::string &path, std::string &error) {
+    std::error_code ec;
+    os.reset(new llvm::raw_fd_ostream(path, ec, llvm::sys::fs::F_None));
+    if (ec) {
+        error = "cannot open '" + path + "': " + ec.message();
+        os.reset();
+        return false;
+    }
+
+    *os << SPAN_PROG_MAGIC;
+    llvm::support::endian::Writer(*os, llvm::support::little).write<uint32_t>(SPAN_PROG_VERSION);
+    offset = 8 + 4;
+    return true;
+}
+
+void IrLinker::writeItem(ProgItemKind kind, const std::string &name, llvm::StringRef text) {
+    ProgItem item;
+    item.kind = kind;
+    item.name = name;
+    item.offset = offset;
+    item.size = text.size();
+    items.push_back(item);
+
+    *os << text;
+    offset += text.size();
+}
+
+bool IrLinker::addFile(const std::string &path, std::string &error) {
+    IrFile irFile;
+    if (!irFile.readFile(path, error)) {
+        return false;
+    }
+    uint32_t unit = (uint32_t)units.size();
+    std::string unitName = irFile.getName().size() ? irFile.getName() : path;
+    std::string suffix = "@" + std::to_string(unit);
+
+    // the TU, and the constructs of its headers kept in the shared dir
+    std::vector<const IrFile *> parts{&irFile};
+    for (auto &sharedRef : irFile.getSharedRefs()) {
+        if (sharedIrDir.empty()) {
+            error = path + ": refers to shared constructs, and no shared dir is given";
+            return false;
+        }
+        std::unique_ptr<IrFile> &sharedFile = sharedFiles[sharedRef.second];
+        if (!sharedFile) {
+            std::unique_ptr<IrFile> entry(new IrFile());
+            std::string entryPath =
+                SummaryCache(sharedIrDir).getEntryPath(SHARED_IR_CACHE_ID, sharedRef.second);
+            if (!entry->readFile(entryPath, error)) {
+                error += " (" + sharedRef.first + " of " + path + ")";
+                sharedFiles.erase(sharedRef.second);
+                return false;
+            }
+            sharedFile = std::move(entry);
+        }
+        parts.push_back(sharedFile.get());
+    }
+    units.push_back(unitName);
+
+    // STEP 1: resolve the functions, globals and records of the TU;
+    // those conflicting with the ones linked are renamed.
+    llvm::StringMap<std::string> renames;
+    auto addConflict = [&](const std::string &name) {
+        renames[name] = name + suffix;
+        conflicts.push_back(name + " in " + unitName + " renamed to " + name + suffix);
+    };
+
+    llvm::StringMap<bool> funcNames; // of this TU (to tell the locals)
+    for (const IrFunc &func : collect(parts, &IrFile::getFuncs)) {
+        funcNames[func.name] = true;
+    }
+
+    // the locals ("v:main:x") go with their function
+    std::vector<const IrVar *> globalVars;
+    llvm::StringMap<std::vector<const IrVar *>> localVars;
+    for (const IrVar &var : collect(parts, &IrFile::getVars)) {
+        llvm::StringRef scope = llvm::StringRef(var.name).drop_front(2);
+        size_t colon = scope.find(':');
+        std::string funcName = "f:" + scope.substr(0, colon).str();
+        if (colon != llvm::StringRef::npos && funcNames.count(funcName)) {
+            localVars[funcName].push_back(&var);
+        } else {
+            globalVars.push_back(&var);
+        }
+    }
+
+    std::vector<std::pair<std::string, const IrVar *>> newGlobals;
+    for (const IrVar *var : globalVars) {
+        std::string text;
+        var->type->print(text);
+        auto found = globals.find(var->name);
+        if (var->internal) {
+            // (not a conflict: another variable in each TU)
+            renames[var->name] = var->name + suffix;
+            newGlobals.push_back(std::make_pair(var->name + suffix, var));
+            globals[var->name + suffix] = text;
+        } else if (found == globals.end() ||
+                   (isIncomplete(found->second) && !isIncomplete(text))) {
+            newGlobals.push_back(std::make_pair(var->name, var));
+            globals[var->name] = text;
+        } else if (found->second != text && !isIncomplete(text)) {
+            addConflict(var->name);
+            newGlobals.push_back(std::make_pair(var->name + suffix, var));
+            globals[var->name + suffix] = text;
+        }
+    }
+
+    // the same text of a function is the same definition, but for the
+    // internal globals it refers to (renamed by now)
+    llvm::StringMap<std::string> internalRenames = renames;
+    RenameFunc internalRename = getRenameFunc(internalRenames);
+    std::vector<const IrFunc *> definitions; // to write
+    for (const IrFunc &func : collect(parts, &IrFile::getFuncs)) {
+        if (!isDefinition(func)) {
+            continue;
+        }
+        std::string text;
+        func.node->print(text, internalRename);
+        uint64_t hash = llvm::xxHash64(text);
+
+        auto found = funcHashes.find(func.name);
+        if (found == funcHashes.end()) {
+            funcHashes[func.name] = hash;
+            definitions.push_back(&func);
+        } else if (found->second == hash) {
+            sharedCount += 1; // e.g. a static inline function of a header
+        } else {
+            addConflict(func.name);
+            funcHashes[func.name + suffix] = hash;
+            definitions.push_back(&func);
+        }
+    }
+
+    std::vector<std::pair<std::string, const IrRecord *>> newRecords;
+    for (const IrRecord &record : collect(parts, &IrFile::getRecords)) {
+        std::string text;
+        record.node->print(text);
+        auto found = records.find(record.name);
+        if (found == records.end() || (isIncomplete(found->second) && !isIncomplete(text))) {
+            newRecords.push_back(std::make_pair(record.name, &record));
+            records[record.name] = text;
+        } else if (found->second != text && !isIncomplete(text)) {
+            addConflict(record.name);
+            newRecords.push_back(std::make_pair(record.name + suffix, &record));
+            records[record.name + suffix] = text;
+        }
+    }
+
+    // STEP 2: write out the definitions, printed with the renames
+    RenameFunc rename = getRenameFunc(renames);
+    auto renamed = [&rename](const std::string &name) { return rename ? rename(name) : name; };
+
+    for (const IrFunc *func : definitions) {
+        std::string funcName = renamed(func->name);
+        std::string text;
+        func->node->print(text, rename);
+        writeItem(ProgFunc, funcName, text);
+
+        auto locals = localVars.find(func->name);
+        if (locals != localVars.end()) {
+            text = "{";
+            for (const IrVar *var : locals->second) {
+                text += "\"" + renamed(var->name) + "\": ";
+                var->type->print(text, rename);
+                text += ", ";
+            }
+            text += "}";
+            writeItem(ProgLocals, funcName, text);
+        }
+    }
+
+    // STEP 3: keep the rest, renamed, till finish()
+    // (their types refer to the renamed records)
+    for (auto &newGlobal : newGlobals) {
+        std::string text;
+        newGlobal.second->type->print(text, rename);
+        globals[newGlobal.first] = text;
+    }
+    for (auto &newRecord : newRecords) {
+        std::string text;
+        newRecord.second->node->print(text, rename);
+        records[newRecord.first] = text;
+    }
+    for (const IrFunc &func : collect(parts, &IrFile::getFuncs)) {
+        if (!isDefinition(func) && !declarations.count(func.name)) {
+            std::string text;
+            func.node->print(text, rename);
+            declarations[func.name] = text;
+        }
+    }
+
+    for (const IrTypeLayout &typeLayout : collect(parts, &IrFile::getTypeLayouts)) {
+        std::string key, text;
+        typeLayout.key->print(key, rename);
+        typeLayout.node->print(text);
+        typeLayouts.insert(std::make_pair(key, text));
+    }
+
+    const IrNode *calls = irFile.getRoot().getKeywordArg("callGraph");
+    for (size_t i = 0; calls && i + 1 < calls->children.size(); i += 2) {
+        std::set<std::string> &callees = callGraph[renamed(calls->children[i].text.str())];
+        for (const IrNode &callee : calls->children[i + 1].children) {
+            callees.insert(renamed(callee.text.str()));
+        }
+    }
+
+    if (os->has_error()) {
+        error = "error writing the program";
+        return false;
+    }
+    return true;
+} // addFile()
+
+bool IrLinker::finish(std::string &error) {
+    std::string text = "[";
+    for (const std::string &unit : units) {
+        text += "\"" + unit + "\", ";
+    }
+    text += "]";
+    writeItem(ProgUnits, "units", text);
+
+    for (auto &global : globals) {
+        writeItem(ProgGlobal, global.first, global.second);
+    }
+    for (auto &record : records) {
+        writeItem(ProgRecord, record.first, record.second);
+    }
+    text = "{";
+    for (auto &typeLayout : typeLayouts) {
+        text += typeLayout.first + ": " + typeLayout.second + ", ";
+    }
+    text += "}";
+    writeItem(ProgTypeLayouts, "typeLayouts", text);
+    // the functions never defined (e.g. of the C library)
+    for (auto &declaration : declarations) {
+        if (!funcHashes.count(declaration.first)) {
+            writeItem(ProgFunc, declaration.first, declaration.second);
+        }
+    }
+
+    CallGraph programCallGraph;
+    text = "{";
+    for (auto &calls : callGraph) {
+        programCallGraph.addFunction(calls.first, "");
+        text += "\"" + calls.first + "\": [";
+        for (const std::string &callee : calls.second) {
+            programCallGraph.addCall(calls.first, callee);
+            text += "\"" + callee + "\", ";
+        }
+        text += "], ";
+    }
+    text += "}";
+    writeItem(ProgCallGraph, "callGraph", text);
+
+    programCallGraph.computeSccs();
+    text = "[";
+    for (const CallGraphScc &scc : programCallGraph.getSccs()) {
+        text += "(" + std::to_string(scc.level) + ", [";
+        for (const std::string &funcName : scc.funcNames) {
+            text += "\"" + funcName + "\", ";
+        }
+        text += "]), ";
+    }
+    text += "]";
+    writeItem(ProgSccs, "callGraphSccs", text);
+
+    // the index, at the end
+    llvm::support::endian::Writer writer(*os, llvm::support::little);
+    writer.write<uint32_t>((uint32_t)items.size());
+    for (const ProgItem &item : items) {
+        writer.write<uint8_t>((uint8_t)item.kind);
+        writer.write<uint32_t>((uint32_t)item.name.size());
+        *os << item.name;
+        writer.write<uint64_t>(item.offset);
+        writer.write<uint64_t>(item.size);
+    }
+    writer.write<uint64_t>(offset);
+    *os << SPAN_PROG_INDEX_MAGIC;
+
+    os->close();
+    if (os->has_error()) {
+        os->clear_error();
+        error = "error writing the program";
+        return false;
+    }
+    return true;
+} // finish()
+
+// BOUND END  : IrLinker
+
+// BOUND START: ProgramIrReader
+
+bool ProgramIrReader::readFile(const std::string &path, std::string &error) {
+    auto mapped = llvm::MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                                              /*RequiresNullTerminator=*/false);
+    if (!mapped) {
+        error = path + ": cannot read: " + mapped.getError().message();
+        return false;
+    }
+    buffer = std::move(*mapped);
+    items.clear();
+    itemIndex.clear();
+
+    const char *begin = buffer->getBufferStart();
+    const char *end = buffer->getBufferEnd();
+    size_t size = end - begin;
+    if (size < 12 + 8 + 8 || llvm::StringRef(begin, 8) != SPAN_PROG_MAGIC ||
+        llvm::StringRef(end - 8, 8) != SPAN_PROG_INDEX_MAGIC) {
+        error = path + ": not a .spanprog file";
+        return false;
+    }
+    if (llvm::support::endian::read32le(begin + 8) != SPAN_PROG_VERSION) {
+        error = path + ": unknown .spanprog version";
+        return false;
+    }
+
+    uint64_t indexOffset = llvm::support::endian::read64le(end - 16);
+    const char *curr = begin + indexOffset;
+    const char *indexEnd = end - 16;
+    auto fail = [&]() {
+        error = path + ": bad index";
+        return false;
+    };
+    if (indexOffset + 4 > size - 16) {
+        return fail();
+    }
+    uint32_t count = llvm::support::endian::read32le(curr);
+    curr += 4;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (indexEnd - curr < 5) {
+            return fail();
+        }
+        ProgItem item;
+        item.kind = (ProgItemKind)(uint8_t)curr[0];
+        uint32_t nameSize = llvm::support::endian::read32le(curr + 1);
+        curr += 5;
+        if ((uint64_t)(indexEnd - curr) < (uint64_t)nameSize + 16) {
+            return fail();
+        }
+        item.name.assign(curr, nameSize);
+        curr += nameSize;
+        item.offset = llvm::support::endian::read64le(curr);
+        item.size = llvm::support::endian::read64le(curr + 8);
+        curr += 16;
+        if (item.offset > indexOffset || item.size > indexOffset - item.offset) {
+            return fail();
+        }
+        itemIndex[std::make_pair((int)item.kind, item.name)] = items.size();
+        items.push_back(std::move(item));
+    }
+    return true;
+} // readFile()
+
+const ProgItem *ProgramIrReader::findItem(ProgItemKind kind, llvm::StringRef name) const {
+    auto found = itemIndex.find(std::make_pair((int)kind, name.str()));
+    return found == itemIndex.end() ? nullptr : &items[found->second];
+}
+
+llvm::StringRef ProgramIrReader::getText(const ProgItem &item) const {
+    return llvm::StringRef(buffer->getBufferStart() + item.offset, item.size);
+}
+
+// BOUND END  : ProgramIrReader
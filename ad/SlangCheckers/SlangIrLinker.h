@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// Links the SPAN IR of many translation units into one program.
+//
+// Each TU (a .spanir file, read with IrFile) is resolved against the TUs
+// linked before it,
+//
+//     functions  a definition (with instructions) satisfies the declarations
+//                of its name in all the TUs; the same definition again (e.g.
+//                of a static inline function of a header) is kept once
+//     globals    the variables "v:x" are unified by name (the locals,
+//                "v:main:x", go with their function); those of internal
+//                linkage (the internalVars of the TU, e.g. static) are kept
+//                per TU, renamed to v:x@N (N: the index of the TU)
+//     records    the same record again is kept once
+//     layouts    the typeLayouts of the records and types are unified by name
+//                (the first one is kept: they are the same for a target)
+//
+// The constructs of the headers that the TU refers to (its sharedConstructs,
+// see IrFile::getSharedRefs()) are read from the shared dir, and linked as
+// part of the TU: the same function of a header is thus read and kept once.
+// An entry is parsed at its first reference, and kept for the other TUs.
+//
+// A different function, global or record with a name already linked (e.g.
+// static functions of the same name in two files) is kept too, renamed to
+// NAME@N (N: the index of its TU), in all of its TU; each is reported as
+// a conflict.
+//
+// The functions (and their locals) are written out as soon as their TU is
+// read: only their names and offsets are kept, with the globals, records,
+// declarations and call graph of the program. So the memory needed is that
+// of the largest TU (and of the shared entries), not of the program.
+//
+// The program is written to a binary file (.spanprog), all integers little
+// endian,
+//
+//     "SPANPROG"  u32 version
+//     the items, each the SPAN IR text of a value (see ProgItemKind)
+//     the index:  u32 count, then for each item,
+//                 u8 kind, u32 size of the name, the name, u64 offset, u64 size
+//     u64 offset of the index, "SPANIDX1"
+//
+// ProgramIrReader reads it back (memory mapped), as does
+// span.ir.irload.SpanProgFile in python.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_IRLINKER_H
+#define SLANG_IRLINKER_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "SlangIrFile.h"
+
+namespace slang {
+
+#define SPAN_PROG_MAGIC "SPANPROG"
+#define SPAN_PROG_INDEX_MAGIC "SPANIDX1"
+#define SPAN_PROG_VERSION 1
+
+/** The items of a .spanprog file, and their names. */
+enum ProgItemKind {
+    ProgFunc = 0,        // "f:main": a constructs.Func(...) (a declaration if never defined)
+    ProgLocals = 1,      // "f:main": the dict of its local variables, {"v:main:x": TYPE}
+    ProgGlobal = 2,      // "v:x": its type
+    ProgRecord = 3,      // "s:node": a types.Struct(...) or types.Union(...)
+    ProgCallGraph = 4,   // "callGraph": {"f:main": ["f:foo"]}
+    ProgSccs = 5,        // "callGraphSccs": [(0, ["f:foo"])], callees first
+    ProgUnits = 6,       // "units": the list of the names of the linked TUs
+    ProgTypeLayouts = 7, // "typeLayouts": {"s:node": (SIZE, ALIGN, MEMBERS), TYPE: (SIZE, ALIGN)}
+};
+
+class ProgItem {
+  public:
+    ProgItemKind kind;
+    std::string name;
+    uint64_t offset, size;
+};
+
+class IrLinker {
+  public:
+    IrLinker();
+
+    /** The shared dir of the TUs (the checker option SharedIrDir). */
+    void setSharedIrDir(const std::string &dir) { sharedIrDir = dir; }
+
+    /** Creates the program file. @return false on an error. */
+    bool open(const std::string &path, std::string &error);
+
+    /** Links the TU (a .spanir file): its functions are written out.
+     *  @return false if it cannot be read (it is then skipped).
+     */
+    bool addFile(const std::string &path, std::string &error);
+
+    /** Writes the rest (globals, records, declarations, call graph, the
+     *  index) and closes the file. @return false on an I/O error.
+     */
+    bool finish(std::string &error);
+
+    /** The conflicts (renamed items), e.g. "f:foo in b.c renamed to f:foo@1". */
+    const std::vector<std::string> &getConflicts() const { return conflicts; }
+
+    uint32_t getUnitCount() const { return (uint32_t)units.size(); }
+    uint32_t getFuncCount() const { return (uint32_t)funcHashes.size(); }
+    uint32_t getSharedCount() const { return sharedCount; }
+
+  private:
+    std::unique_ptr<llvm::raw_fd_ostream> os;
+    uint64_t offset;
+    std::vector<ProgItem> items;
+
+    std::string sharedIrDir;
+    // the entries of the shared dir read so far, by hash
+    llvm::StringMap<std::unique_ptr<IrFile>> sharedFiles;
+    std::vector<std::string> units;
+    // the hash of the text of each defined function
+    llvm::StringMap<uint64_t> funcHashes;
+    // the first declaration of each function not defined yet
+    std::map<std::string, std::string> declarations;
+    // name -> text (of the type, of the record)
+    std::map<std::string, std::string> globals;
+    std::map<std::string, std::string> records;
+    // the printed key (record name or type) -> its layout
+    std::map<std::string, std::string> typeLayouts;
+    std::map<std::string, std::set<std::string>> callGraph;
+    std::vector<std::string> conflicts;
+    // definitions seen again (same text), and not written again
+    uint32_t sharedCount;
+
+    void writeItem(ProgItemKind kind, const std::string &name, llvm::StringRef text);
+};
+
+/** Reads a .spanprog file (see SlangIrLinker.h). */
+class ProgramIrReader {
+  public:
+    /** Reads (memory maps) the file, and its index.
+     *  @return false on an error.
+     */
+    bool readFile(const std::string &path, std::string &error);
+
+    const std::vector<ProgItem> &getItems() const { return items; }
+
+    /** @return the item of the kind and name, or nullptr. */
+    const ProgItem *findItem(ProgItemKind kind, llvm::StringRef name) const;
+
+    /** @return the SPAN IR text of the item (e.g. to parse with IrParser). */
+    llvm::StringRef getText(const ProgItem &item) const;
+
+  private:
+    std::unique_ptr<llvm::MemoryBuffer> buffer;
+    std::vector<ProgItem> items;
+    std::map<std::pair<int, std::string>, size_t> itemIndex;
+};
+
+} // namespace slang
+
+#endif // SLANG_IRLINKER_H
@@ -0,0 +1,414 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// Parses the SPAN IR text (as generated by the SLANG checkers) into a tree.
+//===----------------------------------------------------------------------===//
+
+#include "SlangIrParser.h"
+
+#include <cstring>
+#include <memory>
+#include <sstream>
+
+using namespace slang;
+
+static bool isNameStart(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static bool isNameChar(char c) { return isNameStart(c) || (c >= '0' && c <= '9') || c == '.'; }
+
+// BOUND START: IrNode_functions
+
+IrNode::IrNode() : kind{IrName}, offset{0} {}
+
+bool IrNode::isCall(const char *name) const { return kind == IrCall && text == name; }
+
+bool IrNode::isName(const char *name) const { return kind == IrName && text == name; }
+
+uint64_t IrNode::getUInt() const {
+    uint64_t value = 0;
+    return kind != IrNum || text.getAsInteger(10, value) ? 0 : value;
+}
+
+const IrNode *IrNode::getKeywordArg(llvm::StringRef kw) const {
+    for (const IrNode &child : children) {
+        if (child.keyword == kw) {
+            return &child;
+        }
+    }
+    return nullptr;
+}
+
+void IrNode::collectVarNames(std::vector<std::string> &names) const {
+    if (isCall("expr.VarE") && children.size() && children[0].kind == IrStr) {
+        names.push_back(children[0].text.str());
+        return;
+    }
+    for (const IrNode &child : children) {
+        child.collectVarNames(names);
+    }
+}
+
+bool IrNode::getLoc(uint32_t &line, uint32_t &col) const {
+    if (kind != IrCall || children.empty()) {
+        return false;
+    }
+    const IrNode &last = children[children.size() - 1];
+    if (!last.isCall("Loc") || last.children.size() != 2) {
+        return false;
+    }
+    line = (uint32_t)last.children[0].getUInt();
+    col = (uint32_t)last.children[1].getUInt();
+    return true;
+}
+
+static void printString(llvm::StringRef str, std::string &out) {
+    out += '"';
+    for (char c : str) {
+        switch (c) {
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        case '\\': out += "\\\\"; break;
+        case '"': out += "\\\""; break;
+        default: out += c; break;
+        }
+    }
+    out += '"';
+}
+
+void IrNode::print(std::string &out,
+                   const std::function<std::string(const std::string &)> &renameStr) const {
+    if (!keyword.empty()) {
+        out.append(keyword.data(), keyword.size());
+        out += '=';
+    }
+
+    const char *open = "", *close = "";
+    switch (kind) {
+    case IrStr:
+        if (renameStr) {
+            printString(renameStr(text.str()), out);
+        } else {
+            printString(text, out);
+        }
+        return;
+    case IrNum:
+    case IrName: out.append(text.data(), text.size()); return;
+    case IrCall:
+        out.append(text.data(), text.size());
+        open = "(", close = ")";
+        break;
+    case IrList: open = "[", close = "]"; break;
+    case IrTuple: open = "(", close = ")"; break;
+    case IrDict:
+    case IrSet: open = "{", close = "}"; break;
+    }
+
+    out += open;
+    for (size_t i = 0; i < children.size(); ++i) {
+        if (i > 0) {
+            out += (kind == IrDict && i % 2) ? ": " : ", ";
+        }
+        children[i].print(out, renameStr);
+    }
+    if (kind == IrTuple && children.size() == 1) {
+        out += ','; // (x,) is a tuple, (x) is not
+    }
+    out += close;
+}
+
+// BOUND END  : IrNode_functions
+
+// BOUND START: IrParser_functions
+
+bool IrParser::parse(llvm::StringRef text, IrNode &root) {
+    begin = curr = text.data();
+    end = text.data() + text.size();
+    error = "";
+    pending.clear(); // (left over by a failed parse)
+
+    root = IrNode();
+    if (!parseValue(root)) {
+        return false;
+    }
+
+    skipSpace();
+    if (curr != end) {
+        return fail("unexpected text after the value");
+    }
+    return true;
+}
+
+void IrParser::reset() {
+    arena.Reset();
+    pending.clear();
+}
+
+std::string IrParser::getError() const { return error; }
+
+inline void IrParser::skipSpace() {
+    while (curr < end) {
+        char c = *curr;
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            ++curr;
+        } else if (c == '#') {
+            // comment till the end of line
+            const char *newline = (const char *)std::memchr(curr, '\n', end - curr);
+            curr = newline ? newline : end;
+        } else {
+            break;
+        }
+    }
+}
+
+void IrParser::setPosition(IrNode &node) const { node.offset = (uint32_t)(curr - begin); }
+
+void IrParser::getLineCol(uint32_t offset, uint32_t &line, uint32_t &col) const {
+    const char *lineStart = begin;
+    line = 1;
+    for (const char *p = begin; p < begin + offset && p < end; ++p) {
+        if (*p == '\n') {
+            line += 1;
+            lineStart = p + 1;
+        }
+    }
+    col = (uint32_t)(begin + offset - lineStart) + 1;
+}
+
+bool IrParser::fail(const std::string &msg) {
+    uint32_t line, col;
+    getLineCol((uint32_t)(curr - begin), line, col);
+    std::stringstream ss;
+    ss << line << ":" << col << ": " << msg;
+    error = ss.str();
+    return false;
+}
+
+bool IrParser::parseValue(IrNode &node) {
+    skipSpace();
+    if (curr >= end) {
+        return fail("unexpected end of input");
+    }
+
+    setPosition(node);
+    char c = *curr;
+    if (c == '"' || c == '\'') {
+        return parseString(node);
+    } else if (c == '-' || c == '+' || (c >= '0' && c <= '9')) {
+        return parseNumber(node);
+    } else if (isNameStart(c)) {
+        return parseNameOrCall(node);
+    } else if (c == '[') {
+        node.kind = IrList;
+        ++curr;
+        return parseSequence(node, ']');
+    } else if (c == '(') {
+        node.kind = IrTuple;
+        ++curr;
+        return parseSequence(node, ')');
+    } else if (c == '{') {
+        node.kind = IrDict;
+        ++curr;
+        return parseSequence(node, '}');
+    }
+
+    return fail(std::string("unexpected character '") + c + "'");
+}
+
+// parses the comma separated elements of a call, list, tuple or dict
+bool IrParser::parseSequence(IrNode &node, char close) {
+    size_t first = pending.size(); // the children of node are pending[first...]
+    while (true) {
+        skipSpace();
+        if (curr < end && *curr == close) {
+            ++curr;
+            size_t count = pending.size() - first;
+            if (count) {
+                IrNode *children = arena.Allocate<IrNode>(count);
+                std::uninitialized_copy(pending.begin() + first, pending.end(), children);
+                node.children = llvm::MutableArrayRef<IrNode>(children, count);
+                pending.resize(first);
+            }
+            return true;
+        }
+
+        IrNode child;
+        bool parsed;
+        if (node.kind == IrCall && curr < end && isNameStart(*curr)) {
+            // a keyword argument, e.g. `name = "f:main"`, or a name or a call
+            // (the name is scanned only once)
+            setPosition(child);
+            scanName(child);
+            if (curr + 1 < end && *curr == '=' && *(curr + 1) != '=') {
+                child.keyword = child.text;
+                child.text = llvm::StringRef();
+                ++curr;
+                parsed = parseValue(child);
+            } else {
+                parsed = parseCallArgs(child);
+            }
+        } else {
+            parsed = parseValue(child);
+        }
+        if (!parsed) {
+            return false;
+        }
+        pending.push_back(child);
+
+        if (node.kind == IrDict && pending.size() - first == 1) {
+            skipSpace();
+            if (curr < end && *curr != ':') {
+                node.kind = IrSet; // the first item has no value
+            }
+        }
+        if (node.kind == IrDict) {
+            skipSpace();
+            if (curr >= end || *curr != ':') {
+                return fail("expected ':' in dict");
+            }
+            ++curr;
+            IrNode value;
+            if (!parseValue(value)) {
+                return false;
+            }
+            pending.push_back(value);
+        }
+
+        skipSpace();
+        if (curr >= end) {
+            return fail(std::string("expected '") + close + "'");
+        }
+        if (*curr == ',') {
+            ++curr;
+        } else if (*curr != close) {
+            return fail(std::string("expected ',' or '") + close + "'");
+        }
+    }
+}
+
+bool IrParser::parseString(IrNode &node) {
+    node.kind = IrStr;
+
+    char quote = *curr;
+    if (end - curr >= 6 && curr[1] == quote && curr[2] == quote) {
+        // a triple quoted string (used for string literals)
+        curr += 3;
+        const char *start = curr;
+        while (end - curr >= 3) {
+            const char *found = (const char *)std::memchr(curr, quote, end - curr - 2);
+            if (!found) {
+                break;
+            }
+            curr = found;
+            if (curr[1] == quote && curr[2] == quote) {
+                node.text = llvm::StringRef(start, curr - start);
+                curr += 3;
+                return true;
+            }
+            ++curr;
+        }
+        curr = end;
+        return fail("unterminated triple quoted string");
+    }
+
+    ++curr; // skip the opening quote
+
+    // the usual string has no escapes: it is a slice of the text
+    const char *close = (const char *)std::memchr(curr, quote, end - curr);
+    if (close && !std::memchr(curr, '\\', close - curr) && !std::memchr(curr, '\n', close - curr)) {
+        node.text = llvm::StringRef(curr, close - curr);
+        curr = close + 1;
+        return true;
+    }
+
+    std::string text;
+    while (curr < end && *curr != quote) {
+        char c = *curr;
+        if (c == '\n') {
+            return fail("newline in string");
+        }
+        if (c == '\\' && curr + 1 < end) {
+            ++curr;
+            switch (*curr) {
+            case 'n': text += '\n'; break;
+            case 't': text += '\t'; break;
+            case '\\':
+            case '"':
+            case '\'': text += *curr; break;
+            default:
+                text += '\\';
+                text += *curr;
+                break;
+            }
+        } else {
+            text += c;
+        }
+        ++curr;
+    }
+
+    if (curr >= end) {
+        return fail("unterminated string");
+    }
+    ++curr; // skip the closing quote
+    node.text = saver.save(text);
+    return true;
+}
+
+bool IrParser::parseNumber(IrNode &node) {
+    node.kind = IrNum;
+
+    const char *start = curr;
+    if (*curr == '-' || *curr == '+') {
+        ++curr;
+    }
+    const char *digits = curr;
+    while (curr < end) {
+        char c = *curr;
+        if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == 'x' || c == 'X' ||
+            (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')) {
+            ++curr;
+        } else if ((c == '-' || c == '+') && (curr[-1] == 'e' || curr[-1] == 'E')) {
+            ++curr;
+        } else {
+            break;
+        }
+    }
+
+    if (curr == digits) {
+        return fail("expected a number");
+    }
+    node.text = llvm::StringRef(start, curr - start);
+    return true;
+}
+
+bool IrParser::parseNameOrCall(IrNode &node) {
+    scanName(node);
+    return parseCallArgs(node);
+}
+
+void IrParser::scanName(IrNode &node) {
+    const char *start = curr;
+    while (curr < end && isNameChar(*curr)) {
+        ++curr;
+    }
+    node.text = llvm::StringRef(start, curr - start);
+    skipSpace();
+}
+
+bool IrParser::parseCallArgs(IrNode &node) {
+    if (curr < end && *curr == '(') {
+        node.kind = IrCall;
+        ++curr;
+        return parseSequence(node, ')');
+    }
+
+    node.kind = IrName;
+    return true;
+}
+
+// BOUND END  : IrParser_functions
@@ -0,0 +1,150 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// Parses the SPAN IR text (as generated by the SLANG checkers) into a tree.
+//
+// SPAN IR is a restricted python expression: calls with positional and
+// keyword arguments, string/number literals, dotted names, lists, tuples,
+// dicts and sets. This parser understands exactly that subset, so that the
+// native (C++) analyses can work on the lowered IR without python.
+//
+// The tree is zero-copy: the text of a node is a slice of the parsed text
+// (which the caller keeps while the tree is used), and the nodes are
+// allocated in an arena of the parser, freed all at once (see reset()).
+// On a 53 MB synthetic file (16000 functions, -O2, one core) the parse
+// alone runs at 200-290 MB/s (it was 90 MB/s when each node owned its
+// std::string and std::vector); a first load by IrFile, page faults of the
+// arena included, takes 0.5 s and 499 MB of peak RSS (was 1.3-1.8 s and
+// 1352 MB). The nodes (56 bytes each, one per ~8 bytes of text) are now
+// most of the memory.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_IRPARSER_H
+#define SLANG_IRPARSER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
+
+namespace slang {
+
+enum IrNodeKind {
+    IrCall = 0,  // e.g. expr.VarE("v:main:x", Loc(2,3))
+    IrStr = 1,   // e.g. "v:main:x"
+    IrNum = 2,   // e.g. 10, -1.5
+    IrName = 3,  // e.g. types.Int32, op.BO_ADD, None, True
+    IrList = 4,  // e.g. [1, 2]
+    IrTuple = 5, // e.g. (1, 2)
+    IrDict = 6,  // e.g. {"v:x": types.Int32}, children are key, value, key, value...
+    IrSet = 7,   // e.g. {(1, 0, types.UnCondEdge)}
+};
+
+/** A node of the tree: a plain value, copied shallowly (a copy shares
+ *  the children), valid while the parser that made it is.
+ */
+class IrNode {
+  public:
+    IrNodeKind kind;
+    uint32_t offset; // byte offset of the node in the parsed text
+    // name of the callee for IrCall, the (unquoted) value of IrStr,
+    // the spelling of IrNum and IrName: in the parsed text (in the arena of
+    // the parser, for a string with escapes).
+    llvm::StringRef text;
+    // keyword of the argument, if this node is a keyword argument of a call
+    llvm::StringRef keyword;
+    // in the arena of the parser
+    llvm::MutableArrayRef<IrNode> children;
+
+    IrNode();
+
+    bool isCall(const char *name) const;
+    bool isName(const char *name) const;
+
+    /** @return the value of a decimal IrNum, 0 if it is not one. */
+    uint64_t getUInt() const;
+
+    /** Get the keyword argument of this call node.
+     *
+     * @return nullptr if not present.
+     */
+    const IrNode *getKeywordArg(llvm::StringRef kw) const;
+
+    /** Collects names of all expr.VarE nodes in this tree (pre-order). */
+    void collectVarNames(std::vector<std::string> &names) const;
+
+    /** Reads the trailing Loc(line,col) argument of a call node.
+     *
+     * @return false if there is no such argument.
+     */
+    bool getLoc(uint32_t &line, uint32_t &col) const;
+
+    /** Appends the node as SPAN IR text, on one line (comments and spacing
+     *  of the parsed text are not kept; the text parses to the same tree).
+     *
+     * @param renameStr if given, maps the value of each string node
+     *        (e.g. "f:main") to the one printed.
+     */
+    void print(std::string &out,
+               const std::function<std::string(const std::string &)> &renameStr = nullptr) const;
+};
+
+class IrParser {
+  public:
+    IrParser() : saver{arena} {}
+
+    /** Parse the given text as a single SPAN IR value.
+     *
+     *  Comments and surrounding white space are ignored. The tree points
+     *  into the text, and into the arena of this parser: it is valid until
+     *  reset() (the trees of the earlier parses stay valid too).
+     *
+     * @return false on a syntax error; see getError().
+     */
+    bool parse(llvm::StringRef text, IrNode &root);
+
+    /** Frees the trees parsed so far. */
+    void reset();
+
+    /** @return the error message with line:col of the last failed parse. */
+    std::string getError() const;
+
+    /** Converts a byte offset in the last parsed text to line and column. */
+    void getLineCol(uint32_t offset, uint32_t &line, uint32_t &col) const;
+
+  private:
+    const char *begin;
+    const char *curr;
+    const char *end;
+    std::string error;
+
+    llvm::BumpPtrAllocator arena; // the children, and the strings with escapes
+    llvm::StringSaver saver;
+    // the children parsed of the sequences being parsed (the innermost last),
+    // moved to the arena once a sequence is complete (and its size known)
+    std::vector<IrNode> pending;
+
+    void skipSpace();
+    bool parseValue(IrNode &node);
+    bool parseSequence(IrNode &node, char close);
+    bool parseString(IrNode &node);
+    bool parseNumber(IrNode &node);
+    bool parseNameOrCall(IrNode &node);
+    void scanName(IrNode &node); // sets text to the name, skips the space after it
+    bool parseCallArgs(IrNode &node); // the args of the call, if any, of the name scanned
+    void setPosition(IrNode &node) const;
+    bool fail(const std::string &msg);
+};
+
+} // namespace slang
+
+#endif // SLANG_IRPARSER_H
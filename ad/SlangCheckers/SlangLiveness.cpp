@@ -0,0 +1,238 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// Native live variables analysis over the lowered SPAN IR of a function.
+//===----------------------------------------------------------------------===//
+
+#include "SlangLiveness.h"
+
+using namespace slang;
+
+// the variables are numbered, and sets of them are bit vectors of 64 bit words
+static void setBit(std::vector<uint64_t> &bits, uint32_t id) { bits[id / 64] |= 1ULL << (id % 64); }
+
+static bool getBit(const std::vector<uint64_t> &bits, uint32_t id) {
+    return (bits[id / 64] >> (id % 64)) & 1ULL;
+}
+
+bool LivenessAnalysis::analyze(const std::string &funcName,
+                               const std::vector<llvm::StringRef> &instrSeq) {
+    this->funcName = funcName;
+    varNames.clear();
+    varIndex.clear();
+    addressTaken.clear();
+    instrs.clear();
+    defs.clear();
+    uses.clear();
+    succs.clear();
+    liveOut.clear();
+
+    // STEP 1: parse the instructions.
+    parser.reset();
+    instrs.resize(instrSeq.size());
+    for (size_t i = 0; i < instrSeq.size(); ++i) {
+        if (!parser.parse(instrSeq[i], instrs[i]) || instrs[i].kind != IrCall) {
+            return false;
+        }
+    }
+
+    // STEP 2: record the defs and uses of each instruction.
+    defs.assign(instrs.size(), -1);
+    uses.resize(instrs.size());
+    for (size_t i = 0; i < instrs.size(); ++i) {
+        const IrNode &instr = instrs[i];
+        markAddressTaken(instr);
+
+        if (instr.isCall("instr.AssignI") && instr.children.size() >= 2) {
+            const IrNode &lhs = instr.children[0];
+            if (lhs.isCall("expr.VarE") && lhs.children.size() && lhs.children[0].kind == IrStr) {
+                defs[i] = getVarId(lhs.children[0].text.str());
+            } else {
+                addUses(lhs, uses[i]); // e.g. *p = ..., a[i] = ...
+            }
+            addUses(instr.children[1], uses[i]);
+        } else if (!instr.isCall("instr.LabelI") && !instr.isCall("instr.GotoI")) {
+            addUses(instr, uses[i]); // CondI, ReturnI, CallI ...
+        }
+    }
+
+    // STEP 3: connect the instructions and solve.
+    if (!computeSuccessors()) {
+        return false;
+    }
+    solve();
+    return true;
+} // analyze()
+
+uint32_t LivenessAnalysis::getVarId(const std::string &varName) {
+    auto it = varIndex.find(varName);
+    if (it != varIndex.end()) {
+        return it->second;
+    }
+    uint32_t id = (uint32_t)varNames.size();
+    varIndex[varName] = id;
+    varNames.push_back(varName);
+    addressTaken.push_back(false);
+    return id;
+}
+
+void LivenessAnalysis::addUses(const IrNode &node, std::vector<uint32_t> &useVec) {
+    std::vector<std::string> names;
+    node.collectVarNames(names);
+    for (const std::string &name : names) {
+        useVec.push_back(getVarId(name));
+    }
+}
+
+// a variable whose address is taken may be read through a pointer anywhere
+void LivenessAnalysis::markAddressTaken(const IrNode &node) {
+    if (node.isCall("expr.AddrOfE")) {
+        std::vector<std::string> names;
+        node.collectVarNames(names);
+        for (const std::string &name : names) {
+            addressTaken[getVarId(name)] = true;
+        }
+        return;
+    }
+    for (const IrNode &child : node.children) {
+        markAddressTaken(child);
+    }
+}
+
+bool LivenessAnalysis::computeSuccessors() {
+    std::unordered_map<std::string, size_t> labels;
+    for (size_t i = 0; i < instrs.size(); ++i) {
+        if (instrs[i].isCall("instr.LabelI") && instrs[i].children.size()) {
+            labels[instrs[i].children[0].text.str()] = i;
+        }
+    }
+
+    succs.resize(instrs.size());
+    for (size_t i = 0; i < instrs.size(); ++i) {
+        const IrNode &instr = instrs[i];
+        std::vector<std::string> targets;
+
+        if (instr.isCall("instr.GotoI") && instr.children.size()) {
+            targets.push_back(instr.children[0].text.str());
+        } else if (instr.isCall("instr.CondI") && instr.children.size() >= 3) {
+            targets.push_back(instr.children[1].text.str());
+            targets.push_back(instr.children[2].text.str());
+        } else if (instr.isCall("instr.ReturnI")) {
+            // no successors
+        } else if (i + 1 < instrs.size()) {
+            succs[i].push_back((uint32_t)(i + 1));
+        }
+
+        for (const std::string &target : targets) {
+            auto it = labels.find(target);
+            if (it == labels.end()) {
+                return false; // jump to an unknown label: give up
+            }
+            succs[i].push_back((uint32_t)it->second);
+        }
+    }
+    return true;
+} // computeSuccessors()
+
+// standard backward may analysis, iterated to a fixed point
+void LivenessAnalysis::solve() {
+    size_t words = (varNames.size() + 63) / 64;
+    std::vector<std::vector<uint64_t>> liveIn(instrs.size(), std::vector<uint64_t>(words, 0));
+    liveOut.assign(instrs.size(), std::vector<uint64_t>(words, 0));
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = instrs.size(); i-- > 0;) {
+            std::vector<uint64_t> &out = liveOut[i];
+            for (uint32_t succ : succs[i]) {
+                for (size_t w = 0; w < words; ++w) {
+                    out[w] |= liveIn[succ][w];
+                }
+            }
+
+            std::vector<uint64_t> in = out;
+            if (defs[i] >= 0) {
+                in[defs[i] / 64] &= ~(1ULL << (defs[i] % 64));
+            }
+            for (uint32_t use : uses[i]) {
+                setBit(in, use);
+            }
+
+            if (in != liveIn[i]) {
+                liveIn[i] = in;
+                changed = true;
+            }
+        }
+    }
+} // solve()
+
+bool LivenessAnalysis::isLiveOut(size_t instrIndex, const std::string &varName) const {
+    auto it = varIndex.find(varName);
+    if (it == varIndex.end() || instrIndex >= liveOut.size()) {
+        return false;
+    }
+    return getBit(liveOut[instrIndex], it->second);
+}
+
+bool LivenessAnalysis::isLocalVar(const std::string &varName) const {
+    std::string prefix = "v:" + funcName + ":";
+    return varName.compare(0, prefix.size(), prefix) == 0;
+}
+
+std::vector<DeadStore> LivenessAnalysis::getDeadStores() const {
+    std::vector<DeadStore> deadStores;
+
+    for (size_t i = 0; i < instrs.size(); ++i) {
+        if (defs[i] < 0) {
+            continue;
+        }
+        const std::string &varName = varNames[defs[i]];
+        if (!isLocalVar(varName) || isTmpVarName(varName) || addressTaken[defs[i]]) {
+            continue;
+        }
+        if (getBit(liveOut[i], defs[i])) {
+            continue;
+        }
+
+        DeadStore deadStore;
+        deadStore.varName = varName;
+        deadStore.line = deadStore.col = 0;
+        instrs[i].getLoc(deadStore.line, deadStore.col);
+        deadStores.push_back(deadStore);
+    }
+
+    return deadStores;
+} // getDeadStores()
+
+std::string LivenessAnalysis::getSourceVarName(const std::string &varName) {
+    std::string name = varName.substr(varName.rfind(':') + 1);
+
+    // a shadowing local is renamed as e.g. "2Dx" (see handleValueDecl())
+    size_t i = 0;
+    while (i < name.size() && name[i] >= '0' && name[i] <= '9') {
+        ++i;
+    }
+    if (i > 0 && i < name.size() && name[i] == 'D') {
+        return name.substr(i + 1);
+    }
+    return name;
+}
+
+bool LivenessAnalysis::isTmpVarName(const std::string &varName) {
+    // temporaries are named e.g. "v:main:3t", "v:main:4if", "v:main:5L"
+    std::string name = varName.substr(varName.rfind(':') + 1);
+    size_t i = 0;
+    while (i < name.size() && name[i] >= '0' && name[i] <= '9') {
+        ++i;
+    }
+    if (i == 0) {
+        return false;
+    }
+    std::string suffix = name.substr(i);
+    return suffix == "t" || suffix == "if" || suffix == "L";
+}
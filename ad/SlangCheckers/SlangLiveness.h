@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// Native live variables analysis over the lowered SPAN IR of a function.
+// It is used to detect dead stores without a round trip through SPAN.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_LIVENESS_H
+#define SLANG_LIVENESS_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SlangIrParser.h"
+
+namespace slang {
+
+// A store to a local variable whose value is never read.
+class DeadStore {
+  public:
+    std::string varName; // e.g. "v:main:x"
+    uint32_t line;       // location of the store
+    uint32_t col;
+};
+
+class LivenessAnalysis {
+  public:
+    /** Computes liveness on the instrSeq of the given function.
+     *
+     * @param funcName name of the function, e.g. 'main' (not 'f:main').
+     * @param instrSeq the lowered instructions (one SPAN IR instr per string).
+     * @return false if the instructions could not be understood.
+     */
+    bool analyze(const std::string &funcName, const std::vector<llvm::StringRef> &instrSeq);
+
+    /** @return true if varName is live after the instruction at instrIndex. */
+    bool isLiveOut(size_t instrIndex, const std::string &varName) const;
+
+    /** @return stores to non-temporary, non-address-taken locals, which are dead. */
+    std::vector<DeadStore> getDeadStores() const;
+
+    /** @return the name as written in source, e.g. "x" for "v:main:2Dx". */
+    static std::string getSourceVarName(const std::string &varName);
+
+    /** @return true if varName names a temporary generated while lowering. */
+    static bool isTmpVarName(const std::string &varName);
+
+  private:
+    std::string funcName;
+    std::vector<std::string> varNames;
+    std::unordered_map<std::string, uint32_t> varIndex;
+    std::vector<bool> addressTaken;
+
+    // per instruction information
+    IrParser parser; // has the nodes of instrs (which point into instrSeq)
+    std::vector<IrNode> instrs;
+    std::vector<int32_t> defs; // -1 if the instr defines no variable (strongly)
+    std::vector<std::vector<uint32_t>> uses;
+    std::vector<std::vector<uint32_t>> succs;
+    std::vector<std::vector<uint64_t>> liveOut; // bit sets indexed by var id
+
+    uint32_t getVarId(const std::string &varName);
+    void addUses(const IrNode &node, std::vector<uint32_t> &useVec);
+    void markAddressTaken(const IrNode &node);
+    bool computeSuccessors();
+    void solve();
+    bool isLocalVar(const std::string &varName) const;
+};
+
+} // namespace slang
+
+#endif // SLANG_LIVENESS_H
@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// The sinks the SPAN IR is written to.
+//===----------------------------------------------------------------------===//
+
+#include "SlangOutputSink.h"
+
+#include "llvm/Support/FileSystem.h"
+
+using namespace slang;
+
+// BOUND START: FdSink
+
+FdSink::FdSink(int fd, bool shouldClose)
+    : os(fd, shouldClose, /*unbuffered=*/true), failed{false} {}
+
+bool FdSink::write(llvm::StringRef data) {
+    os << data;
+    if (os.has_error()) {
+        os.clear_error(); // else raw_fd_ostream aborts on destruction
+        failed = true;
+    }
+    return !failed;
+}
+
+bool FdSink::close() {
+    os.flush();
+    if (os.has_error()) {
+        os.clear_error();
+        failed = true;
+    }
+    return !failed;
+}
+
+// BOUND END  : FdSink
+
+// BOUND START: AsyncSink
+
+AsyncSink::AsyncSink(std::unique_ptr<OutputSink> sink, size_t flushSize)
+    : sink{std::move(sink)}, flushSize{flushSize}, backFull{false}, closing{false},
+      failed{false} {
+    front.reserve(flushSize);
+    back.reserve(flushSize);
+    writer = std::thread(&AsyncSink::writerLoop, this);
+}
+
+AsyncSink::~AsyncSink() {
+    if (writer.joinable()) {
+        close();
+    }
+}
+
+bool AsyncSink::write(llvm::StringRef data) {
+    front.append(data.data(), data.size());
+    if (front.size() >= flushSize) {
+        flush();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return !failed;
+}
+
+bool AsyncSink::close() {
+    if (!writer.joinable()) {
+        return !failed; // already closed
+    }
+    if (!front.empty()) {
+        flush();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    cond.notify_all();
+    writer.join();
+
+    bool closed = sink->close();
+    return closed && !failed;
+}
+
+// hands the front buffer over to the writer thread
+void AsyncSink::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this] { return !backFull; });
+    front.swap(back);
+    backFull = true;
+    lock.unlock();
+    cond.notify_all();
+    front.clear(); // the old back buffer, with its capacity
+}
+
+void AsyncSink::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cond.wait(lock, [this] { return backFull || closing; });
+        if (!backFull) {
+            break; // closing, and all written
+        }
+
+        // the caller does not touch back while backFull is set
+        lock.unlock();
+        bool written = sink->write(back);
+        back.clear();
+        lock.lock();
+
+        failed = failed || !written;
+        backFull = false;
+        cond.notify_all();
+    }
+}
+
+// BOUND END  : AsyncSink
+
+std::unique_ptr<OutputSink> slang::createOutputSink(const std::string &spec,
+                                                    const std::string &defaultPath, bool async,
+                                                    std::string &error) {
+    llvm::StringRef kind = llvm::StringRef(spec).split(':').first;
+    llvm::StringRef arg = llvm::StringRef(spec).split(':').second;
+
+    std::unique_ptr<OutputSink> sink;
+    if (kind == "memory") {
+        return std::unique_ptr<OutputSink>(new MemorySink());
+    } else if (kind == "null") {
+        return std::unique_ptr<OutputSink>(new NullSink());
+    } else if (kind == "fd") {
+        int fd;
+        if (arg.getAsInteger(10, fd) || fd < 0) {
+            error = "bad file descriptor in '" + spec + "'";
+            return nullptr;
+        }
+        sink.reset(new FdSink(fd, /*shouldClose=*/false));
+    } else if (kind.empty() || kind == "file" || kind == "pipe") {
+        std::string path = arg.empty() ? defaultPath : arg.str();
+        // a named pipe must exist already (its reader created it)
+        auto disposition = kind == "pipe" ? llvm::sys::fs::CD_OpenExisting
+                                          : llvm::sys::fs::CD_CreateAlways;
+        int fd;
+        if (std::error_code ec = llvm::sys::fs::openFileForWrite(path, fd, disposition)) {
+            error = "cannot open '" + path + "': " + ec.message();
+            return nullptr;
+        }
+        sink.reset(new FdSink(fd, /*shouldClose=*/true));
+    } else {
+        error = "unknown output '" + spec + "'";
+        return nullptr;
+    }
+
+    if (async) {
+        sink.reset(new AsyncSink(std::move(sink)));
+    }
+    return sink;
+} // createOutputSink()
+
+std::string slang::getOutputFilePath(const std::string &spec, const std::string &defaultPath) {
+    llvm::StringRef kind = llvm::StringRef(spec).split(':').first;
+    llvm::StringRef arg = llvm::StringRef(spec).split(':').second;
+    if (kind.empty() || kind == "file") {
+        return arg.empty() ? defaultPath : arg.str();
+    }
+    return "";
+} // getOutputFilePath()
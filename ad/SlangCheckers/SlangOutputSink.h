@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// The sinks the SPAN IR is written to.
+//
+// The emitter writes the IR in pieces (e.g. a function at a time) to an
+// OutputSink. createOutputSink() makes one from a spec string,
+//
+//     ""  or "file"   the file <source>.spanir (the default)
+//     "file:PATH"     the file PATH
+//     "fd:N"          the inherited file descriptor N (e.g. a pipe)
+//     "pipe:PATH"     the existing named pipe (or file) PATH
+//     "memory"        an in-memory buffer (see MemorySink), for embedding
+//     "null"          nothing is written (to time the lowering alone)
+//
+// With async set, a background thread does the writes (see AsyncSink),
+// so the I/O overlaps with the lowering of the next function.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_OUTPUTSINK_H
+#define SLANG_OUTPUTSINK_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace slang {
+
+class OutputSink {
+  public:
+    virtual ~OutputSink() {}
+
+    /** Appends the data. @return false on an I/O error. */
+    virtual bool write(llvm::StringRef data) = 0;
+
+    /** Writes out what is pending and closes the sink.
+     *  @return false if some write failed.
+     */
+    virtual bool close() { return true; }
+};
+
+/** Writes to a file descriptor (of a file, a pipe, a named pipe...). */
+class FdSink : public OutputSink {
+  public:
+    FdSink(int fd, bool shouldClose);
+    bool write(llvm::StringRef data) override;
+    bool close() override;
+
+  private:
+    llvm::raw_fd_ostream os; // unbuffered
+    bool failed;
+};
+
+/** Keeps the data in memory. */
+class MemorySink : public OutputSink {
+  public:
+    bool write(llvm::StringRef data) override {
+        content.append(data.data(), data.size());
+        return true;
+    }
+
+    const std::string &getContent() const { return content; }
+
+  private:
+    std::string content;
+};
+
+/** @return the SPAN IR of the last TU written to a "memory" output, and
+ *  forgets it. (It is defined with the lowering, in SlangGenAstChecker.cpp.)
+ */
+std::string takeMemoryIr();
+
+/** Drops the data (it only counts the bytes). */
+class NullSink : public OutputSink {
+  public:
+    NullSink() : byteCount{0} {}
+
+    bool write(llvm::StringRef data) override {
+        byteCount += data.size();
+        return true;
+    }
+
+    uint64_t getByteCount() const { return byteCount; }
+
+  private:
+    uint64_t byteCount;
+};
+
+/** Double buffers the writes to another sink, on a background thread.
+ *
+ *  write() appends to the front buffer. Once it holds flushSize bytes it
+ *  is swapped with the back buffer (waiting only if the writer thread is
+ *  still busy with the previous one), which the thread then writes out.
+ */
+class AsyncSink : public OutputSink {
+  public:
+    AsyncSink(std::unique_ptr<OutputSink> sink, size_t flushSize = 64 * 1024);
+    ~AsyncSink() override;
+
+    bool write(llvm::StringRef data) override;
+    bool close() override;
+
+  private:
+    std::unique_ptr<OutputSink> sink;
+    size_t flushSize;
+
+    std::string front; // filled by the caller
+    std::string back;  // written by the writer thread
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool backFull;
+    bool closing;
+    bool failed;
+    std::thread writer;
+
+    void flush();
+    void writerLoop();
+};
+
+/** Creates a sink from the spec (see above).
+ *
+ * @param defaultPath the file of the "" and "file" specs.
+ * @return nullptr on an error (the reason is in error).
+ */
+std::unique_ptr<OutputSink> createOutputSink(const std::string &spec,
+                                             const std::string &defaultPath, bool async,
+                                             std::string &error);
+
+/** @return the file the spec writes to ("" if it is no regular file,
+ *  e.g. a pipe or "memory"); see createOutputSink().
+ */
+std::string getOutputFilePath(const std::string &spec, const std::string &defaultPath);
+
+} // namespace slang
+
+#endif // SLANG_OUTPUTSINK_H
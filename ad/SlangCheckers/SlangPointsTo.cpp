@@ -0,0 +1,597 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// Native, inclusion based (Andersen style) points-to analysis over the
+// lowered SPAN IR of a whole translation unit.
+//===----------------------------------------------------------------------===//
+
+#include "SlangPointsTo.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace slang;
+
+static const uint32_t NO_NODE = UINT32_MAX;
+
+static bool startsWith(const std::string &str, const char *prefix) {
+    return str.compare(0, std::char_traits<char>::length(prefix), prefix) == 0;
+}
+
+static std::vector<uint32_t> toVector(const PointsToAnalysis::PtsSet &set) {
+    std::vector<uint32_t> vec;
+    for (uint32_t elem : set) {
+        vec.push_back(elem);
+    }
+    return vec;
+}
+
+PointsToAnalysis::PointsToAnalysis() : currStamp{0}, collapsedCount{0}, tmpCount{0} {}
+
+// BOUND START: constraint_generation
+
+void PointsToAnalysis::addVar(const std::string &varName, const std::string &typeStr) {
+    varTypes[varName] = typeStr;
+}
+
+bool PointsToAnalysis::addFunction(const std::string &funcName,
+                                   const std::vector<std::string> &paramNames,
+                                   const std::vector<llvm::StringRef> &instrSeq) {
+    currFuncName = funcName;
+
+    FuncInfo &funcInfo = funcInfos[funcName];
+    funcInfo.params.clear();
+    for (const std::string &paramName : paramNames) {
+        funcInfo.params.push_back(getNode(paramName));
+    }
+    funcInfo.ret = getNode("ret:" + funcName);
+
+    bool ok = true;
+    IrParser parser;
+    IrNode instr;
+    for (llvm::StringRef instrStr : instrSeq) {
+        if (!parser.parse(instrStr, instr) || instr.kind != IrCall) {
+            ok = false;
+            continue;
+        }
+        addInstr(instr);
+    }
+    return ok;
+} // addFunction()
+
+uint32_t PointsToAnalysis::getNode(llvm::StringRef name) {
+    auto it = nodeIds.find(name);
+    if (it != nodeIds.end()) {
+        return it->second;
+    }
+
+    uint32_t id = (uint32_t)nodes.size();
+    nodes.emplace_back();
+    nodes[id].name = name.str();
+    nodes[id].parent = id;
+    nodeIds[name] = id;
+    return id;
+}
+
+uint32_t PointsToAnalysis::newTmpNode() {
+    std::stringstream ss;
+    ss << "tmp:" << ++tmpCount;
+    return getNode(ss.str());
+}
+
+bool PointsToAnalysis::isArrayVar(llvm::StringRef varName) const {
+    // a variable array is lowered as a pointer to the allocated memory (AllocE)
+    auto it = varTypes.find(varName);
+    return it != varTypes.end() && (startsWith(it->second, "types.ConstSizeArray") ||
+                                    startsWith(it->second, "types.IncompleteArray"));
+}
+
+bool PointsToAnalysis::isRecordVar(llvm::StringRef varName) const {
+    auto it = varTypes.find(varName);
+    return it != varTypes.end() &&
+           (startsWith(it->second, "types.Struct") || startsWith(it->second, "types.Union"));
+}
+
+bool PointsToAnalysis::isAllocFunc(llvm::StringRef funcName) const {
+    return funcName == "f:malloc" || funcName == "f:calloc" || funcName == "f:realloc" ||
+           funcName == "f:aligned_alloc" || funcName == "f:strdup" || funcName == "f:strndup";
+}
+
+std::string PointsToAnalysis::getHeapName(const IrNode &expr) const {
+    uint32_t line = 0, col = 0;
+    expr.getLoc(line, col);
+    std::stringstream ss;
+    ss << "heap:" << currFuncName << ":" << line << ":" << col;
+    return ss.str();
+}
+
+void PointsToAnalysis::addInstr(const IrNode &instr) {
+    if (instr.isCall("instr.AssignI") && instr.children.size() >= 2) {
+        std::vector<Source> sources;
+        evalRhs(instr.children[1], sources);
+
+        const IrNode &lhs = instr.children[0];
+        if (lhs.isCall("expr.VarE") && lhs.children.size()) {
+            uint32_t dst = getNode(lhs.children[0].text);
+            for (const Source &source : sources) {
+                assignTo(dst, source);
+            }
+            return;
+        }
+
+        bool direct = false;
+        uint32_t node = NO_NODE;
+        if (!getLocation(lhs, direct, node)) {
+            return;
+        }
+        for (const Source &source : sources) {
+            if (direct) {
+                assignTo(node, source); // e.g. s.f = ..., arr[2] = ...
+            } else {
+                storeTo(node, source); // e.g. *p = ..., p->f = ...
+            }
+        }
+
+    } else if (instr.isCall("instr.CallI") && instr.children.size()) {
+        evalCall(instr.children[0], NO_NODE);
+
+    } else if (instr.isCall("instr.ReturnI") && instr.children.size() >= 2) {
+        std::vector<Source> sources;
+        evalRhs(instr.children[0], sources);
+        uint32_t ret = funcInfos[currFuncName].ret;
+        for (const Source &source : sources) {
+            assignTo(ret, source);
+        }
+    }
+    // CondI, GotoI, LabelI, NopI generate no constraints
+} // addInstr()
+
+// collects the values (as constraint sources) an rvalue may evaluate to
+void PointsToAnalysis::evalRhs(const IrNode &expr, std::vector<Source> &sources) {
+    const std::vector<IrNode> &args = expr.children;
+
+    if (expr.isCall("expr.VarE") && args.size()) {
+        uint32_t node = getNode(args[0].text);
+        // an array used as a value, decays to a pointer to itself
+        sources.push_back({isArrayVar(args[0].text) ? AddrOf : Copy, node});
+
+    } else if (expr.isCall("expr.FuncE") && args.size()) {
+        sources.push_back({AddrOf, getNode(args[0].text)});
+
+    } else if (expr.isCall("expr.AddrOfE") && args.size()) {
+        const IrNode &arg = args[0];
+        bool direct = false;
+        uint32_t node = NO_NODE;
+        if ((arg.isCall("expr.VarE") || arg.isCall("expr.FuncE")) && arg.children.size()) {
+            sources.push_back({AddrOf, getNode(arg.children[0].text)});
+        } else if (getLocation(arg, direct, node)) {
+            // field insensitive: &p->f is p, and &s.f is &s
+            sources.push_back({direct ? AddrOf : Copy, node});
+        }
+
+    } else if (expr.isCall("expr.UnaryE") || expr.isCall("expr.MemberE") ||
+               expr.isCall("expr.ArrayE")) {
+        bool direct = false;
+        uint32_t node = NO_NODE;
+        if (getLocation(expr, direct, node)) {
+            sources.push_back({direct ? Copy : Load, node});
+        }
+
+    } else if (expr.isCall("expr.CastE") && args.size()) {
+        evalRhs(args[0], sources);
+
+    } else if (expr.isCall("expr.BinaryE") && args.size() >= 3) {
+        // pointer arithmetic stays within the object pointed to
+        if (args[1].isName("op.BO_ADD") || args[1].isName("op.BO_SUB")) {
+            evalRhs(args[0], sources);
+            evalRhs(args[2], sources);
+        }
+
+    } else if (expr.isCall("expr.SelectE") && args.size() >= 3) {
+        evalRhs(args[1], sources);
+        evalRhs(args[2], sources);
+
+    } else if (expr.isCall("expr.AllocE")) {
+        sources.push_back({AddrOf, getNode(getHeapName(expr))});
+
+    } else if (expr.isCall("expr.CallE")) {
+        uint32_t result = newTmpNode();
+        evalCall(expr, result);
+        sources.push_back({Copy, result});
+    }
+    // LitE, SizeOfE (and the other unary operators) yield no pointers
+} // evalRhs()
+
+// The memory location accessed by a UnaryE (deref), MemberE or ArrayE.
+// It is either a variable itself (direct), e.g. s.f or arr[2],
+// or whatever the variable `node` points to, e.g. *p, p->f or p[2].
+bool PointsToAnalysis::getLocation(const IrNode &expr, bool &direct, uint32_t &node) {
+    const std::vector<IrNode> &args = expr.children;
+    const IrNode *base = nullptr;
+
+    if (expr.isCall("expr.UnaryE") && args.size() >= 2) {
+        if (!args[0].isName("op.UO_DEREF")) {
+            return false;
+        }
+        base = &args[1];
+        direct = false;
+        return (node = evalToNode(*base)) != NO_NODE;
+    }
+
+    if ((expr.isCall("expr.MemberE") || expr.isCall("expr.ArrayE")) && args.size() >= 2) {
+        base = &args[1];
+    } else {
+        return false;
+    }
+
+    if (base->isCall("expr.VarE") && base->children.size()) {
+        llvm::StringRef varName = base->children[0].text;
+        if (isRecordVar(varName) || isArrayVar(varName)) {
+            direct = true;
+            node = getNode(varName);
+            return true;
+        }
+    } else if (base->isCall("expr.MemberE") || base->isCall("expr.ArrayE")) {
+        // nested accesses (generated for initializers) are in the same object
+        return getLocation(*base, direct, node);
+    }
+
+    direct = false;
+    return (node = evalToNode(*base)) != NO_NODE;
+} // getLocation()
+
+void PointsToAnalysis::evalCall(const IrNode &callExpr, uint32_t result) {
+    if (!callExpr.isCall("expr.CallE") || callExpr.children.size() < 2) {
+        return;
+    }
+
+    const IrNode &callee = callExpr.children[0];
+    std::vector<uint32_t> argNodes;
+    if (callExpr.children[1].kind == IrList) {
+        for (const IrNode &arg : callExpr.children[1].children) {
+            argNodes.push_back(evalToNode(arg));
+        }
+    }
+
+    if (callee.isCall("expr.FuncE") && callee.children.size()) {
+        llvm::StringRef funcName = callee.children[0].text;
+        if (isAllocFunc(funcName)) {
+            if (result != NO_NODE) {
+                uint32_t heapObj = getNode(getHeapName(callExpr));
+                nodes[result].pts.set(heapObj);
+            }
+            return;
+        }
+        // bound in solve(), since the callee may not be added yet
+        DirectCall directCall;
+        directCall.funcName = funcName.str();
+        directCall.args = argNodes;
+        directCall.result = result;
+        directCalls.push_back(directCall);
+        return;
+    }
+
+    // a call through a function pointer
+    uint32_t calleeNode = evalToNode(callee);
+    if (calleeNode == NO_NODE) {
+        return;
+    }
+    IndirectCall indirectCall;
+    indirectCall.args = argNodes;
+    indirectCall.result = result;
+    indirectCalls.push_back(indirectCall);
+    nodes[calleeNode].calls.push_back((uint32_t)(indirectCalls.size() - 1));
+} // evalCall()
+
+uint32_t PointsToAnalysis::evalToNode(const IrNode &expr) {
+    std::vector<Source> sources;
+    evalRhs(expr, sources);
+    if (sources.empty()) {
+        return NO_NODE;
+    }
+    if (sources.size() == 1) {
+        return toNode(sources[0]);
+    }
+
+    uint32_t tmp = newTmpNode();
+    for (const Source &source : sources) {
+        assignTo(tmp, source);
+    }
+    return tmp;
+}
+
+uint32_t PointsToAnalysis::toNode(const Source &source) {
+    if (source.kind == Copy) {
+        return source.node;
+    }
+    uint32_t tmp = newTmpNode();
+    assignTo(tmp, source);
+    return tmp;
+}
+
+void PointsToAnalysis::assignTo(uint32_t dst, const Source &source) {
+    switch (source.kind) {
+    case AddrOf: nodes[dst].pts.set(source.node); break;
+    case Copy:
+        if (source.node != dst) {
+            nodes[source.node].succs.set(dst);
+        }
+        break;
+    case Load: nodes[source.node].loads.push_back(dst); break;
+    }
+}
+
+void PointsToAnalysis::storeTo(uint32_t ptr, const Source &source) {
+    uint32_t src = toNode(source); // may add a node (and move `nodes`)
+    nodes[ptr].stores.push_back(src);
+}
+
+// BOUND END  : constraint_generation
+
+// BOUND START: solver
+
+void PointsToAnalysis::solve() {
+    worklist.clear();
+    inWorklist.assign(nodes.size(), false);
+    checkedForCycle.clear();
+
+    for (const DirectCall &directCall : directCalls) {
+        bindCall(directCall.funcName, directCall.args, directCall.result);
+    }
+
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        if (find(i) == i && !nodes[i].pts.empty()) {
+            pushWorklist(i);
+        }
+    }
+
+    while (!worklist.empty()) {
+        uint32_t n = find(worklist.front());
+        inWorklist[worklist.front()] = false;
+        worklist.pop_front();
+        if (n != nodes[n].parent || inWorklist[n]) {
+            continue; // already merged, or processed later anyway
+        }
+
+        // difference propagation: only the newly added objects are propagated
+        PtsSet delta = nodes[n].pts;
+        delta.intersectWithComplement(nodes[n].prevPts);
+        nodes[n].prevPts = nodes[n].pts;
+
+        const Node &node = nodes[n];
+        for (uint32_t obj : delta) {
+            for (uint32_t dst : node.loads) {
+                addEdge(obj, dst);
+            }
+            for (uint32_t src : node.stores) {
+                addEdge(src, obj);
+            }
+            for (uint32_t call : node.calls) {
+                resolveCall(call, obj);
+            }
+        }
+
+        std::vector<uint32_t> succs = toVector(nodes[n].succs);
+        compact(succs);
+        if (succs.size() != (size_t)nodes[n].succs.count()) {
+            // drop the edges to the merged nodes
+            nodes[n].succs.clear();
+            for (uint32_t s : succs) {
+                nodes[n].succs.set(s);
+            }
+        }
+
+        for (uint32_t s : succs) {
+            s = find(s);
+            if (s == n) {
+                continue;
+            }
+
+            // lazy cycle detection: an edge whose ends have equal sets hints a cycle
+            if (nodes[s].pts == nodes[n].pts &&
+                checkedForCycle.insert(std::make_pair(n, s)).second) {
+                if (collapseCycle(n, s)) {
+                    n = find(n);
+                    continue;
+                }
+            }
+
+            if (nodes[s].pts |= delta) {
+                pushWorklist(s);
+            }
+        }
+    }
+} // solve()
+
+void PointsToAnalysis::bindCall(const std::string &funcName, const std::vector<uint32_t> &args,
+                                uint32_t result) {
+    auto it = funcInfos.find(funcName);
+    if (it == funcInfos.end()) {
+        return; // a library function without a declaration
+    }
+
+    const FuncInfo &funcInfo = it->second;
+    for (size_t i = 0; i < args.size() && i < funcInfo.params.size(); ++i) {
+        if (args[i] != NO_NODE) {
+            addEdge(args[i], funcInfo.params[i]);
+        }
+    }
+    if (result != NO_NODE) {
+        addEdge(funcInfo.ret, result);
+    }
+}
+
+void PointsToAnalysis::resolveCall(uint32_t call, uint32_t obj) {
+    const std::string &funcName = nodes[obj].name;
+    if (!startsWith(funcName, "f:") || !indirectCalls[call].resolved.insert(obj).second) {
+        return;
+    }
+    bindCall(funcName, indirectCalls[call].args, indirectCalls[call].result);
+}
+
+void PointsToAnalysis::pushWorklist(uint32_t node) {
+    if (!inWorklist[node]) {
+        inWorklist[node] = true;
+        worklist.push_back(node);
+    }
+}
+
+uint32_t PointsToAnalysis::find(uint32_t node) {
+    uint32_t root = node;
+    while (nodes[root].parent != root) {
+        root = nodes[root].parent;
+    }
+    while (nodes[node].parent != root) { // path compression
+        uint32_t next = nodes[node].parent;
+        nodes[node].parent = root;
+        node = next;
+    }
+    return root;
+}
+
+// replaces the nodes with their representatives, and removes the duplicates
+void PointsToAnalysis::compact(std::vector<uint32_t> &nodeVec) {
+    for (uint32_t &node : nodeVec) {
+        node = find(node);
+    }
+    std::sort(nodeVec.begin(), nodeVec.end());
+    nodeVec.erase(std::unique(nodeVec.begin(), nodeVec.end()), nodeVec.end());
+}
+
+bool PointsToAnalysis::addEdge(uint32_t src, uint32_t dst) {
+    src = find(src);
+    dst = find(dst);
+    if (src == dst || !nodes[src].succs.test_and_set(dst)) {
+        return false;
+    }
+    // a new edge propagates the whole set, not just the difference
+    if (nodes[dst].pts |= nodes[src].pts) {
+        pushWorklist(dst);
+    }
+    return true;
+}
+
+// Searches a path of copy edges from `to` back to `from`,
+// and merges the nodes on it (they must have equal points-to sets).
+bool PointsToAnalysis::collapseCycle(uint32_t from, uint32_t to) {
+    typedef std::pair<PtsSet::iterator, PtsSet::iterator> IterPair;
+    std::vector<uint32_t> path;
+    std::vector<IterPair> pending; // the successors yet to visit, of each node on path
+
+    // a new stamp marks all the nodes unvisited
+    visitStamp.resize(nodes.size(), 0);
+    currStamp += 1;
+
+    path.push_back(to);
+    pending.push_back(IterPair(nodes[to].succs.begin(), nodes[to].succs.end()));
+    visitStamp[to] = currStamp;
+
+    bool found = false;
+    while (!path.empty() && !found) {
+        IterPair &iters = pending.back();
+        if (iters.first == iters.second) {
+            path.pop_back();
+            pending.pop_back();
+            continue;
+        }
+
+        uint32_t next = find(*iters.first);
+        ++iters.first;
+        if (next == from) {
+            found = true;
+        } else if (visitStamp[next] != currStamp) {
+            visitStamp[next] = currStamp;
+            path.push_back(next);
+            pending.push_back(IterPair(nodes[next].succs.begin(), nodes[next].succs.end()));
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+    for (uint32_t node : path) {
+        unite(find(from), find(node));
+    }
+    return true;
+} // collapseCycle()
+
+void PointsToAnalysis::unite(uint32_t rep, uint32_t other) {
+    if (rep == other) {
+        return;
+    }
+
+    Node &repNode = nodes[rep];
+    Node &otherNode = nodes[other];
+    otherNode.parent = rep;
+
+    repNode.pts |= otherNode.pts;
+    repNode.succs |= otherNode.succs;
+    repNode.succs.reset(rep);
+    repNode.succs.reset(other);
+    repNode.loads.insert(repNode.loads.end(), otherNode.loads.begin(), otherNode.loads.end());
+    repNode.stores.insert(repNode.stores.end(), otherNode.stores.begin(), otherNode.stores.end());
+    repNode.calls.insert(repNode.calls.end(), otherNode.calls.begin(), otherNode.calls.end());
+    compact(repNode.loads);
+    compact(repNode.stores);
+    std::sort(repNode.calls.begin(), repNode.calls.end());
+    repNode.calls.erase(std::unique(repNode.calls.begin(), repNode.calls.end()),
+                        repNode.calls.end());
+
+    // only the objects seen by both nodes have been through all the constraints
+    repNode.prevPts &= otherNode.prevPts;
+
+    otherNode.pts.clear();
+    otherNode.prevPts.clear();
+    otherNode.succs.clear();
+    otherNode.loads.clear();
+    otherNode.stores.clear();
+    otherNode.calls.clear();
+    pushWorklist(rep);
+    collapsedCount += 1;
+} // unite()
+
+// BOUND END  : solver
+
+std::map<std::string, std::vector<std::string>> PointsToAnalysis::getPointsTo() {
+    std::map<std::string, std::vector<std::string>> result;
+
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        if (!startsWith(nodes[i].name, "v:")) {
+            continue; // temporaries, return values, functions and heap objects
+        }
+        const PtsSet &pts = nodes[find(i)].pts;
+        if (pts.empty()) {
+            continue;
+        }
+
+        std::vector<std::string> &names = result[nodes[i].name];
+        for (uint32_t obj : pts) {
+            names.push_back(nodes[obj].name);
+        }
+        std::sort(names.begin(), names.end());
+    }
+
+    return result;
+} // getPointsTo()
+
+std::string PointsToAnalysis::toString() {
+    std::stringstream ss;
+
+    ss << "{\n";
+    for (auto &entry : getPointsTo()) {
+        ss << "  \"" << entry.first << "\": [";
+        std::string prefix = "";
+        for (const std::string &name : entry.second) {
+            ss << prefix << "\"" << name << "\"";
+            prefix = ", ";
+        }
+        ss << "],\n";
+    }
+    ss << "}\n";
+
+    return ss.str();
+}
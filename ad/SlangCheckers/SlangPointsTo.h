@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// Native, inclusion based (Andersen style) points-to analysis over the
+// lowered SPAN IR of a whole translation unit.
+//
+// It is flow and context insensitive and field insensitive (a record or an
+// array is a single object). Every allocation site is an object. The solver
+// uses a difference propagation worklist, lazy cycle detection (cycles of
+// copy edges are collapsed with union-find) and sparse bit vectors for the
+// points-to sets.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_POINTSTO_H
+#define SLANG_POINTSTO_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "SlangIrParser.h"
+#include "llvm/ADT/SparseBitVector.h"
+#include "llvm/ADT/StringMap.h"
+
+namespace slang {
+
+class PointsToAnalysis {
+  public:
+    typedef llvm::SparseBitVector<> PtsSet;
+
+    PointsToAnalysis();
+
+    /** Record the type of a variable (e.g. "types.Int32").
+     *
+     *  Needed to know the arrays, since an array variable used as a value
+     *  decays to a pointer to itself.
+     */
+    void addVar(const std::string &varName, const std::string &typeStr);
+
+    /** Add the constraints of a function.
+     *
+     * @param funcName full name, e.g. "f:main".
+     * @param paramNames full names of the parameters, e.g. "v:main:argc".
+     * @param instrSeq the lowered instructions (empty for a declaration).
+     * @return false if some instruction could not be parsed (it is skipped).
+     */
+    bool addFunction(const std::string &funcName, const std::vector<std::string> &paramNames,
+                     const std::vector<llvm::StringRef> &instrSeq);
+
+    /** Solve the constraints collected so far. */
+    void solve();
+
+    /** @return variable name to the sorted names of the objects it points to.
+     *
+     *  The objects are variables, functions ("f:foo") and allocation sites
+     *  ("heap:f:main:12:3", for the site at line 12, col 3 in main).
+     */
+    std::map<std::string, std::vector<std::string>> getPointsTo();
+
+    /** @return the points-to result as a python dict (only non empty sets). */
+    std::string toString();
+
+    // stats of the last solve()
+    uint32_t getNodeCount() const { return (uint32_t)nodes.size(); }
+    uint32_t getCollapsedCount() const { return collapsedCount; }
+
+  private:
+    enum SourceKind { AddrOf, Copy, Load };
+
+    // the value an rvalue evaluates to, in terms of constraint nodes
+    struct Source {
+        SourceKind kind;
+        uint32_t node;
+    };
+
+    struct FuncInfo {
+        std::vector<uint32_t> params;
+        uint32_t ret; // the node of the returned values
+    };
+
+    struct DirectCall {
+        std::string funcName;
+        std::vector<uint32_t> args; // UINT32_MAX for non pointer arguments
+        uint32_t result;            // UINT32_MAX if the result is not used
+    };
+
+    // a call through a function pointer, resolved while solving
+    struct IndirectCall {
+        std::vector<uint32_t> args;
+        uint32_t result;
+        std::set<uint32_t> resolved; // the functions already bound
+    };
+
+    struct Node {
+        std::string name;
+        uint32_t parent; // union-find parent, self if a representative
+        PtsSet pts;
+        PtsSet prevPts; // the part of pts already propagated (difference propagation)
+        PtsSet succs;   // copy edges: pts(succ) >= pts(this)
+        std::vector<uint32_t> loads;  // dst: pts(dst) >= pts(*this)
+        std::vector<uint32_t> stores; // src: pts(*this) >= pts(src)
+        std::vector<uint32_t> calls;  // indirect calls through this node
+    };
+
+    std::vector<Node> nodes;
+    llvm::StringMap<uint32_t> nodeIds;
+    llvm::StringMap<std::string> varTypes;
+    std::unordered_map<std::string, FuncInfo> funcInfos;
+    std::vector<DirectCall> directCalls;
+    std::vector<IndirectCall> indirectCalls;
+
+    std::deque<uint32_t> worklist;
+    std::vector<bool> inWorklist;
+    std::set<std::pair<uint32_t, uint32_t>> checkedForCycle; // lazy cycle detection
+    std::vector<uint32_t> visitStamp; // nodes visited while searching a cycle
+    uint32_t currStamp;
+    uint32_t collapsedCount;
+    uint32_t tmpCount;
+    std::string currFuncName;
+
+    uint32_t getNode(llvm::StringRef name);
+    uint32_t newTmpNode();
+    bool isArrayVar(llvm::StringRef varName) const;
+    bool isRecordVar(llvm::StringRef varName) const;
+    bool isAllocFunc(llvm::StringRef funcName) const;
+    std::string getHeapName(const IrNode &expr) const;
+
+    // constraint generation
+    void addInstr(const IrNode &instr);
+    void evalRhs(const IrNode &expr, std::vector<Source> &sources);
+    bool getLocation(const IrNode &expr, bool &direct, uint32_t &node);
+    void evalCall(const IrNode &callExpr, uint32_t result);
+    uint32_t evalToNode(const IrNode &expr);
+    uint32_t toNode(const Source &source);
+    void assignTo(uint32_t dst, const Source &source);
+    void storeTo(uint32_t ptr, const Source &source);
+
+    // solving
+    void bindCall(const std::string &funcName, const std::vector<uint32_t> &args, uint32_t result);
+    void resolveCall(uint32_t call, uint32_t obj);
+    void pushWorklist(uint32_t node);
+    uint32_t find(uint32_t node);
+    void compact(std::vector<uint32_t> &nodeVec);
+    bool addEdge(uint32_t src, uint32_t dst);
+    bool collapseCycle(uint32_t from, uint32_t to);
+    void unite(uint32_t rep, uint32_t other);
+};
+
+} // namespace slang
+
+#endif // SLANG_POINTSTO_H
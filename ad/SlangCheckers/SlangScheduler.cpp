@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// A work stealing scheduler for independent tasks.
+//===----------------------------------------------------------------------===//
+
+#include "SlangScheduler.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <thread>
+
+using namespace slang;
+
+TaskScheduler::TaskScheduler(uint32_t numWorkers) : numWorkers{numWorkers}, stealCount{0} {
+    if (this->numWorkers == 0) {
+        this->numWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (uint32_t i = 0; i < this->numWorkers; ++i) {
+        queues.emplace_back(new WorkerQueue());
+    }
+}
+
+void TaskScheduler::run(const std::vector<uint64_t> &costs,
+                        const std::function<void(size_t)> &task) {
+    stealCount = 0;
+
+    // STEP 1: order the tasks, costliest first (ties in the given order).
+    std::vector<size_t> order(costs.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&costs](size_t a, size_t b) { return costs[a] > costs[b]; });
+
+    // STEP 2: deal them to the workers; the costliest ends up at the back.
+    uint32_t workers = (uint32_t)std::min<size_t>(numWorkers, std::max<size_t>(1, costs.size()));
+    for (size_t i = 0; i < order.size(); ++i) {
+        queues[i % workers]->tasks.push_front(order[i]);
+    }
+
+    // STEP 3: run; the caller's thread is worker 0.
+    std::vector<std::thread> threads;
+    for (uint32_t w = 1; w < workers; ++w) {
+        threads.emplace_back(&TaskScheduler::workerLoop, this, w, std::cref(task));
+    }
+    workerLoop(0, task);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+} // run()
+
+// Tasks do not spawn tasks, so a worker is done once all the deques are empty.
+void TaskScheduler::workerLoop(uint32_t worker, const std::function<void(size_t)> &task) {
+    size_t taskId;
+    while (popOwn(worker, taskId) || steal(worker, taskId)) {
+        task(taskId);
+    }
+}
+
+bool TaskScheduler::popOwn(uint32_t worker, size_t &taskId) {
+    WorkerQueue &queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    taskId = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool TaskScheduler::steal(uint32_t thief, size_t &taskId) {
+    // try the victims in a fixed order, starting from the next worker, and
+    // take from the front: the other end than the owner, so that a thief and
+    // the owner contend only for the last task of a deque
+    for (uint32_t i = 1; i < numWorkers; ++i) {
+        WorkerQueue &queue = *queues[(thief + i) % numWorkers];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            taskId = queue.tasks.front();
+            queue.tasks.pop_front();
+            stealCount += 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::vector<size_t>> slang::balanceBundles(const std::vector<uint64_t> &sizes,
+                                                       uint64_t bundleSize) {
+    if (sizes.empty()) {
+        return {};
+    }
+    uint64_t total = 0;
+    for (uint64_t size : sizes) {
+        total += size;
+    }
+    size_t count = sizes.size();
+    if (bundleSize > 0) {
+        count = std::min<size_t>(count, (size_t)((total + bundleSize - 1) / bundleSize));
+    }
+    count = std::max<size_t>(count, 1);
+
+    // the largest first (ties in the given order)
+    std::vector<size_t> order(sizes.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&sizes](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    // (size, bundle): the smallest bundle (then the first) on top
+    typedef std::pair<uint64_t, size_t> BundleSize;
+    std::priority_queue<BundleSize, std::vector<BundleSize>, std::greater<BundleSize>> smallest;
+    for (size_t b = 0; b < count; ++b) {
+        smallest.push(std::make_pair(0, b));
+    }
+
+    std::vector<size_t> bundleOf(sizes.size());
+    for (size_t i : order) {
+        BundleSize bundle = smallest.top();
+        smallest.pop();
+        bundleOf[i] = bundle.second;
+        smallest.push(std::make_pair(bundle.first + sizes[i], bundle.second));
+    }
+
+    std::vector<std::vector<size_t>> bundles(count);
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        bundles[bundleOf[i]].push_back(i);
+    }
+    return bundles;
+} // balanceBundles()
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// A work stealing scheduler, to run independent tasks (e.g. the
+// intraprocedural analysis of each function of a translation unit) on
+// many cores.
+//
+// Each worker owns a deque of tasks. It takes its own tasks from the back,
+// where the costliest are, so that the long tasks start early and the short
+// ones fill in at the end; an idle worker steals from the front of the
+// other deques (the short tasks the owner would run last). The caller's
+// thread is worker 0.
+//
+// balanceBundles() splits items (e.g. the functions of the sharded SPAN IR
+// output) into bundles of about equal size, for as many consumers.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_SCHEDULER_H
+#define SLANG_SCHEDULER_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace slang {
+
+class TaskScheduler {
+  public:
+    /** @param numWorkers number of threads to use (0 means all the cores). */
+    explicit TaskScheduler(uint32_t numWorkers);
+
+    /** Runs task(i) for each i in [0, costs.size()), and waits for all.
+     *
+     *  The tasks are started largest cost first. The tasks must be
+     *  independent: to merge their results deterministically, each task
+     *  should write only to its own slot (e.g. results[i]).
+     */
+    void run(const std::vector<uint64_t> &costs, const std::function<void(size_t)> &task);
+
+    uint32_t getNumWorkers() const { return numWorkers; }
+
+    /** @return the tasks stolen in the last run(). */
+    uint64_t getStealCount() const { return stealCount; }
+
+  private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    uint32_t numWorkers;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::atomic<uint64_t> stealCount;
+
+    void workerLoop(uint32_t worker, const std::function<void(size_t)> &task);
+    bool popOwn(uint32_t worker, size_t &taskId);
+    bool steal(uint32_t thief, size_t &taskId);
+};
+
+/** Splits the items, of the given sizes, into bundles of about bundleSize
+ *  each (one item a bundle if bundleSize is 0). The bundles are balanced:
+ *  the largest item goes first, each to the smallest bundle so far.
+ *
+ *  @return the items of each bundle, in their given order (deterministic;
+ *          no bundle if there is no item).
+ */
+std::vector<std::vector<size_t>> balanceBundles(const std::vector<uint64_t> &sizes,
+                                                uint64_t bundleSize);
+
+} // namespace slang
+
+#endif // SLANG_SCHEDULER_H
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// A persistent, content addressed store of function summaries.
+//===----------------------------------------------------------------------===//
+
+#include "SlangSummaryCache.h"
+#include "SlangUtil.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace slang;
+
+SummaryCache::SummaryCache(const std::string &cacheDir) : cacheDir{cacheDir} {}
+
+std::string SummaryCache::hashText(const std::string &text) {
+    llvm::MD5 md5;
+    llvm::MD5::MD5Result result;
+    md5.update(text);
+    md5.final(result);
+
+    llvm::SmallString<32> hexStr;
+    llvm::MD5::stringifyResult(result, hexStr);
+    return hexStr.str().str();
+}
+
+std::string SummaryCache::getEntryPath(const std::string &analysisId,
+                                       const std::string &irHash) const {
+    std::string key = hashText(analysisId + "\n" + irHash);
+
+    llvm::SmallString<256> path(cacheDir);
+    llvm::sys::path::append(path, key.substr(0, 2), key);
+    return path.str().str();
+}
+
+bool SummaryCache::lookup(const std::string &analysisId, const std::string &irHash,
+                          std::string &summary) const {
+    auto buffer = llvm::MemoryBuffer::getFile(getEntryPath(analysisId, irHash));
+    if (!buffer) {
+        return false; // not cached (yet)
+    }
+    summary = (*buffer)->getBuffer().str();
+    return true;
+}
+
+bool SummaryCache::store(const std::string &analysisId, const std::string &irHash,
+                         const std::string &summary) const {
+    std::string entryPath = getEntryPath(analysisId, irHash);
+    llvm::StringRef entryDir = llvm::sys::path::parent_path(entryPath);
+
+    if (std::error_code ec = llvm::sys::fs::create_directories(entryDir)) {
+        SLANG_ERROR("SummaryCache: cannot create '" << entryDir << "': " << ec.message())
+        return false;
+    }
+
+    // STEP 1: write to a uniquely named file in the same directory.
+    int fd;
+    llvm::SmallString<256> tmpPath;
+    if (std::error_code ec = llvm::sys::fs::createUniqueFile(entryPath + ".tmp-%%%%%%%%", fd,
+                                                             tmpPath)) {
+        SLANG_ERROR("SummaryCache: cannot create a file in '" << entryDir
+                    << "': " << ec.message())
+        return false;
+    }
+    {
+        llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+        os << summary;
+        os.close();
+        if (os.has_error()) {
+            os.clear_error();
+            llvm::sys::fs::remove(tmpPath);
+            SLANG_ERROR("SummaryCache: cannot write '" << tmpPath << "'")
+            return false;
+        }
+    }
+
+    // STEP 2: rename is atomic, the readers never see a partial entry.
+    if (std::error_code ec = llvm::sys::fs::rename(tmpPath, entryPath)) {
+        llvm::sys::fs::remove(tmpPath);
+        SLANG_ERROR("SummaryCache: cannot rename to '" << entryPath << "': " << ec.message())
+        return false;
+    }
+    return true;
+} // store()
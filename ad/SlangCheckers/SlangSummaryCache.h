@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// A persistent, content addressed store of function summaries.
+//
+// A summary is keyed by the hash of the function's lowered IR (its irHash)
+// and an analysis id (e.g. "slang.deadstore.v1"). The same function, seen
+// in many translation units (e.g. from a header), is analyzed only once.
+//
+// Entries are written to a temporary file and renamed into place, so many
+// processes (e.g. a parallel build) can safely share one cache directory:
+// a reader sees either no entry or a complete one.
+//
+// The layout (also used by span/util/summarycache.py) is,
+//     <cacheDir>/<key[0:2]>/<key>
+// where key = md5(analysisId + "\n" + irHash), as 32 hex digits.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_SUMMARYCACHE_H
+#define SLANG_SUMMARYCACHE_H
+
+#include <string>
+
+// the id of the functions and records of the headers, shared by the TUs in
+// the SharedIrDir (see emitShared() of SlangGenAstChecker.cpp); the "irHash"
+// of an entry is the hash of its text
+#define SHARED_IR_CACHE_ID "slang.sharedir.v1"
+
+namespace slang {
+
+class SummaryCache {
+  public:
+    explicit SummaryCache(const std::string &cacheDir);
+
+    /** @return true if a summary is found (it is copied into summary). */
+    bool lookup(const std::string &analysisId, const std::string &irHash,
+                std::string &summary) const;
+
+    /** Atomically store (or replace) a summary. @return false on an I/O error. */
+    bool store(const std::string &analysisId, const std::string &irHash,
+               const std::string &summary) const;
+
+    /** @return the file that holds the summary. */
+    std::string getEntryPath(const std::string &analysisId, const std::string &irHash) const;
+
+    /** @return the md5 of text, as 32 hex digits. */
+    static std::string hashText(const std::string &text);
+
+  private:
+    std::string cacheDir;
+};
+
+} // namespace slang
+
+#endif // SLANG_SUMMARYCACHE_H
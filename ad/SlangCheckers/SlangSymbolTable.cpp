@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// An interned symbol table, for the names of a translation unit.
+//===----------------------------------------------------------------------===//
+
+#include "SlangSymbolTable.h"
+
+#include <cassert>
+
+using namespace slang;
+
+// the key of a composite symbol packs its kind and two 29 bit ids
+#define SYMBOL_ID_BITS 29
+
+SymbolTable::SymbolTable() { getString(""); }
+
+SymbolId SymbolTable::getString(llvm::StringRef str) {
+    auto it = plainIds.find(str);
+    if (it != plainIds.end()) {
+        return it->second;
+    }
+    SymbolId id = addSymbol(Plain, 0, 0);
+    names.back() = str.str();
+    symbols.back().materialized = true;
+    plainIds[str] = id;
+    return id;
+}
+
+SymbolId SymbolTable::getLocalVar(SymbolId funcName, SymbolId varName) {
+    return getComposite(LocalVar, funcName, varName);
+}
+
+SymbolId SymbolTable::getGlobalVar(SymbolId varName) {
+    return getComposite(GlobalVar, 0, varName);
+}
+
+SymbolId SymbolTable::getFunc(SymbolId funcName) { return getComposite(Func, 0, funcName); }
+
+SymbolId SymbolTable::getRecord(bool isUnion, SymbolId recordName) {
+    return getComposite(isUnion ? Union : Struct, 0, recordName);
+}
+
+const std::string &SymbolTable::getName(SymbolId id) {
+    Symbol &symbol = symbols[id];
+    std::string &name = names[id];
+    if (symbol.materialized) {
+        return name;
+    }
+
+    // the parts are plain names, hence already materialized
+    const std::string &base = names[symbol.base];
+    switch (symbol.kind) {
+    case LocalVar: {
+        const std::string &scope = names[symbol.scope];
+        name.reserve(3 + scope.size() + base.size());
+        name += "v:";
+        name += scope;
+        name += ":";
+        break;
+    }
+    case GlobalVar:
+        name.reserve(2 + base.size());
+        name += "v:";
+        break;
+    case Func:
+        name.reserve(2 + base.size());
+        name += "f:";
+        break;
+    case Struct:
+        name.reserve(2 + base.size());
+        name += "s:";
+        break;
+    case Union:
+        name.reserve(2 + base.size());
+        name += "u:";
+        break;
+    case Plain:
+        break;
+    }
+    name += base;
+    symbol.materialized = true;
+    return name;
+} // getName()
+
+void SymbolTable::clear() {
+    symbols.clear();
+    names.clear();
+    plainIds.clear();
+    compositeIds.clear();
+    getString("");
+}
+
+SymbolId SymbolTable::getComposite(SymbolKind kind, SymbolId scope, SymbolId base) {
+    assert(scope < (1u << SYMBOL_ID_BITS) && base < (1u << SYMBOL_ID_BITS));
+    uint64_t key = ((uint64_t)kind << (2 * SYMBOL_ID_BITS)) |
+                   ((uint64_t)scope << SYMBOL_ID_BITS) | (uint64_t)base;
+
+    auto it = compositeIds.find(key);
+    if (it != compositeIds.end()) {
+        return it->second;
+    }
+    SymbolId id = addSymbol(kind, scope, base);
+    compositeIds[key] = id;
+    return id;
+}
+
+SymbolId SymbolTable::addSymbol(SymbolKind kind, SymbolId scope, SymbolId base) {
+    SymbolId id = (SymbolId)symbols.size();
+    symbols.push_back(Symbol{kind, scope, base, false});
+    names.emplace_back();
+    return id;
+}
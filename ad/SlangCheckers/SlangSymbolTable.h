@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// An interned symbol table, for the names of a translation unit.
+//
+// Each distinct name (of a variable, function, record or field) gets a
+// small, stable SymbolId. A composite name, e.g. a local variable's
+// "v:main:x", is interned as a (kind, scope, name) triple of ids, so
+// referring to a variable again costs an integer hash, not a string build.
+// The full text of a composite name is materialized only when it is first
+// asked for (i.e. at emission), and then kept.
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_SYMBOLTABLE_H
+#define SLANG_SYMBOLTABLE_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace slang {
+
+typedef uint32_t SymbolId;
+
+/** The id of the empty name "" (the name of a default constructed entity). */
+#define EMPTY_SYMBOL_ID 0
+
+class SymbolTable {
+  public:
+    SymbolTable();
+
+    /** @return the id of a plain name, e.g. "x", "main" or a field "1a". */
+    SymbolId getString(llvm::StringRef str);
+
+    /** @return the id of a local variable's name "v:<func>:<var>". */
+    SymbolId getLocalVar(SymbolId funcName, SymbolId varName);
+
+    /** @return the function (its plain name's id) of a local variable's name,
+     *          or EMPTY_SYMBOL_ID if id is not one built by getLocalVar().
+     */
+    SymbolId getScope(SymbolId id) const {
+        return symbols[id].kind == LocalVar ? symbols[id].scope : EMPTY_SYMBOL_ID;
+    }
+
+    /** @return the id of a global variable's name "v:<var>". */
+    SymbolId getGlobalVar(SymbolId varName);
+
+    /** @return the id of a function's name "f:<func>". */
+    SymbolId getFunc(SymbolId funcName);
+
+    /** @return the id of a record's name "s:<name>" (or "u:<name>" for a union). */
+    SymbolId getRecord(bool isUnion, SymbolId recordName);
+
+    /** @return the full text of a symbol.
+     *  The reference stays valid for the life of the table.
+     */
+    const std::string &getName(SymbolId id);
+
+    /** @return the number of distinct symbols. */
+    size_t size() const { return symbols.size(); }
+
+    /** Forget all the symbols (the ids are reused). */
+    void clear();
+
+  private:
+    enum SymbolKind : uint8_t { Plain = 0, LocalVar, GlobalVar, Func, Struct, Union };
+
+    struct Symbol {
+        SymbolKind kind;
+        SymbolId scope; // the function of a LocalVar
+        SymbolId base;  // the plain name of a composite symbol
+        bool materialized;
+    };
+
+    // hashes all the bits of a composite key: the default hash of a uint64_t
+    // (its low 32 bits times 37) drops most of the scope, so the locals of
+    // the same name in different functions would all collide
+    struct CompositeKeyInfo {
+        static inline uint64_t getEmptyKey() { return ~0ULL; }
+        static inline uint64_t getTombstoneKey() { return ~0ULL - 1; }
+        static unsigned getHashValue(uint64_t key) {
+            return (unsigned)((key * 0x9E3779B97F4A7C15ULL) >> 32);
+        }
+        static bool isEqual(uint64_t lhs, uint64_t rhs) { return lhs == rhs; }
+    };
+
+    std::vector<Symbol> symbols;
+    std::deque<std::string> names; // deque: growth never moves a name
+    llvm::StringMap<SymbolId> plainIds;
+    llvm::DenseMap<uint64_t, SymbolId, CompositeKeyInfo> compositeIds;
+
+    SymbolId getComposite(SymbolKind kind, SymbolId scope, SymbolId base);
+    SymbolId addSymbol(SymbolKind kind, SymbolId scope, SymbolId base);
+};
+
+} // namespace slang
+
+#endif // SLANG_SYMBOLTABLE_H
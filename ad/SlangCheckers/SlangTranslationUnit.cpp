@@ -27,7 +27,7 @@ SlangVar::SlangVar(uint64_t id, std::string name) {
 }
 
 std::string slang::SlangVar::convertToString() {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "\"" << name << "\": " << typeStr << ",";
     return ss.str();
 }
@@ -49,6 +49,9 @@ slang::SlangFunc::SlangFunc() {
     nextBbId = 0;
 }
 
+// bb must already be added
+std::vector<std::string> &slang::SlangFunc::getBbStmts(int32_t bbId) { return bbStmts[bbId + 1]; }
+
 slang::SlangTranslationUnit::SlangTranslationUnit()
     : currFunc{nullptr}, varMap{}, funcMap{}, mainStack{}, dirtyVars{}, edgeLabels{3} {
     fileName = "";
@@ -109,7 +112,7 @@ void slang::SlangTranslationUnit::setLastDeclStmtTo(const Stmt *declStmt) {
 const Stmt *slang::SlangTranslationUnit::getLastDeclStmt() const { return currFunc->lastDeclStmt; }
 
 bool slang::SlangTranslationUnit::isNewVar(uint64_t varAddr) {
-    return varMap.find(varAddr) == varMap.end();
+    return !varMap.count(varAddr);
 }
 
 uint32_t slang::SlangTranslationUnit::nextTmpId() {
@@ -119,34 +122,37 @@ uint32_t slang::SlangTranslationUnit::nextTmpId() {
 
 /// Add a new basic block with the given bbId
 void slang::SlangTranslationUnit::addBb(int32_t bbId) {
-    std::vector<std::string> emptyVector;
-    currFunc->bbStmts[bbId] = emptyVector;
+    size_t index = (size_t)(bbId + 1);
+    if (index >= currFunc->bbStmts.size()) {
+        currFunc->bbStmts.resize(index + 1);
+        currFunc->bbAdded.resize(index + 1, false);
+    }
+    currFunc->bbStmts[index].clear();
+    currFunc->bbAdded[index] = true;
 }
 
 void slang::SlangTranslationUnit::setCurrBbId(int32_t bbId) { currFunc->currBbId = bbId; }
 
 // bb must already be added
 void slang::SlangTranslationUnit::addBbStmt(std::string stmt) {
-    currFunc->bbStmts[currFunc->currBbId].push_back(stmt);
+    currFunc->getBbStmts(currFunc->currBbId).push_back(stmt);
 }
 
 // bb must already be added
 void slang::SlangTranslationUnit::addBbStmts(std::vector<std::string> &slangStmts) {
-    for (std::string slangStmt : slangStmts) {
-        currFunc->bbStmts[currFunc->currBbId].push_back(slangStmt);
-    }
+    std::vector<std::string> &bbStmts = currFunc->getBbStmts(currFunc->currBbId);
+    bbStmts.insert(bbStmts.end(), slangStmts.begin(), slangStmts.end());
 }
 
 // bb must already be added
 void slang::SlangTranslationUnit::addBbStmt(int32_t bbId, std::string slangStmt) {
-    currFunc->bbStmts[bbId].push_back(slangStmt);
+    currFunc->getBbStmts(bbId).push_back(slangStmt);
 }
 
 // bb must already be added
 void slang::SlangTranslationUnit::addBbStmts(int32_t bbId, std::vector<std::string> &slangStmts) {
-    for (std::string slangStmt : slangStmts) {
-        currFunc->bbStmts[bbId].push_back(slangStmt);
-    }
+    std::vector<std::string> &bbStmts = currFunc->getBbStmts(bbId);
+    bbStmts.insert(bbStmts.end(), slangStmts.begin(), slangStmts.end());
 }
 
 void slang::SlangTranslationUnit::addBbEdge(
@@ -161,7 +167,7 @@ void slang::SlangTranslationUnit::addVar(uint64_t varId, SlangVar &slangVar) {
 // BOUND START: record_related_routines
 
 bool SlangTranslationUnit::isRecordPresent(uint64_t recordAddr) {
-    return !(recordMap.find(recordAddr) == recordMap.end());
+    return recordMap.count(recordAddr);
 }
 
 void SlangTranslationUnit::addRecord(uint64_t recordAddr, SlangRecord slangRecord) {
@@ -176,7 +182,7 @@ int32_t SlangTranslationUnit::getNextRecordId() {
 }
 
 std::string SlangTranslationUnit::getNextRecordIdStr() {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << getNextRecordId();
     return ss.str();
 }
@@ -190,7 +196,7 @@ SlangRecordField::SlangRecordField() : anonymous{false}, name{""}, typeStr{""},
 std::string SlangRecordField::getName() const { return name; }
 
 std::string SlangRecordField::toString() {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "("
        << "\"" << name << "\"";
     ss << ", " << typeStr << ")";
@@ -217,7 +223,7 @@ SlangRecord::SlangRecord() {
 }
 
 std::string SlangRecord::getNextAnonymousFieldIdStr() {
-    std::stringstream ss;
+    AppendBuffer ss;
     nextAnonymousFieldId += 1;
     ss << nextAnonymousFieldId;
     return ss.str();
@@ -226,7 +232,7 @@ std::string SlangRecord::getNextAnonymousFieldIdStr() {
 std::vector<SlangRecordField> SlangRecord::getFields() const { return fields; }
 
 std::string SlangRecord::toString() {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << NBSP6;
     ss << ((recordKind == Struct) ? "types.Struct(\n" : "types.Union(\n");
 
@@ -248,7 +254,7 @@ std::string SlangRecord::toString() {
 }
 
 std::string SlangRecord::toShortString() {
-    std::stringstream ss;
+    AppendBuffer ss;
 
     if (recordKind == Struct) {
         ss << "types.Struct";
@@ -277,7 +283,7 @@ SlangExpr slang::SlangTranslationUnit::getTmpVarForDirtyVar(uint64_t varId) {
 }
 
 bool slang::SlangTranslationUnit::isDirtyVar(uint64_t varId) {
-    return !(dirtyVars.find(varId) == dirtyVars.end());
+    return dirtyVars.count(varId);
 }
 
 void slang::SlangTranslationUnit::clearDirtyVars() { dirtyVars.clear(); }
@@ -287,14 +293,14 @@ void slang::SlangTranslationUnit::clearDirtyVars() { dirtyVars.clear(); }
 // BOUND START: conversion_routines 1 to SPAN Strings
 
 std::string slang::SlangTranslationUnit::convertFuncName(std::string funcName) {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << FUNC_NAME_PREFIX << funcName;
     return ss.str();
 }
 
 std::string slang::SlangTranslationUnit::convertVarExpr(uint64_t varAddr) {
     // if here, var should already be in varMap
-    std::stringstream ss;
+    AppendBuffer ss;
 
     auto slangVar = varMap[varAddr];
     ss << slangVar.name;
@@ -303,7 +309,7 @@ std::string slang::SlangTranslationUnit::convertVarExpr(uint64_t varAddr) {
 }
 
 std::string slang::SlangTranslationUnit::convertBbEdges(SlangFunc &slangFunc) {
-    std::stringstream ss;
+    AppendBuffer ss;
 
     for (auto p : slangFunc.bbEdges) {
         ss << NBSP10 << "(" << std::to_string(p.first);
@@ -320,7 +326,7 @@ std::string slang::SlangTranslationUnit::convertBbEdges(SlangFunc &slangFunc) {
 
 // used only for debugging purposes
 void slang::SlangTranslationUnit::printMainStack() const {
-    std::stringstream ss;
+    AppendBuffer ss;
     ss << "MAIN_STACK: [";
     for (const Stmt *stmt : mainStack) {
         ss << stmt->getStmtClassName() << ", ";
@@ -352,20 +358,20 @@ bool slang::SlangTranslationUnit::isMainStackEmpty() const {
 
 // dump entire span ir module for the translation unit.
 void slang::SlangTranslationUnit::dumpSlangIr() {
-    std::stringstream ss;
+    AppendBuffer ss;
 
     dumpHeader(ss);
     dumpVariables(ss);
     dumpObjs(ss);
     dumpFooter(ss);
 
-    // TODO: print the content to a file.
+    // the whole TU in a single write
     std::string fileName = this->fileName + ".spanir";
-    Util::writeToFile(fileName, ss.str());
-    llvm::errs() << ss.str();
+    Util::writeToFile(fileName, ss.getRef());
+    SLANG_DEBUG("Wrote " << ss.size() << " bytes of SPAN IR to " << fileName)
 } // dumpSlangIr()
 
-void slang::SlangTranslationUnit::dumpHeader(std::stringstream &ss) {
+void slang::SlangTranslationUnit::dumpHeader(AppendBuffer &ss) {
     ss << "\n";
     ss << "# START: A_SPAN_translation_unit.\n";
     ss << "\n";
@@ -385,12 +391,12 @@ void slang::SlangTranslationUnit::dumpHeader(std::stringstream &ss) {
     ss << NBSP2 << "description = \"Auto-Translated from Clang AST.\",\n";
 } // dumpHeader()
 
-void slang::SlangTranslationUnit::dumpFooter(std::stringstream &ss) {
+void slang::SlangTranslationUnit::dumpFooter(AppendBuffer &ss) {
     ss << ") # irTUnit.TUnit() ends\n";
     ss << "\n# END  : A_SPAN_translation_unit.\n";
 } // dumpFooter()
 
-void slang::SlangTranslationUnit::dumpVariables(std::stringstream &ss) {
+void slang::SlangTranslationUnit::dumpVariables(AppendBuffer &ss) {
     ss << "\n";
     ss << NBSP2 << "allVars = {\n";
     for (const auto &var : varMap) {
@@ -402,15 +408,15 @@ void slang::SlangTranslationUnit::dumpVariables(std::stringstream &ss) {
     ss << NBSP2 << "}, # end allVars dict\n\n";
 } // dumpVariables()
 
-void slang::SlangTranslationUnit::dumpObjs(std::stringstream &ss) {
+void slang::SlangTranslationUnit::dumpObjs(AppendBuffer &ss) {
     ss << NBSP2 << "allObjs = {\n";
     dumpRecords(ss);
     dumpFunctions(ss);
     ss << NBSP2 << "}, # end allObjs dict\n";
 }
 
-void slang::SlangTranslationUnit::dumpRecords(std::stringstream &ss) {
-    for (auto slangRecord : recordMap) {
+void slang::SlangTranslationUnit::dumpRecords(AppendBuffer &ss) {
+    for (auto &slangRecord : recordMap) {
         ss << NBSP4;
         ss << "\"" << slangRecord.second.name << "\":\n";
         ss << slangRecord.second.toString();
@@ -419,9 +425,9 @@ void slang::SlangTranslationUnit::dumpRecords(std::stringstream &ss) {
     ss << "\n";
 }
 
-void slang::SlangTranslationUnit::dumpFunctions(std::stringstream &ss) {
+void slang::SlangTranslationUnit::dumpFunctions(AppendBuffer &ss) {
     std::string prefix;
-    for (auto slangFunc : funcMap) {
+    for (auto &slangFunc : funcMap) {
         ss << NBSP4; // indent
         ss << "\"" << slangFunc.second.fullName << "\":\n";
         ss << NBSP6 << "obj.Func(\n";
@@ -457,10 +463,14 @@ void slang::SlangTranslationUnit::dumpFunctions(std::stringstream &ss) {
         ss << NBSP8 << "# Note: -1 is always start/entry BB. (REQUIRED)\n";
         ss << NBSP8 << "# Note: 0 is always end/exit BB (REQUIRED)\n";
         ss << NBSP8 << "basicBlocks = {\n";
-        for (auto bb : slangFunc.second.bbStmts) {
-            ss << NBSP10 << bb.first << ": [\n";
-            if (bb.second.size()) {
-                for (auto &stmt : bb.second) {
+        const std::vector<std::vector<std::string>> &bbStmts = slangFunc.second.bbStmts;
+        for (size_t index = 0; index < bbStmts.size(); ++index) {
+            if (!slangFunc.second.bbAdded[index]) {
+                continue;
+            }
+            ss << NBSP10 << (int32_t)index - 1 << ": [\n";
+            if (bbStmts[index].size()) {
+                for (auto &stmt : bbStmts[index]) {
                     ss << NBSP12 << stmt << ",\n";
                 }
             } else {
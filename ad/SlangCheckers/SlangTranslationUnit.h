@@ -18,6 +18,8 @@
 #include <unordered_map>
 #include "clang/AST/Stmt.h"
 #include "clang/Analysis/CFG.h"
+#include "SlangBuffer.h"
+#include "SlangDeclMap.h"
 
 // int span_add_nums(int a, int b);
 
@@ -83,10 +85,13 @@ class SlangFunc {
 
     // stores bbEdges(s); entry bb id is mapped to -1
     std::vector<std::pair<int32_t, std::pair<int32_t, EdgeLabel>>> bbEdges;
-    // stmts in bb; entry bb id is mapped to -1, others remain the same
-    std::unordered_map<int32_t, std::vector<std::string>> bbStmts;
+    // stmts in bb, indexed by bbId + 1 (see getBbStmts());
+    // entry bb id is mapped to -1, others remain the same
+    std::vector<std::vector<std::string>> bbStmts;
+    std::vector<bool> bbAdded; // bbAdded[bbId + 1] is true if the bb is added
 
     SlangFunc();
+    std::vector<std::string> &getBbStmts(int32_t bbId);
 };
 
 class SlangRecordField {
@@ -132,18 +137,18 @@ class SlangTranslationUnit {
     int32_t recordId; // used to generate names for anonymous records (see getNextRecordId())
 
     // maps a unique variable id to its SlangVar.
-    std::unordered_map<uint64_t, SlangVar> varMap;
+    DeclMap<SlangVar> varMap;
     // map of var-name to a count: used in case two local variables have same name (blocks)
     std::unordered_map<std::string, int32_t> varNameMap;
-    // contains functions
-    std::unordered_map<uint64_t, SlangFunc> funcMap;
+    // contains functions (stable: currFunc points into it)
+    DeclMap<SlangFunc> funcMap;
     // contains structs
-    std::unordered_map<uint64_t, SlangRecord> recordMap;
+    DeclMap<SlangRecord> recordMap;
 
     // stack to help convert ast structure to 3-address code.
     std::vector<const Stmt *> mainStack;
     // tracks variables that become dirty in an expression
-    std::unordered_map<uint64_t, SlangExpr> dirtyVars;
+    DeclMap<SlangExpr> dirtyVars;
 
     std::vector<std::string> edgeLabels;
 
@@ -220,12 +225,12 @@ class SlangTranslationUnit {
 
     // SPAN IR dumping_routines
     void dumpSlangIr();
-    void dumpHeader(std::stringstream &ss);
-    void dumpFooter(std::stringstream &ss);
-    void dumpVariables(std::stringstream &ss);
-    void dumpObjs(std::stringstream &ss);
-    void dumpFunctions(std::stringstream &ss);
-    void dumpRecords(std::stringstream &ss);
+    void dumpHeader(AppendBuffer &ss);
+    void dumpFooter(AppendBuffer &ss);
+    void dumpVariables(AppendBuffer &ss);
+    void dumpObjs(AppendBuffer &ss);
+    void dumpFunctions(AppendBuffer &ss);
+    void dumpRecords(AppendBuffer &ss);
 
     // helper_functions for tui
     void printMainStack() const;
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// The table of the types of a SPAN IR file.
+//===----------------------------------------------------------------------===//
+
+#include "SlangTypeTable.h"
+
+using namespace slang;
+
+static bool isNameChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '_' || c == '.';
+}
+
+// @return the end of the string literal that starts at pos
+static size_t skipString(llvm::StringRef text, size_t pos) {
+    char quote = text[pos];
+    if (text.substr(pos, 3) == std::string(3, quote)) {
+        size_t close = text.find(std::string(3, quote), pos + 3);
+        return close == llvm::StringRef::npos ? text.size() : close + 3;
+    }
+    for (size_t i = pos + 1; i < text.size(); ++i) {
+        if (text[i] == '\\') {
+            ++i;
+        } else if (text[i] == quote) {
+            return i + 1;
+        }
+    }
+    return text.size();
+}
+
+// @return the end of the type that starts at pos (with "types.")
+static size_t skipType(llvm::StringRef text, size_t pos) {
+    size_t end = pos + 6;
+    while (end < text.size() && isNameChar(text[end])) {
+        ++end;
+    }
+    if (end >= text.size() || text[end] != '(') {
+        return end; // e.g. types.Int32
+    }
+
+    int depth = 0;
+    while (end < text.size()) {
+        char c = text[end];
+        if (c == '"' || c == '\'') {
+            end = skipString(text, end);
+            continue;
+        }
+        ++end;
+        if (c == '(' || c == '[') {
+            depth += 1;
+        } else if ((c == ')' || c == ']') && --depth == 0) {
+            break;
+        }
+    }
+    return end;
+}
+
+// BOUND START: TypeTable
+
+void TypeTable::internTypes(llvm::StringRef text, std::string &out) {
+    out.reserve(out.size() + text.size());
+    size_t copied = 0; // the text before it is in out
+    size_t pos = 0;
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (c == '"' || c == '\'') {
+            pos = skipString(text, pos);
+        } else if (c == '#') {
+            size_t newline = text.find('\n', pos);
+            pos = newline == llvm::StringRef::npos ? text.size() : newline;
+        } else if (c == 't' && text.substr(pos, 6) == "types." &&
+                   (pos == 0 || !isNameChar(text[pos - 1]))) {
+            size_t end = skipType(text, pos);
+            out.append(text.data() + copied, pos - copied);
+            out += "T(" + std::to_string(getIndex(text.slice(pos, end))) + ")";
+            copied = pos = end;
+        } else {
+            ++pos;
+        }
+    }
+    out.append(text.data() + copied, text.size() - copied);
+}
+
+uint32_t TypeTable::getIndex(llvm::StringRef typeStr) {
+    auto inserted = typeIndex.insert(std::make_pair(typeStr, (uint32_t)types.size()));
+    if (inserted.second) {
+        types.push_back(typeStr.str());
+    }
+    return inserted.first->second;
+}
+
+void TypeTable::dump(const std::string &indent, std::string &out) const {
+    out += "[\n";
+    for (size_t i = 0; i < types.size(); ++i) {
+        out += indent + "  " + types[i] + ", # " + std::to_string(i) + "\n";
+    }
+    out += indent + "]";
+}
+
+void TypeTable::clear() {
+    types.clear();
+    typeIndex.clear();
+}
+
+// BOUND END  : TypeTable
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// The table of the types of a SPAN IR file.
+//
+// The same types (e.g. types.Ptr(to=types.Struct("s:node"))) are repeated
+// in the variables, the casts and the calls of the IR. With the table each
+// is written once, in the allTypes list of the translation unit,
+//
+//     allTypes = [
+//       types.Int32, # 0
+//       types.Ptr(to=types.Struct("s:node")), # 1
+//     ], # end allTypes list
+//
+// and elsewhere referred to by its index, as T(1). The text is lowered with
+// the full types (they key the caches); internTypes() puts in the
+// references as the text is written out. A table entry is a full type: it
+// never refers to another entry.
+//
+// The readers resolve the references: IrFile (for the C++ tools) and
+// span.ir.irload (for python, where each type is thus made once).
+//===----------------------------------------------------------------------===//
+
+#ifndef SLANG_TYPETABLE_H
+#define SLANG_TYPETABLE_H
+
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace slang {
+
+class TypeTable {
+  public:
+    /** Appends the text to out, with each type in it (outside of the
+     *  string literals) replaced by its T(<index>), added to the table
+     *  if new.
+     */
+    void internTypes(llvm::StringRef text, std::string &out);
+
+    /** @return the index of the type (its text), added if new. */
+    uint32_t getIndex(llvm::StringRef typeStr);
+
+    size_t size() const { return types.size(); }
+
+    /** Appends the list of the types to out, "[\n<indent>  TYPE, # 0\n...<indent>]". */
+    void dump(const std::string &indent, std::string &out) const;
+
+    void clear();
+
+  private:
+    std::vector<std::string> types;
+    llvm::StringMap<uint32_t> typeIndex; // type -> index in types
+};
+
+} // namespace slang
+
+#endif // SLANG_TYPETABLE_H
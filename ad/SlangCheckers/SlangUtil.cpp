@@ -10,6 +10,9 @@
 
 #include "SlangUtil.h"
 
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
 #include <ctime>
 #include <string>
 #include <fstream>
@@ -52,15 +55,20 @@ std::string slang::Util::readFromFile(std::string fileName) {
     return ss.str();
 }
 
-int slang::Util::writeToFile(std::string fileName, std::string content) {
-    std::ofstream outputTxtFile;
+int slang::Util::writeToFile(const std::string &fileName, llvm::StringRef content) {
+    int fd;
+    if (std::error_code ec = llvm::sys::fs::openFileForWrite(fileName, fd)) {
+        SLANG_ERROR("SLANG: ERROR: Error writing to file (can't open): '" << fileName
+                    << "': " << ec.message());
+        return 0;
+    }
 
-    outputTxtFile.open(fileName);
-    if (outputTxtFile.is_open()) {
-        outputTxtFile << content;
-        outputTxtFile.close();
-    } else {
-        SLANG_ERROR("SLANG: ERROR: Error writing to file (can't open): '" << fileName);
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true, /*unbuffered=*/true);
+    os << content; // unbuffered: straight to write(2), no copy
+    os.close();
+    if (os.has_error()) {
+        os.clear_error();
+        SLANG_ERROR("SLANG: ERROR: Error writing to file: '" << fileName);
         return 0;
     }
 
@@ -12,6 +12,7 @@
 #define LLVM_SLANGUTIL_H
 
 #include <string>
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Process.h"
 
 // TRACE < DEBUG < INFO < EVENT < ERROR < FATAL
@@ -98,11 +99,11 @@ class Util {
      */
     static int appendToFile(std::string fileName, std::string content);
 
-    /** Write contents to the given fileName.
+    /** Write contents to the given fileName, in a single (unbuffered) write.
      *
      * @return zero if failed.
      */
-    static int writeToFile(std::string fileName, std::string content);
+    static int writeToFile(const std::string &fileName, llvm::StringRef content);
 
     static uint32_t getNextUniqueId();
     static std::string getNextUniqueIdStr();
@@ -0,0 +1,311 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// slang-ircheck: validates .spanir files without python (see SlangIrFile.h).
+//
+//     slang-ircheck test.c.spanir archive/*.spanir
+//
+// prints, for each file, its functions, records and variables and the parse
+// speed, or the FILE:LINE:COL of its first error; the exit status is 1 if
+// some file is malformed. The index of a file (FILE.idx), if present, is
+// checked against it.
+//
+//     slang-ircheck -dead-stores test.c.spanir
+//
+// also runs the native liveness analysis (see SlangLiveness.h) on each
+// function, and prints its dead stores as the DeadStore checker reports them,
+//
+//     test.c.spanir: f:main: 4:3: Value stored to 'x' is never read
+//
+//     slang-ircheck -points-to test.c.spanir
+//
+// also runs the native points-to analysis (see SlangPointsTo.h) on the
+// whole file, and prints its size, the time to generate its constraints
+// and to solve them, and its result as the checker option PointsTo=true
+// dumps it (to FILE.spanpts),
+//
+//     test.c.spanir: points-to: 42 nodes, 3 collapsed (0.000 s + 0.000 s)
+//     {
+//       "v:main:p": ["v:main:a"],
+//     }
+//
+//     slang-ircheck -call-graph test.c.spanir
+//
+// also builds the call graph of the file from its instructions (see
+// SlangCallGraph.h; a call through a pointer by the type of the pointer,
+// a function by its returnType and the types of its parameters), and prints
+// it as the checker dumps it, noting the functions whose callees differ
+// from those of the callGraph of the file. (The IR does not tell a function
+// without a prototype, int f(), from int f(void): the call graph takes it
+// as prototyped.)
+//
+//     test.c.spanir: call graph: 4 functions, 4 SCCs
+//     callGraph = {
+//       "f:main": ["f:id", "f:malloc", "f:other"],
+//     ...
+//
+// It is a clang tool only for the build: copy this directory to
+// clang/tools/slang-ircheck, and add it (linked with LLVMSupport, with
+// SlangIrParser.cpp, SlangIrFile.cpp, SlangLiveness.cpp, SlangPointsTo.cpp
+// and SlangCallGraph.cpp of the SlangCheckers directory) to
+// clang/tools/CMakeLists.txt.
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "SlangCallGraph.h"
+#include "SlangIrFile.h"
+#include "SlangLiveness.h"
+#include "SlangPointsTo.h"
+
+using namespace slang;
+
+// the text of each instruction of the function, as the checker lowers it
+static void getInstrs(const IrFunc &func, std::vector<std::string> &instrTexts,
+                      std::vector<llvm::StringRef> &instrs) {
+    instrTexts.assign(func.instrSeq->children.size(), std::string());
+    for (size_t i = 0; i < instrTexts.size(); ++i) {
+        func.instrSeq->children[i].print(instrTexts[i]);
+        instrs.push_back(instrTexts[i]);
+    }
+}
+
+// prints the dead stores of the functions of the file
+// @return false if the instructions of some function are not understood
+static bool printDeadStores(const IrFile &irFile, llvm::StringRef fileName) {
+    bool ok = true;
+    for (const IrFunc &func : irFile.getFuncs()) {
+        if (!func.instrSeq) {
+            continue; // the older basicBlocks form
+        }
+        std::vector<std::string> instrTexts;
+        std::vector<llvm::StringRef> instrs;
+        getInstrs(func, instrTexts, instrs);
+
+        LivenessAnalysis liveness;
+        if (!liveness.analyze(func.name.substr(2), instrs)) {
+            llvm::errs() << fileName << ": " << func.name << ": liveness not computed\n";
+            ok = false;
+            continue;
+        }
+        for (const DeadStore &deadStore : liveness.getDeadStores()) {
+            llvm::outs() << fileName << ": " << func.name << ": " << deadStore.line << ":"
+                         << deadStore.col << ": Value stored to '"
+                         << LivenessAnalysis::getSourceVarName(deadStore.varName)
+                         << "' is never read\n";
+        }
+    }
+    return ok;
+}
+
+// prints the points-to sets of the variables of the file
+// @return false if the instructions of some function are not understood
+static bool printPointsTo(const IrFile &irFile, llvm::StringRef fileName) {
+    auto start = std::chrono::steady_clock::now();
+    PointsToAnalysis pointsTo;
+    for (const IrVar &var : irFile.getVars()) {
+        std::string typeStr;
+        var.type->print(typeStr);
+        pointsTo.addVar(var.name, typeStr);
+    }
+
+    bool ok = true;
+    for (const IrFunc &func : irFile.getFuncs()) {
+        if (!func.instrSeq) {
+            continue; // the older basicBlocks form
+        }
+        std::vector<std::string> instrTexts;
+        std::vector<llvm::StringRef> instrs;
+        getInstrs(func, instrTexts, instrs);
+        if (!pointsTo.addFunction(func.name, func.paramNames, instrs)) {
+            llvm::errs() << fileName << ": " << func.name << ": some instructions skipped\n";
+            ok = false;
+        }
+    }
+    auto solveStart = std::chrono::steady_clock::now();
+    pointsTo.solve();
+    auto end = std::chrono::steady_clock::now();
+
+    llvm::outs() << fileName << ": points-to: " << pointsTo.getNodeCount() << " nodes, "
+                 << pointsTo.getCollapsedCount() << " collapsed ("
+                 << llvm::format("%.3f", std::chrono::duration<double>(solveStart - start).count())
+                 << " s + "
+                 << llvm::format("%.3f", std::chrono::duration<double>(end - solveStart).count())
+                 << " s)\n";
+    llvm::outs() << pointsTo.toString();
+    return ok;
+}
+
+// appends the type as the checker writes it (e.g. a returnType= argument without its keyword)
+static void printType(const IrNode &type, std::string &out) {
+    IrNode value = type;
+    value.keyword = llvm::StringRef();
+    value.print(out);
+}
+
+// the signature (a types.FuncSig string) of the type of a callee, "" if unknown
+static std::string getCalleeSig(const IrNode &type) {
+    std::string funcSig;
+    if (type.isCall("types.Ptr") && type.children.size() == 1) {
+        return getCalleeSig(type.children[0]);
+    }
+    if (type.isCall("types.FuncSig")) {
+        printType(type, funcSig);
+    }
+    return funcSig;
+}
+
+// adds the calls in the tree of an instruction to the call graph
+// @return false if the callee of some call is not understood
+static bool addCalls(const IrNode &node, const std::string &caller,
+                     const llvm::StringMap<const IrNode *> &varTypes, CallGraph &callGraph) {
+    bool ok = true;
+    if (node.isCall("expr.CallE") && !node.children.empty()) {
+        const IrNode &callee = node.children[0];
+        std::string funcSig;
+        if (callee.isCall("expr.FuncE") && !callee.children.empty()) {
+            callGraph.addCall(caller, callee.children[0].text.str());
+        } else if (callee.isCall("expr.VarE") && !callee.children.empty() &&
+                   varTypes.count(callee.children[0].text) &&
+                   !(funcSig = getCalleeSig(*varTypes.lookup(callee.children[0].text))).empty()) {
+            callGraph.addIndirectCall(caller, funcSig);
+        } else {
+            ok = false;
+        }
+    }
+    for (const IrNode &child : node.children) {
+        ok = addCalls(child, caller, varTypes, callGraph) && ok;
+    }
+    return ok;
+}
+
+// prints the call graph of the file, built from its instructions
+// @return false if the callee of some call is not understood
+static bool printCallGraph(const IrFile &irFile, llvm::StringRef fileName) {
+    llvm::StringMap<const IrNode *> varTypes;
+    for (const IrVar &var : irFile.getVars()) {
+        varTypes[var.name] = var.type;
+    }
+
+    bool ok = true;
+    CallGraph callGraph;
+    for (const IrFunc &func : irFile.getFuncs()) {
+        std::string funcSig = "types.FuncSig(returnType=";
+        printType(*func.returnType, funcSig);
+        funcSig += ", paramTypes=[";
+        for (size_t i = 0; i < func.paramNames.size(); ++i) {
+            auto type = varTypes.find(func.paramNames[i]);
+            if (type == varTypes.end()) {
+                funcSig = ""; // (the IR is not complete)
+                break;
+            }
+            funcSig += i ? ", " : "";
+            printType(*type->second, funcSig);
+        }
+        if (!funcSig.empty()) {
+            funcSig += func.variadic ? "], variadic=True)" : "])";
+        }
+        callGraph.addFunction(func.name, funcSig);
+
+        if (!func.instrSeq) {
+            continue; // the older basicBlocks form
+        }
+        if (!addCalls(*func.instrSeq, func.name, varTypes, callGraph)) {
+            llvm::errs() << fileName << ": " << func.name << ": some callees not understood\n";
+            ok = false;
+        }
+    }
+    callGraph.computeSccs();
+
+    llvm::outs() << fileName << ": call graph: " << irFile.getFuncs().size() << " functions, "
+                 << callGraph.getSccs().size() << " SCCs\n";
+    for (const IrNode &arg : irFile.getRoot().children) {
+        if (arg.keyword != "callGraph") {
+            continue;
+        }
+        for (size_t i = 0; i + 1 < arg.children.size(); i += 2) {
+            std::vector<std::string> callees;
+            for (const IrNode &callee : arg.children[i + 1].children) {
+                callees.push_back(callee.text.str());
+            }
+            std::sort(callees.begin(), callees.end());
+            if (callees != callGraph.getCallees(arg.children[i].text.str())) {
+                llvm::outs() << fileName << ": " << arg.children[i].text
+                             << ": callees differ from the callGraph of the file\n";
+            }
+        }
+    }
+    llvm::outs() << callGraph.toString("");
+    return ok;
+}
+
+int main(int argc, const char **argv) {
+    int first = 1;
+    bool deadStores = false, pointsTo = false, callGraph = false;
+    for (; first < argc && argv[first][0] == '-'; ++first) {
+        llvm::StringRef option = argv[first];
+        if (option == "-dead-stores") {
+            deadStores = true;
+        } else if (option == "-points-to") {
+            pointsTo = true;
+        } else if (option == "-call-graph") {
+            callGraph = true;
+        } else {
+            llvm::errs() << argv[0] << ": unknown option " << option << "\n";
+            return 1;
+        }
+    }
+    if (argc <= first) {
+        llvm::errs() << "usage: " << argv[0]
+                     << " [-dead-stores] [-points-to] [-call-graph] <.spanir file>...\n";
+        return 1;
+    }
+
+    int status = 0;
+    for (int i = first; i < argc; ++i) {
+        IrFile irFile;
+        std::string error;
+        auto start = std::chrono::steady_clock::now();
+        if (!irFile.readFile(argv[i], error)) {
+            llvm::errs() << error << "\n";
+            status = 1;
+            continue;
+        }
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double megaBytes = irFile.getTextSize() / (1024.0 * 1024.0);
+        llvm::outs() << argv[i] << ": ok: " << irFile.getFuncs().size() << " functions, "
+                     << irFile.getRecords().size() << " records, " << irFile.getVars().size()
+                     << " variables (" << llvm::format("%.1f", megaBytes) << " MB in "
+                     << llvm::format("%.3f", seconds) << " s)\n";
+
+        std::string indexName = std::string(argv[i]) + ".idx";
+        auto index = llvm::MemoryBuffer::getFile(indexName);
+        if (index && !irFile.checkIndex((*index)->getBuffer(), indexName, error)) {
+            llvm::errs() << error << "\n";
+            status = 1;
+        }
+        if (deadStores && !printDeadStores(irFile, argv[i])) {
+            status = 1;
+        }
+        if (pointsTo && !printPointsTo(irFile, argv[i])) {
+            status = 1;
+        }
+        if (callGraph && !printCallGraph(irFile, argv[i])) {
+            status = 1;
+        }
+    }
+    return status;
+}
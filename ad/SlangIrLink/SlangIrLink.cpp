@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// slang-irlink: links the SPAN IR of the TUs of a program (see SlangIrLinker.h).
+//
+//     slang-irlink -o prog.spanprog a.c.spanir b.c.spanir @more.txt
+//
+// links the .spanir files (and those listed, one a line, in more.txt) into
+// prog.spanprog, and reports the conflicts (the renamed items). A file
+// that cannot be read is skipped, and the exit status is then 1.
+//
+//     slang-irlink -shared DIR -o prog.spanprog ...
+//
+// reads the constructs of the headers, that the files refer to, from DIR
+// (the SharedIrDir of the checker).
+//
+//     slang-irlink -list prog.spanprog
+//
+// prints the items of a .spanprog file (kind, name, offset, size).
+//
+// It is a clang tool only for the build: copy this directory to
+// clang/tools/slang-irlink, and add it (linked with LLVMSupport, with
+// SlangIrParser.cpp, SlangIrFile.cpp, SlangIrLinker.cpp, SlangCallGraph.cpp,
+// SlangSummaryCache.cpp and SlangUtil.cpp of the SlangCheckers directory)
+// to clang/tools/CMakeLists.txt.
+//===----------------------------------------------------------------------===//
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "SlangIrLinker.h"
+
+using namespace slang;
+
+static int listProgram(const std::string &path) {
+    static const char *kindNames[] = {"func",      "locals", "global", "record",
+                                      "callGraph", "sccs",   "units",  "typeLayouts"};
+    ProgramIrReader reader;
+    std::string error;
+    if (!reader.readFile(path, error)) {
+        llvm::errs() << error << "\n";
+        return 1;
+    }
+    for (const ProgItem &item : reader.getItems()) {
+        llvm::outs() << (item.kind <= ProgTypeLayouts ? kindNames[item.kind] : "?") << "\t" << item.name
+                     << "\t" << item.offset << "\t" << item.size << "\n";
+    }
+    return 0;
+}
+
+int main(int argc, const char **argv) {
+    if (argc == 3 && std::string(argv[1]) == "-list") {
+        return listProgram(argv[2]);
+    }
+    std::string sharedIrDir;
+    int arg = 1;
+    if (argc > 3 && std::string(argv[1]) == "-shared") {
+        sharedIrDir = argv[2];
+        arg = 3;
+    }
+    if (argc < arg + 3 || std::string(argv[arg]) != "-o") {
+        llvm::errs() << "usage: " << argv[0]
+                     << " [-shared <dir>] -o <.spanprog file> <.spanir file | @list>...\n"
+                     << "       " << argv[0] << " -list <.spanprog file>\n";
+        return 1;
+    }
+
+    std::vector<std::string> paths;
+    const char *progPath = argv[arg + 1];
+    for (int i = arg + 2; i < argc; ++i) {
+        if (argv[i][0] != '@') {
+            paths.push_back(argv[i]);
+            continue;
+        }
+        std::ifstream list(argv[i] + 1);
+        std::string line;
+        while (std::getline(list, line)) {
+            if (line.size()) {
+                paths.push_back(line);
+            }
+        }
+    }
+
+    IrLinker linker;
+    linker.setSharedIrDir(sharedIrDir);
+    std::string error;
+    if (!linker.open(progPath, error)) {
+        llvm::errs() << error << "\n";
+        return 1;
+    }
+
+    int status = 0;
+    for (const std::string &path : paths) {
+        if (!linker.addFile(path, error)) {
+            llvm::errs() << error << " (skipped)\n";
+            status = 1;
+        }
+    }
+    if (!linker.finish(error)) {
+        llvm::errs() << error << "\n";
+        return 1;
+    }
+
+    for (const std::string &conflict : linker.getConflicts()) {
+        llvm::errs() << "conflict: " << conflict << "\n";
+    }
+    llvm::outs() << progPath << ": " << linker.getUnitCount() << " units, "
+                 << linker.getFuncCount() << " functions defined ("
+                 << linker.getSharedCount() << " more shared), "
+                 << linker.getConflicts().size() << " conflicts\n";
+    return status;
+}
@@ -0,0 +1,368 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// slang-server: a long lived process that converts C files to SPAN IR.
+//
+// `clang --analyze` re-parses every header and sets up the analyzer again
+// on each conversion. The server instead keeps the parsed TUs (ASTUnits)
+// of the files it converted, each with a precompiled preamble of its
+// headers. Converting a file again only re-parses the file itself; the
+// SlangGenAst checker then lowers it into a "memory" output.
+//
+// It is a clang tool: copy this directory to clang/tools/slang-server, and
+// add it (linked with clangFrontend, clangStaticAnalyzerFrontend and
+// clangStaticAnalyzerCheckers, which hold the SLANG checkers, with the
+// SlangCheckers directory on its include path) to clang/tools/CMakeLists.txt.
+// Run it as,
+//
+//     slang-server /tmp/slang.sock
+//
+// A client (e.g. span/util/slangserver.py) sends, over the unix socket,
+//
+//     convert <source file>
+//     arg <a compile flag>          (any number of times)
+//     config <checker option>=<v>   (e.g. config Output=file:/tmp/test.c.spanir)
+//     end
+//
+// and receives "ok <size>\n" followed by the size bytes of the SPAN IR
+// (size is 0 if the Output option writes the IR elsewhere), or
+// "error <message>\n" (also for a request cut short, without its end line).
+// The request "shutdown\n" stops the server; a client gone away does not.
+// The requests are served one at a time (the lowering has global state).
+//
+// The IR is the same as that of `clang --analyze` with the same flags and
+// checker options (spanir/tests/test_slangserver.py compares them): the
+// checker runs on the same function bodies, in the same order (see
+// runSlangGen()), and its state is reset after each TU.
+//===----------------------------------------------------------------------===//
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+#include "clang/AST/DeclGroup.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/PCHContainerOperations.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/StaticAnalyzer/Frontend/AnalysisConsumer.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "SlangOutputSink.h"
+#include "SlangUtil.h"
+
+using namespace clang;
+
+#define SLANG_GEN_CHECKER "debug.SlangGenAst"
+
+// the TUs kept parsed (the least recently used one is dropped)
+#define MAX_CACHED_UNITS 32
+
+namespace {
+
+struct ConvertRequest {
+    std::string fileName;
+    std::vector<std::string> args;
+    std::vector<std::pair<std::string, std::string>> configs;
+};
+
+// a parsed TU, kept to be re-parsed with its preamble
+struct CachedUnit {
+    std::string key; // the file name and its compile flags
+    std::shared_ptr<CompilerInvocation> invocation;
+    std::unique_ptr<ASTUnit> unit;
+};
+
+class SlangServer {
+  public:
+    explicit SlangServer(const char *argv0)
+        : pchOps{std::make_shared<PCHContainerOperations>()},
+          resourceDir{CompilerInvocation::GetResourcesPath(argv0, (void *)(intptr_t)&serverMain)},
+          requestCount{0}, reparseCount{0} {}
+
+    static int serverMain(int argc, const char **argv);
+
+    /** Converts the file. @return false on an error (the reason is in error). */
+    bool convert(const ConvertRequest &request, std::string &spanIr, std::string &error);
+
+  private:
+    std::shared_ptr<PCHContainerOperations> pchOps;
+    std::string resourceDir;
+    std::list<CachedUnit> units; // the most recently used first
+    uint64_t requestCount;
+    uint64_t reparseCount;
+
+    CachedUnit *getUnit(const ConvertRequest &request, std::string &error);
+    void runSlangGen(CachedUnit &cachedUnit, const ConvertRequest &request);
+};
+
+// BOUND START: conversion
+
+CachedUnit *SlangServer::getUnit(const ConvertRequest &request, std::string &error) {
+    std::string key = request.fileName;
+    for (const std::string &arg : request.args) {
+        key += "\n" + arg;
+    }
+
+    for (auto it = units.begin(); it != units.end(); ++it) {
+        if (it->key == key) {
+            units.splice(units.begin(), units, it);
+            // only the main file is parsed again (if the headers are unchanged)
+            if (units.front().unit->Reparse(pchOps)) {
+                units.pop_front();
+                error = "cannot parse " + request.fileName;
+                return nullptr;
+            }
+            reparseCount += 1;
+            return &units.front();
+        }
+    }
+
+    std::vector<const char *> args;
+    args.push_back("clang");
+    for (const std::string &arg : request.args) {
+        args.push_back(arg.c_str());
+    }
+    args.push_back(request.fileName.c_str());
+
+    IntrusiveRefCntPtr<DiagnosticsEngine> diags =
+        CompilerInstance::createDiagnostics(new DiagnosticOptions());
+    std::shared_ptr<CompilerInvocation> invocation =
+        createInvocationFromCommandLine(args, diags);
+    if (!invocation) {
+        error = "bad compile flags for " + request.fileName;
+        return nullptr;
+    }
+    invocation->getHeaderSearchOpts().ResourceDir = resourceDir;
+
+    CachedUnit cachedUnit;
+    cachedUnit.key = key;
+    cachedUnit.invocation = invocation;
+    cachedUnit.unit = ASTUnit::LoadFromCompilerInvocation(
+        invocation, pchOps, diags, new FileManager(invocation->getFileSystemOpts()),
+        /*OnlyLocalDecls=*/false, /*CaptureDiagnostics=*/true,
+        /*PrecompilePreambleAfterNParses=*/1);
+    if (!cachedUnit.unit || cachedUnit.unit->getDiagnostics().hasErrorOccurred()) {
+        error = "cannot parse " + request.fileName;
+        return nullptr;
+    }
+
+    units.push_front(std::move(cachedUnit));
+    if (units.size() > MAX_CACHED_UNITS) {
+        units.pop_back();
+    }
+    return &units.front();
+} // getUnit()
+
+// runs the SlangGenAst checker (alone) on the parsed TU
+void SlangServer::runSlangGen(CachedUnit &cachedUnit, const ConvertRequest &request) {
+    ASTUnit &unit = *cachedUnit.unit;
+
+    AnalyzerOptions &analyzerOpts = *cachedUnit.invocation->getAnalyzerOpts();
+    analyzerOpts.CheckersControlList.clear();
+    analyzerOpts.CheckersControlList.emplace_back(SLANG_GEN_CHECKER, true);
+    analyzerOpts.Config.clear();
+    analyzerOpts.Config[SLANG_GEN_CHECKER ":Output"] = "memory";
+    analyzerOpts.Config[SLANG_GEN_CHECKER ":AsyncOutput"] = "false";
+    for (const auto &config : request.configs) {
+        analyzerOpts.Config[SLANG_GEN_CHECKER ":" + config.first] = config.second;
+    }
+
+    // a compiler instance over the parsed TU (the ASTUnit still owns it)
+    CompilerInstance compiler(pchOps);
+    compiler.setInvocation(cachedUnit.invocation);
+    compiler.setDiagnostics(&unit.getDiagnostics());
+    compiler.setFileManager(&unit.getFileManager());
+    compiler.setSourceManager(&unit.getSourceManager());
+    compiler.setPreprocessor(unit.getPreprocessorPtr());
+    compiler.setASTContext(&unit.getASTContext());
+
+    std::unique_ptr<ento::AnalysisASTConsumer> consumer = ento::CreateAnalysisConsumer(compiler);
+    consumer->Initialize(unit.getASTContext());
+    // The decls the consumer visits. clang --analyze hands it every top
+    // level decl, but it runs the checkers only on those of the main file
+    // (in the order they are defined), unless -analyzer-opt-analyze-headers
+    // (AnalyzeAll) is given. So the decls of the main file alone (the
+    // ASTUnit's top level decls; the preamble is not deserialized) give the
+    // same IR, and all the decls of the TU are handed over only with
+    // AnalyzeAll.
+    if (analyzerOpts.AnalyzeAll) {
+        for (Decl *decl : unit.getASTContext().getTranslationUnitDecl()->decls()) {
+            consumer->HandleTopLevelDecl(DeclGroupRef(decl));
+        }
+    } else {
+        for (auto it = unit.top_level_begin(); it != unit.top_level_end(); ++it) {
+            consumer->HandleTopLevelDecl(DeclGroupRef(*it));
+        }
+    }
+    consumer->HandleTranslationUnit(unit.getASTContext());
+} // runSlangGen()
+
+bool SlangServer::convert(const ConvertRequest &request, std::string &spanIr,
+                          std::string &error) {
+    requestCount += 1;
+    CachedUnit *cachedUnit = getUnit(request, error);
+    if (!cachedUnit) {
+        return false;
+    }
+
+    runSlangGen(*cachedUnit, request);
+    spanIr = slang::takeMemoryIr();
+    SLANG_EVENT("SlangServer: converted " << request.fileName << " (" << requestCount
+                << " requests, " << reparseCount << " re-parses, " << units.size()
+                << " TUs kept)")
+    return true;
+} // convert()
+
+// BOUND END  : conversion
+
+// BOUND START: protocol
+
+// reads a line (without the '\n'); @return false at the end of the input
+bool readLine(int fd, std::string &buffer, std::string &line) {
+    while (true) {
+        size_t newline = buffer.find('\n');
+        if (newline != std::string::npos) {
+            line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            return true;
+        }
+        char chunk[4096];
+        ssize_t size = read(fd, chunk, sizeof(chunk));
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size <= 0) {
+            return false;
+        }
+        buffer.append(chunk, (size_t)size);
+    }
+}
+
+bool writeAll(int fd, llvm::StringRef data) {
+    while (!data.empty()) {
+        ssize_t size = write(fd, data.data(), data.size());
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size <= 0) {
+            return false;
+        }
+        data = data.drop_front((size_t)size);
+    }
+    return true;
+}
+
+// serves the requests of a client; @return false on a shutdown request
+bool serveClient(SlangServer &server, int clientFd) {
+    std::string buffer, line;
+    while (readLine(clientFd, buffer, line)) {
+        llvm::StringRef command = llvm::StringRef(line).split(' ').first;
+        if (command == "shutdown") {
+            writeAll(clientFd, "ok 0\n");
+            return false;
+        } else if (command != "convert") {
+            writeAll(clientFd, "error unknown request '" + line + "'\n");
+            continue;
+        }
+
+        ConvertRequest request;
+        request.fileName = llvm::StringRef(line).split(' ').second.str();
+        bool ended = false;
+        while (readLine(clientFd, buffer, line)) {
+            if (line == "end") {
+                ended = true;
+                break;
+            }
+            llvm::StringRef item = llvm::StringRef(line).split(' ').second;
+            if (llvm::StringRef(line).startswith("arg ")) {
+                request.args.push_back(item.str());
+            } else if (llvm::StringRef(line).startswith("config ")) {
+                request.configs.push_back(
+                    std::make_pair(item.split('=').first.str(), item.split('=').second.str()));
+            }
+        }
+        if (!ended) {
+            // (the flags and options may be incomplete)
+            writeAll(clientFd, "error the request for " + request.fileName +
+                               " has no end line\n");
+            break;
+        }
+
+        std::string spanIr, error;
+        if (server.convert(request, spanIr, error)) {
+            writeAll(clientFd, "ok " + std::to_string(spanIr.size()) + "\n");
+            writeAll(clientFd, spanIr);
+        } else {
+            writeAll(clientFd, "error " + error + "\n");
+        }
+    }
+    return true;
+} // serveClient()
+
+// BOUND END  : protocol
+
+} // anonymous namespace
+
+int SlangServer::serverMain(int argc, const char **argv) {
+    if (argc != 2) {
+        llvm::errs() << "usage: " << argv[0] << " <unix socket path>\n";
+        return 1;
+    }
+    const char *socketPath = argv[1];
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (listenFd < 0 || std::strlen(socketPath) >= sizeof(address.sun_path)) {
+        llvm::errs() << "slang-server: cannot create the socket " << socketPath << "\n";
+        return 1;
+    }
+    std::strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+    unlink(socketPath); // a stale socket of an earlier run
+    if (bind(listenFd, (sockaddr *)&address, sizeof(address)) < 0 || listen(listenFd, 8) < 0) {
+        llvm::errs() << "slang-server: cannot listen on " << socketPath << ": "
+                     << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    // a client closing its socket early fails the write (EPIPE), instead
+    // of killing the server
+    signal(SIGPIPE, SIG_IGN);
+
+    SlangServer server(argv[0]);
+    bool serving = true;
+    while (serving) {
+        int clientFd = accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        serving = serveClient(server, clientFd);
+        close(clientFd);
+    }
+
+    close(listenFd);
+    unlink(socketPath);
+    return 0;
+} // serverMain()
+
+int main(int argc, const char **argv) { return SlangServer::serverMain(argc, argv); }
@@ -10,5 +10,25 @@
 # SlangCheckers/SlangTranslationUnit.cpp #AD
 # SlangCheckers/SlangExpr.cpp #AD
 # SlangCheckers/SlangUtil.cpp #AD
+# SlangCheckers/SlangIrParser.cpp #AD
+# SlangCheckers/SlangLiveness.cpp #AD
+# SlangCheckers/SlangPointsTo.cpp #AD
+# SlangCheckers/SlangCallGraph.cpp #AD
+# SlangCheckers/SlangSummaryCache.cpp #AD
+# SlangCheckers/SlangScheduler.cpp #AD
+# SlangCheckers/SlangSymbolTable.cpp #AD
+# SlangCheckers/SlangBuffer.cpp #AD
+# SlangCheckers/SlangOutputSink.cpp #AD
+# SlangCheckers/SlangChangedLines.cpp #AD
+# SlangCheckers/SlangEmbeddedPython.cpp #AD (with SLANG_EMBED_PYTHON, see its header)
+# SlangCheckers/SlangIrFile.cpp #AD
+# SlangCheckers/SlangIrLinker.cpp #AD
+# SlangCheckers/SlangTypeTable.cpp #AD
+# SlangServer/SlangServer.cpp #AD (a clang tool, see its header)
+# SlangIrCheck/SlangIrCheck.cpp #AD (a clang tool, see its header)
+# SlangIrLink/SlangIrLink.cpp #AD (a clang tool, see its header)
 
 cp -R /home/codeman/itsoflife/mydata/local/packages-live/llvm-clang8.0.1/llvm/tools/clang/lib/StaticAnalyzer/Checkers/SlangCheckers .
+cp /home/codeman/itsoflife/mydata/local/packages-live/llvm-clang8.0.1/llvm/tools/clang/tools/slang-server/SlangServer.cpp SlangServer
+cp /home/codeman/itsoflife/mydata/local/packages-live/llvm-clang8.0.1/llvm/tools/clang/tools/slang-ircheck/SlangIrCheck.cpp SlangIrCheck
+cp /home/codeman/itsoflife/mydata/local/packages-live/llvm-clang8.0.1/llvm/tools/clang/tools/slang-irlink/SlangIrLink.cpp SlangIrLink
@@ -9,5 +9,28 @@
 # SlangCheckers/SlangTranslationUnit.cpp #AD
 # SlangCheckers/SlangExpr.cpp #AD
 # SlangCheckers/SlangUtil.cpp #AD
+# SlangCheckers/SlangIrParser.cpp #AD
+# SlangCheckers/SlangLiveness.cpp #AD
+# SlangCheckers/SlangPointsTo.cpp #AD
+# SlangCheckers/SlangCallGraph.cpp #AD
+# SlangCheckers/SlangSummaryCache.cpp #AD
+# SlangCheckers/SlangScheduler.cpp #AD
+# SlangCheckers/SlangSymbolTable.cpp #AD
+# SlangCheckers/SlangBuffer.cpp #AD
+# SlangCheckers/SlangOutputSink.cpp #AD
+# SlangCheckers/SlangChangedLines.cpp #AD
+# SlangCheckers/SlangEmbeddedPython.cpp #AD (with SLANG_EMBED_PYTHON, see its header)
+# SlangCheckers/SlangIrFile.cpp #AD
+# SlangCheckers/SlangIrLinker.cpp #AD
+# SlangCheckers/SlangTypeTable.cpp #AD
+# SlangServer/SlangServer.cpp #AD (a clang tool, see its header)
+# SlangIrCheck/SlangIrCheck.cpp #AD (a clang tool, see its header)
+# SlangIrLink/SlangIrLink.cpp #AD (a clang tool, see its header)
 
 cp -R SlangCheckers /home/codeman/.itsoflife/local/packages-live/llvm-clang6/llvm/tools/clang/lib/StaticAnalyzer/Checkers
+mkdir -p /home/codeman/.itsoflife/local/packages-live/llvm-clang6/llvm/tools/clang/tools/slang-server
+cp SlangServer/SlangServer.cpp /home/codeman/.itsoflife/local/packages-live/llvm-clang6/llvm/tools/clang/tools/slang-server
+mkdir -p /home/codeman/.itsoflife/local/packages-live/llvm-clang6/llvm/tools/clang/tools/slang-ircheck
+cp SlangIrCheck/SlangIrCheck.cpp /home/codeman/.itsoflife/local/packages-live/llvm-clang6/llvm/tools/clang/tools/slang-ircheck
+mkdir -p /home/codeman/.itsoflife/local/packages-live/llvm-clang6/llvm/tools/clang/tools/slang-irlink
+cp SlangIrLink/SlangIrLink.cpp /home/codeman/.itsoflife/local/packages-live/llvm-clang6/llvm/tools/clang/tools/slang-irlink
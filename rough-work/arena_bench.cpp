@@ -0,0 +1,221 @@
+// Heap allocations and time to keep the lowered statements of a synthetic
+// TU: one std::string per statement (as before) vs the per-function
+// BumpPtrAllocator of SlangFunc (ad/SlangCheckers/SlangGenAstChecker.cpp).
+//
+// Then the same for the whole lowering of the statements, modeled on the
+// helpers of SlangGenAstChecker.cpp (convertToTmp(), createBinaryExpr(),
+// addAssignInstr(), which take and return a SlangExpr by value): each
+// statement is `x = (a + b) * (c - d)`, i.e. three SPAN IR statements and
+// ten expression texts. The text of a SlangExpr is a std::string (as
+// before) or a StringRef into the arena of the function.
+//
+// Build (from the repo root, with an llvm install):
+//   g++ -std=c++14 -O2 -Iad/SlangCheckers $(llvm-config --cxxflags) rough-work/arena_bench.cpp
+//     ad/SlangCheckers/SlangBuffer.cpp $(llvm-config --ldflags --libs support) -o arena_bench
+// Run:
+//   ./arena_bench [numFuncs] [stmtsPerFunc]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
+
+#include "SlangBuffer.h"
+
+using namespace slang;
+
+static size_t mallocCount = 0; // operator new, and the slabs of the arenas (they are malloc'ed)
+
+void *operator new(size_t size) {
+    mallocCount += 1;
+    if (void *p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+// a statement like the lowering builds, e.g. an AssignI of a BinaryE
+static void genStmt(std::string &stmt, int func, int i) {
+    stmt = "instr.AssignI(expr.VarE(\"v:f";
+    stmt += std::to_string(func);
+    stmt += ":1t\", Loc(";
+    stmt += std::to_string(i);
+    stmt += ",3)), expr.BinaryE(expr.VarE(\"v:f";
+    stmt += std::to_string(func);
+    stmt += ":x\", Loc(1,1)), op.BO_ADD, expr.LitE(1, Loc(1,1)), Loc(1,1)), Loc(1,1))";
+}
+
+struct StringFunc {
+    std::vector<std::string> spanStmts;
+    void addStmt(llvm::StringRef stmt) { spanStmts.push_back(stmt.str()); }
+    void releaseStmts() { std::vector<std::string>().swap(spanStmts); }
+    size_t getTextBytes() const {
+        size_t bytes = 0;
+        for (const std::string &stmt : spanStmts) {
+            bytes += stmt.capacity() + 1;
+        }
+        return bytes;
+    }
+};
+
+struct ArenaFunc {
+    std::unique_ptr<llvm::BumpPtrAllocator> arena{new llvm::BumpPtrAllocator()};
+    std::vector<llvm::StringRef> spanStmts;
+    void addStmt(llvm::StringRef stmt) { spanStmts.push_back(save(stmt)); }
+    llvm::StringRef save(llvm::StringRef text) { return llvm::StringSaver(*arena).save(text); }
+    void releaseStmts() {
+        mallocCount += arena->GetNumSlabs();
+        std::vector<llvm::StringRef>().swap(spanStmts);
+        arena->Reset();
+    }
+    size_t getTextBytes() const { return arena->getBytesAllocated(); }
+};
+
+template <typename FuncT>
+static void run(const char *name, int numFuncs, int stmtsPerFunc) {
+    std::vector<FuncT> funcs(numFuncs);
+    std::string stmt;
+    stmt.reserve(256);
+    size_t bytes = 0;
+
+    size_t startCount = mallocCount;
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < numFuncs; ++f) {
+        for (int i = 0; i < stmtsPerFunc; ++i) {
+            genStmt(stmt, f, i);
+            funcs[f].addStmt(stmt);
+        }
+    }
+    for (FuncT &func : funcs) { // emit
+        for (const auto &s : func.spanStmts) {
+            bytes += s.size();
+        }
+    }
+    for (FuncT &func : funcs) {
+        func.releaseStmts();
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%-12s: %8.3f s, %10zu allocations (%zu bytes of statements)\n", name, secs,
+           mallocCount - startCount, bytes);
+}
+
+// the shape of a SlangExpr
+struct StringExpr {
+    std::string expr;
+    bool compound = false;
+    std::string locStr;
+    void set(StringFunc &, llvm::StringRef text) { expr = text.str(); }
+};
+
+struct ArenaExpr {
+    llvm::StringRef expr;
+    bool compound = false;
+    std::string locStr;
+    void set(ArenaFunc &func, llvm::StringRef text) { expr = func.save(text); }
+};
+
+template <typename FuncT, typename ExprT> struct Lowering {
+    FuncT &func;
+    int funcId;
+    int tmpCount;
+
+    ExprT convertVar(const std::string &name) {
+        AppendBuffer ss;
+        ss << "expr.VarE(\"v:f" << funcId << ":" << name << "\", Loc(1,1))";
+        ExprT slangExpr;
+        slangExpr.set(func, ss.getRef());
+        slangExpr.locStr = "Loc(1,1)";
+        return slangExpr;
+    }
+
+    ExprT convertToTmp(ExprT slangExpr) {
+        if (!slangExpr.compound) {
+            return slangExpr;
+        }
+        ExprT tmpExpr = convertVar(std::to_string(++tmpCount) + "t");
+        addAssignInstr(tmpExpr, slangExpr, slangExpr.locStr);
+        return tmpExpr;
+    }
+
+    ExprT createBinaryExpr(ExprT lhsExpr, std::string op, ExprT rhsExpr, std::string locStr) {
+        lhsExpr = convertToTmp(lhsExpr);
+        rhsExpr = convertToTmp(rhsExpr);
+        AppendBuffer ss;
+        ss << "expr.BinaryE(" << lhsExpr.expr << ", " << op << ", " << rhsExpr.expr;
+        ss << ", " << locStr << ")";
+        ExprT binaryExpr;
+        binaryExpr.set(func, ss.getRef());
+        binaryExpr.compound = true;
+        binaryExpr.locStr = locStr;
+        return binaryExpr;
+    }
+
+    void addAssignInstr(ExprT &lhs, ExprT rhs, std::string locStr) {
+        if (lhs.compound && rhs.compound) {
+            rhs = convertToTmp(rhs);
+        }
+        AppendBuffer ss;
+        ss << "instr.AssignI(" << lhs.expr << ", " << rhs.expr << ", " << locStr << ")";
+        func.addStmt(ss.getRef());
+    }
+
+    // x = (a + b) * (c - d)
+    void lowerStmt() {
+        ExprT sum = createBinaryExpr(convertVar("a"), "op.BO_ADD", convertVar("b"), "Loc(2,7)");
+        ExprT diff = createBinaryExpr(convertVar("c"), "op.BO_SUB", convertVar("d"), "Loc(2,17)");
+        ExprT lhs = convertVar("x");
+        addAssignInstr(lhs, createBinaryExpr(sum, "op.BO_MUL", diff, "Loc(2,5)"), "Loc(2,3)");
+    }
+};
+
+template <typename FuncT, typename ExprT>
+static void runLowering(const char *name, int numFuncs, int stmtsPerFunc) {
+    std::vector<FuncT> funcs(numFuncs);
+    size_t bytes = 0;
+
+    size_t startCount = mallocCount;
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < numFuncs; ++f) {
+        Lowering<FuncT, ExprT> lowering{funcs[f], f, 0};
+        for (int i = 0; i < stmtsPerFunc; ++i) {
+            lowering.lowerStmt();
+        }
+    }
+    size_t textBytes = 0;
+    for (FuncT &func : funcs) { // emit
+        for (const auto &s : func.spanStmts) {
+            bytes += s.size();
+        }
+        textBytes += func.getTextBytes();
+    }
+    for (FuncT &func : funcs) {
+        func.releaseStmts();
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%-12s: %8.3f s, %10zu allocations (%zu bytes of statements, %zu bytes of text kept)\n",
+           name, secs, mallocCount - startCount, bytes, textBytes);
+}
+
+int main(int argc, char **argv) {
+    int numFuncs = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int stmtsPerFunc = argc > 2 ? std::atoi(argv[2]) : 500;
+
+    run<StringFunc>("std::string", numFuncs, stmtsPerFunc);
+    run<ArenaFunc>("arena", numFuncs, stmtsPerFunc);
+
+    printf("lowering:\n");
+    runLowering<StringFunc, StringExpr>("std::string", numFuncs, stmtsPerFunc);
+    runLowering<ArenaFunc, ArenaExpr>("arena", numFuncs, stmtsPerFunc);
+    return 0;
+}
@@ -0,0 +1,213 @@
+// Lookup throughput and memory of the lowering's maps on a TU with many
+// variables (the varMap) and functions (the funcMap): std::unordered_map,
+// the former DeclMap (an llvm::DenseMap of the values) and StableDeclMap
+// (a deque of the values and a DenseMap index), and the DeclMap of
+// ad/SlangCheckers/SlangDeclMap.h.
+//
+// Build (from the repo root, with an llvm install):
+//   g++ -std=c++14 -O2 -Iad/SlangCheckers $(llvm-config --cxxflags) rough-work/declmap_bench.cpp
+//     $(llvm-config --ldflags --libs support) -o declmap_bench
+// Run:
+//   ./declmap_bench [numVars] [numFuncs] [lookupsPerEntry]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include "SlangDeclMap.h"
+
+using namespace slang;
+
+// the shape of a SlangVar
+struct Var {
+    uint64_t id;
+    uint32_t nameId;
+    std::string typeStr;
+    bool internal;
+
+    uint32_t getKey() const { return nameId; }
+};
+
+// the shape of a SlangFunc
+struct Func {
+    std::string name, fullName, retType;
+    std::vector<uint32_t> paramNameIds;
+    bool variadic;
+    std::string funcSig;
+    std::set<std::string> callees, indirectCallSigs;
+    uint32_t tmpVarCount, labelCount;
+    const void *lastDeclStmt;
+    bool usesAnonymousRecord, inHeader, lowered;
+    uint32_t line, col;
+    std::unique_ptr<int> arena;
+    std::vector<llvm::StringRef> spanStmts;
+
+    uint32_t getKey() const { return line; }
+};
+
+static size_t allocatedBytes = 0;
+
+template <typename T> struct CountingAllocator {
+    typedef T value_type;
+    CountingAllocator() {}
+    template <typename U> CountingAllocator(const CountingAllocator<U> &) {}
+    T *allocate(size_t n) {
+        allocatedBytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T *p, size_t n) {
+        allocatedBytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+    template <typename U> bool operator==(const CountingAllocator<U> &) const { return true; }
+    template <typename U> bool operator!=(const CountingAllocator<U> &) const { return false; }
+};
+
+template <typename ValueT>
+using NodeMap = std::unordered_map<uint64_t, ValueT, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                                   CountingAllocator<std::pair<const uint64_t, ValueT>>>;
+
+// the former DeclMap and StableDeclMap
+struct DeclKeyInfo {
+    static inline uint64_t getEmptyKey() { return ~0ULL; }
+    static inline uint64_t getTombstoneKey() { return ~0ULL - 1; }
+    static unsigned getHashValue(uint64_t key) {
+        return (unsigned)((key * 0x9E3779B97F4A7C15ULL) >> 32);
+    }
+    static bool isEqual(uint64_t lhs, uint64_t rhs) { return lhs == rhs; }
+};
+
+template <typename ValueT> using DenseDeclMap = llvm::DenseMap<uint64_t, ValueT, DeclKeyInfo>;
+
+template <typename ValueT> class StableDeclMap {
+  public:
+    ValueT &operator[](uint64_t key) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            return entries[it->second].second;
+        }
+        index[key] = (uint32_t)entries.size();
+        entries.emplace_back(key, ValueT());
+        return entries.back().second;
+    }
+    size_t getMemorySize() const {
+        return entries.size() * sizeof(std::pair<uint64_t, ValueT>) + index.getMemorySize();
+    }
+
+  private:
+    std::deque<std::pair<uint64_t, ValueT>> entries;
+    DenseDeclMap<uint32_t> index;
+};
+
+// keys like Decl addresses: 16 byte aligned, of varying sizes, in a few slabs
+static std::vector<uint64_t> makeKeys(size_t count, std::mt19937_64 &rng) {
+    std::vector<uint64_t> keys;
+    uint64_t addr = 0x55d0c0a01000ULL;
+    for (size_t i = 0; i < count; ++i) {
+        addr += 16 * (4 + rng() % 8);
+        if (rng() % 1000 == 0) {
+            addr += 1 << 20; // a new slab
+        }
+        keys.push_back(addr);
+    }
+    return keys;
+}
+
+template <typename MapT>
+static void fill(MapT &map, const std::vector<uint64_t> &keys) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto &value = map[keys[i]];
+        value.nameId = (uint32_t)i;
+        value.typeStr = "types.Int32";
+    }
+}
+
+template <typename MapT>
+static void fillFuncs(MapT &map, const std::vector<uint64_t> &keys) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto &value = map[keys[i]];
+        value.line = (uint32_t)i;
+        value.name = "func" + std::to_string(i);
+    }
+}
+
+// @return the best of 3 runs, in M lookups/s
+template <typename MapT>
+static double timeLookups(MapT &map, const std::vector<uint64_t> &probes, uint64_t &checksum) {
+    double best = 0;
+    for (int run = 0; run < 3; ++run) {
+        checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t key : probes) {
+            checksum += map[key].getKey(); // all the keys are present
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::max(best, probes.size() / secs / 1e6);
+    }
+    return best;
+}
+
+static void printRow(const char *name, double mLookups, size_t bytes) {
+    printf("  %-28s %7.1f M lookups/s %7.2f MB\n", name, mLookups, bytes / (1024.0 * 1024.0));
+}
+
+template <typename ValueT, typename FillT>
+static void bench(const char *what, size_t numEntries, size_t lookupsPerEntry, FillT fillMap,
+                  bool withDense) {
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> keys = makeKeys(numEntries, rng);
+    std::vector<uint64_t> probes;
+    for (size_t i = 0; i < numEntries * lookupsPerEntry; ++i) {
+        probes.push_back(keys[rng() % numEntries]);
+    }
+    printf("%zu %s, %zu lookups\n", numEntries, what, probes.size());
+
+    uint64_t checksum1 = 0, checksum2 = 0, checksum3 = 0;
+    {
+        allocatedBytes = 0;
+        NodeMap<ValueT> map;
+        fillMap(map, keys);
+        size_t bytes = allocatedBytes;
+        printRow("std::unordered_map", timeLookups(map, probes, checksum1), bytes);
+    }
+    if (withDense) {
+        DenseDeclMap<ValueT> map;
+        fillMap(map, keys);
+        printRow("llvm::DenseMap (former)", timeLookups(map, probes, checksum2),
+                 map.getMemorySize());
+    } else {
+        StableDeclMap<ValueT> map;
+        fillMap(map, keys);
+        printRow("StableDeclMap (former)", timeLookups(map, probes, checksum2),
+                 map.getMemorySize());
+    }
+    {
+        DeclMap<ValueT> map;
+        fillMap(map, keys);
+        printRow("DeclMap", timeLookups(map, probes, checksum3), map.getMemorySize());
+    }
+    printf("  %s\n", checksum1 == checksum2 && checksum1 == checksum3 ? "same results"
+                                                                      : "RESULTS DIFFER");
+}
+
+int main(int argc, char **argv) {
+    size_t numVars = argc > 1 ? (size_t)std::atoll(argv[1]) : 100000;
+    size_t numFuncs = argc > 2 ? (size_t)std::atoll(argv[2]) : 5000;
+    size_t lookupsPerEntry = argc > 3 ? (size_t)std::atoll(argv[3]) : 20;
+
+    bench<Var>("vars", numVars, lookupsPerEntry,
+               [](auto &map, const std::vector<uint64_t> &keys) { fill(map, keys); }, true);
+    bench<Func>("funcs", numFuncs, lookupsPerEntry,
+                [](auto &map, const std::vector<uint64_t> &keys) { fillFuncs(map, keys); }, false);
+    return 0;
+}
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+
+# Time of the native points-to analysis (slang-ircheck -points-to, see
+# ad/SlangCheckers/SlangPointsTo.h) and of the naive python solver of
+# spanir/tests/test_pointsto.py, on the synthetic IR of makeSyntheticIr()
+# with more and more functions. Checks that both give the same sets.
+#
+# The total of the native analysis is that of slang-ircheck (it parses the
+# file, and prints the result); the total of the python one is that of
+# loading the file (without TranslationUnit.preProcess()), generating the
+# constraints and solving them.
+#
+# Run (from the repo root):
+#   SLANG_IRCHECK=path/to/slang-ircheck python3 rough-work/pointsto_bench.py [numFuncs...]
+
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "spanir",
+                                "tests"))
+
+import test_pointsto
+
+
+def main():
+  sizes = [int(arg) for arg in sys.argv[1:]] or [1000, 4000, 16000]
+  print(f"{'functions':>9} {'MB':>6} {'native s':>9} {'(solve s)':>9}"
+        f" {'python s':>9} {'(solve s)':>9}")
+  for numFuncs in sizes:
+    with tempfile.TemporaryDirectory() as tmpDir:
+      fileName = os.path.join(tmpDir, "synthetic.c.spanir")
+      with open(fileName, "w") as f:
+        f.write(test_pointsto.makeSyntheticIr(numFuncs))
+
+      start = time.perf_counter()
+      subprocess.run([test_pointsto.IRCHECK, "-points-to", fileName], check=True,
+                     stdout=subprocess.DEVNULL)
+      nativeSecs = time.perf_counter() - start
+      nativePointsTo, stats = test_pointsto.getNativePointsTo(fileName)
+      nativeSolveSecs = float(re.search(r"\+ ([0-9.]+) s\)", stats).group(1))
+
+      start = time.perf_counter()
+      refPointsTo = test_pointsto.RefPointsTo(test_pointsto.loadTUnitArgs(fileName))
+      solveStart = time.perf_counter()
+      refPointsTo.solve()
+      pointsTo = refPointsTo.getPointsTo()
+      end = time.perf_counter()
+
+      if pointsTo != nativePointsTo:
+        print(f"{numFuncs}: the results differ")
+      print(f"{numFuncs:>9} {os.path.getsize(fileName) / 2**20:>6.1f} {nativeSecs:>9.3f}"
+            f" {nativeSolveSecs:>9.3f} {end - start:>9.3f} {end - solveStart:>9.3f}")
+
+
+if __name__ == "__main__":
+  main()
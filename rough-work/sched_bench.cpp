@@ -0,0 +1,98 @@
+// Throughput of the work stealing TaskScheduler (ad/SlangCheckers/SlangScheduler.h)
+// running the native liveness analysis on each function of a large generated TU.
+//
+// Build (from the repo root):
+//   g++ -std=c++11 -O2 -pthread -Iad/SlangCheckers $(llvm-config --cxxflags) rough-work/sched_bench.cpp
+//     ad/SlangCheckers/SlangScheduler.cpp ad/SlangCheckers/SlangLiveness.cpp
+//     ad/SlangCheckers/SlangIrParser.cpp -o sched_bench
+// Run:
+//   ./sched_bench [numFuncs] [maxThreads]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "SlangLiveness.h"
+#include "SlangScheduler.h"
+
+using namespace slang;
+
+// a function with loops over a few locals; sizes vary a lot, like real code
+static std::vector<std::string> genFunction(int id, std::mt19937 &rng) {
+    std::vector<std::string> instrs;
+    std::string func = "f" + std::to_string(id);
+    int size = 20 + (int)(rng() % 20) * (int)(rng() % 50);
+    int vars = 4 + (int)(rng() % 28);
+
+    auto var = [&](int v) {
+        return "expr.VarE(\"v:" + func + ":x" + std::to_string(v) + "\", Loc(1,1))";
+    };
+    for (int i = 0; i < size; ++i) {
+        std::stringstream ss;
+        int kind = (int)(rng() % 10);
+        if (kind < 7) {
+            ss << "instr.AssignI(" << var((int)(rng() % vars)) << ", expr.BinaryE("
+               << var((int)(rng() % vars)) << ", op.BO_ADD, " << var((int)(rng() % vars))
+               << ", Loc(1,1)), Loc(" << i + 1 << ",3))";
+        } else if (kind < 9) {
+            ss << "instr.LabelI(\"L" << i << "\")";
+        } else {
+            int target = (int)(rng() % (i + 1));
+            ss << "instr.CondI(" << var((int)(rng() % vars)) << ", \"L" << i << "\", \"E" << i
+               << "\", Loc(1,1))";
+            instrs.push_back(ss.str());
+            instrs.push_back("instr.LabelI(\"L" + std::to_string(i) + "\")");
+            instrs.push_back("instr.GotoI(\"B" + std::to_string(target) + "\")");
+            instrs.push_back("instr.LabelI(\"B" + std::to_string(target) + "\")");
+            ss.str("");
+            ss << "instr.LabelI(\"E" << i << "\")";
+        }
+        instrs.push_back(ss.str());
+    }
+    instrs.push_back("instr.ReturnI(" + var(0) + ", Loc(1,1))");
+    return instrs;
+}
+
+int main(int argc, char **argv) {
+    int numFuncs = argc > 1 ? std::atoi(argv[1]) : 4000;
+    int maxThreads = argc > 2 ? std::atoi(argv[2]) : 64;
+
+    std::mt19937 rng(42);
+    std::vector<std::vector<std::string>> funcs;
+    std::vector<std::vector<llvm::StringRef>> instrSeqs(numFuncs);
+    std::vector<uint64_t> costs;
+    for (int i = 0; i < numFuncs; ++i) {
+        funcs.push_back(genFunction(i, rng));
+        costs.push_back(funcs.back().size());
+    }
+    for (int i = 0; i < numFuncs; ++i) {
+        instrSeqs[i].assign(funcs[i].begin(), funcs[i].end());
+    }
+
+    std::vector<size_t> expected; // dead store counts with 1 thread
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        std::vector<size_t> results(funcs.size());
+        TaskScheduler scheduler((uint32_t)threads);
+
+        auto start = std::chrono::steady_clock::now();
+        scheduler.run(costs, [&](size_t i) {
+            LivenessAnalysis liveness;
+            liveness.analyze("f" + std::to_string(i), instrSeqs[i]);
+            results[i] = liveness.getDeadStores().size();
+        });
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                          .count();
+
+        if (threads == 1) {
+            expected = results;
+        }
+        printf("threads %2d: %8.3f s, %10.1f funcs/s, steals %6llu, %s\n", threads, secs,
+               numFuncs / secs, (unsigned long long)scheduler.getStealCount(),
+               results == expected ? "same results" : "RESULTS DIFFER");
+    }
+    return 0;
+}
@@ -0,0 +1,421 @@
+// Total bytes and time of the emission of the SPAN IR of a synthetic
+// multi-TU build: in full (each TU with the functions and the records of
+// the headers it includes), and with the checker option SharedIrDir, where
+// those are written once to the store by emitShared() and storeShared() of
+// ad/SlangCheckers/SlangGenAstChecker.cpp (the same SummaryCache calls and
+// the same text; the TUs refer to them in sharedConstructs).
+//
+// The build has numTUs TUs, each with funcsPerTU functions of its own,
+// including headersPerTU of numHeaders headers. A header defines
+// inlinesPerHeader static inline functions and recordsPerHeader structs.
+// The time is that of the emission alone (the text, the hashes, the store
+// and the writes of the files), as the lowering is the same either way. The
+// types are written in full (as with TypeTable=false). Each mode is built
+// twice: the second time (e.g. after a touch of all the files) the entries
+// are already in the store.
+//
+// The IR is real: the two forms link to the same program,
+//   slang-irlink -o full.spanprog OUTDIR/full/*.spanir
+//   slang-irlink -shared OUTDIR/store -o shared.spanprog OUTDIR/shared/*.spanir
+//
+// Build (from the repo root, with an llvm install):
+//   g++ -std=c++14 -O2 -Iad/SlangCheckers $(llvm-config --cxxflags) rough-work/shared_ir_bench.cpp
+//     ad/SlangCheckers/SlangSummaryCache.cpp ad/SlangCheckers/SlangUtil.cpp
+//     ad/SlangCheckers/SlangBuffer.cpp $(llvm-config --ldflags --libs support) -o shared_ir_bench
+// Run:
+//   ./shared_ir_bench OUTDIR [numTUs] [numHeaders] [headersPerTU] [inlinesPerHeader]
+//     [recordsPerHeader] [funcsPerTU]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/FileSystem.h"
+
+#include "SlangBuffer.h"
+#include "SlangSummaryCache.h"
+#include "SlangUtil.h"
+
+#define NBSP2 "  "
+#define NBSP4 NBSP2 NBSP2
+#define NBSP6 NBSP2 NBSP4
+#define NBSP8 NBSP4 NBSP4
+#define NBSP12 NBSP8 NBSP4
+
+using namespace slang;
+
+// a lowered function, as the checker keeps it (SlangFunc)
+struct Func {
+    std::string name; // e.g. "f:h3_inl7"
+    std::vector<std::string> paramNames;
+    std::vector<std::pair<std::string, std::string>> locals; // (name, type), sorted
+    std::vector<std::string> stmts;
+    std::set<std::string> callees;
+    std::string irHash;
+};
+
+struct Header {
+    std::vector<Func> inlines;
+    std::vector<std::string> recordNames;
+    std::vector<std::string> records; // the text of each, as SlangRecord::toString()
+};
+
+struct Tu {
+    std::string fileName;
+    std::vector<size_t> headers; // included
+    std::vector<Func> funcs;     // its own
+};
+
+// a function of numStmts statements, calling the given functions
+static Func makeFunc(const std::string &name, size_t numStmts, const std::string &record,
+                     const std::vector<const Func *> &calls) {
+    Func func;
+    func.name = "f:" + name;
+    std::string prefix = "v:" + name + ":";
+    std::string recordPtr = "types.Ptr(to=types.Struct(\"" + record + "\"))";
+    func.paramNames = {prefix + "n", prefix + "p"};
+    std::map<std::string, std::string> locals = {{prefix + "n", "types.Int32"},
+                                                 {prefix + "p", recordPtr},
+                                                 {prefix + "a", "types.Int32"},
+                                                 {prefix + "vp", "types.Ptr(to=types.Void)"}};
+    auto var = [&](const std::string &local, size_t line, size_t col) {
+        return "expr.VarE(\"" + prefix + local + "\", Loc(" + std::to_string(line) + "," +
+               std::to_string(col) + "))";
+    };
+    auto loc = [](size_t line, size_t col) {
+        return "Loc(" + std::to_string(line) + "," + std::to_string(col) + ")";
+    };
+
+    size_t nextCall = 0;
+    for (size_t i = 0; i + 1 < numStmts; ++i) {
+        size_t line = 10 + i;
+        std::string tmp = std::to_string(i + 1) + "t";
+        switch (i % 4) {
+        case 0:
+            func.stmts.push_back("instr.AssignI(" + var("a", line, 3) + ", expr.BinaryE(" +
+                                 var("a", line, 7) + ", op.BO_ADD, expr.LitE(" +
+                                 std::to_string(i) + ", " + loc(line, 11) + "), " +
+                                 loc(line, 7) + "), " + loc(line, 3) + ")");
+            break;
+        case 1:
+            func.stmts.push_back("instr.AssignI(expr.MemberE(\"val\", " + var("p", line, 3) +
+                                 ", " + loc(line, 3) + "), " + var("a", line, 12) + ", " +
+                                 loc(line, 3) + ")");
+            break;
+        case 2:
+            locals[prefix + tmp] = recordPtr;
+            func.stmts.push_back("instr.AssignI(" + var(tmp, line, 7) + ", expr.CastE(" +
+                                 var("vp", line, 7) + ", op.CastOp(" + recordPtr + "), " +
+                                 loc(line, 7) + "), " + loc(line, 7) + ")");
+            break;
+        default:
+            if (nextCall < calls.size()) {
+                const Func &callee = *calls[nextCall++];
+                func.callees.insert(callee.name);
+                locals[prefix + tmp] = "types.Int32";
+                func.stmts.push_back("instr.AssignI(" + var(tmp, line, 7) +
+                                     ", expr.CallE(expr.FuncE(\"" + callee.name + "\", " +
+                                     loc(line, 7) + "), [" + var("a", line, 12) + ", " +
+                                     var("p", line, 15) + "], " + loc(line, 7) + "), " +
+                                     loc(line, 7) + ")");
+            } else {
+                func.stmts.push_back("instr.AssignI(" + var("n", line, 3) + ", " +
+                                     var("a", line, 7) + ", " + loc(line, 3) + ")");
+            }
+        }
+    }
+    func.stmts.push_back("instr.ReturnI(" + var("a", 10 + numStmts, 10) + ", " +
+                         loc(10 + numStmts, 3) + ")");
+    func.locals.assign(locals.begin(), locals.end());
+
+    std::string text;
+    for (const std::string &stmt : func.stmts) {
+        text += stmt + "\n";
+    }
+    func.irHash = SummaryCache::hashText(text).substr(0, 16);
+    return func;
+}
+
+static std::string makeRecord(const std::string &name) {
+    AppendBuffer ss;
+    ss << NBSP6 << "types.Struct(\n";
+    ss << NBSP8 << "name = \"" << name << "\",\n";
+    ss << NBSP8 << "members = [\n";
+    ss << NBSP8 << NBSP2 << "(\"val\", types.Int32),\n";
+    for (const char *member : {"size", "count", "flags", "mode"}) {
+        ss << NBSP8 << NBSP2 << "(\"" << member << "\", types.UInt64),\n";
+    }
+    ss << NBSP8 << NBSP2 << "(\"data\", types.Ptr(to=types.Void)),\n";
+    ss << NBSP8 << NBSP2 << "(\"next\", types.Ptr(to=types.Struct(\"" << name << "\"))),\n";
+    ss << NBSP8 << "],\n";
+    ss << NBSP8 << "loc = Loc(3,1),\n";
+    ss << NBSP6 << ")";
+    return ss.str();
+}
+
+// as dumpHeader() and dumpFooter() of the checker
+static void dumpHeader(const std::string &name, const char *description, AppendBuffer &ss) {
+    ss << "\n# START: A_SPAN_translation_unit.\n\n";
+    ss << "# An instance of span.ir.tunit.TranslationUnit class.\n";
+    ss << "tunit.TranslationUnit(\n";
+    ss << NBSP2 << "name = \"" << name << "\",\n";
+    ss << NBSP2 << "description = \"" << description << "\",\n";
+}
+
+static void dumpFooter(AppendBuffer &ss) {
+    ss << ") # tunit.TranslationUnit() ends\n";
+    ss << "\n# END  : A_SPAN_translation_unit.\n";
+}
+
+// as dumpFunction() of the checker
+static void dumpFunction(const Func &func, AppendBuffer &ss) {
+    ss << NBSP4 << "\"" << func.name << "\":\n";
+    ss << NBSP6 << "constructs.Func(\n";
+    ss << NBSP8 << "name = \"" << func.name << "\",\n";
+    ss << NBSP8 << "paramNames = [";
+    for (size_t i = 0; i < func.paramNames.size(); ++i) {
+        ss << (i ? ", " : "") << "\"" << func.paramNames[i] << "\"";
+    }
+    ss << "],\n";
+    ss << NBSP8 << "variadic = False,\n";
+    ss << NBSP8 << "returnType = types.Int32,\n";
+    ss << NBSP8 << "irHash = \"" << func.irHash << "\",\n\n";
+    ss << NBSP8 << "# Note: -1 is always start/entry BB. (REQUIRED)\n";
+    ss << NBSP8 << "# Note: 0 is always end/exit BB (REQUIRED)\n";
+    ss << NBSP8 << "instrSeq = [\n";
+    for (const std::string &stmt : func.stmts) {
+        ss << NBSP12 << stmt << ",\n";
+    }
+    ss << NBSP8 << "], # instrSeq end.\n";
+    ss << NBSP6 << "), # " << func.name << "() end. \n\n";
+}
+
+static void dumpLocals(const Func &func, AppendBuffer &ss) {
+    for (auto &local : func.locals) {
+        ss << NBSP4 << "\"" << local.first << "\": " << local.second << ",\n";
+    }
+}
+
+// as storeShared() of the checker
+static bool storeShared(const std::string &storeDir, const std::string &name,
+                        const std::string &text, std::map<std::string, std::string> &sharedRefs) {
+    std::string hash = SummaryCache::hashText(text);
+    SummaryCache store(storeDir);
+    if (!llvm::sys::fs::exists(store.getEntryPath(SHARED_IR_CACHE_ID, hash)) &&
+        !store.store(SHARED_IR_CACHE_ID, hash, text)) {
+        return false;
+    }
+    sharedRefs[name] = hash;
+    return true;
+}
+
+// writes the IR of a TU, the constructs of its headers in full, or to the
+// store (if storeDir is not "")
+static bool emitTu(const Tu &tu, const std::vector<Header> &headers, const std::string &outDir,
+                   const std::string &storeDir) {
+    std::vector<const Func *> funcs; // all, for the variables and the call graph
+    std::map<std::string, std::string> sharedRefs;
+    AppendBuffer ss;
+    dumpHeader(tu.fileName, "Auto-Translated from Clang AST.", ss);
+    ss << NBSP2 << "allConstructs = {\n";
+    for (size_t h : tu.headers) {
+        for (size_t r = 0; r < headers[h].records.size(); ++r) {
+            const std::string &name = headers[h].recordNames[r];
+            if (!storeDir.empty()) { // as emitShared(SlangRecord &)
+                AppendBuffer entry;
+                dumpHeader("shared:" + name, "Shared by the translation units (see SharedIrDir).",
+                           entry);
+                entry << NBSP2 << "allConstructs = {\n";
+                entry << NBSP4 << "\"" << name << "\":\n" << headers[h].records[r] << ",\n";
+                entry << NBSP2 << "}, # end allConstructs dict\n";
+                dumpFooter(entry);
+                if (!storeShared(storeDir, name, entry.str(), sharedRefs)) {
+                    return false;
+                }
+                continue;
+            }
+            ss << NBSP4 << "\"" << name << "\":\n" << headers[h].records[r] << ",\n\n";
+        }
+    }
+    for (size_t h : tu.headers) {
+        for (const Func &func : headers[h].inlines) {
+            funcs.push_back(&func);
+            if (!storeDir.empty()) { // as emitShared(const SlangFunc &)
+                AppendBuffer entry;
+                dumpHeader("shared:" + func.name,
+                           "Shared by the translation units (see SharedIrDir).", entry);
+                entry << NBSP2 << "allConstructs = {\n";
+                dumpFunction(func, entry);
+                entry << NBSP2 << "}, # end allConstructs dict\n\n";
+                entry << NBSP2 << "allVars = {\n";
+                dumpLocals(func, entry);
+                entry << NBSP2 << "}, # end allVars dict\n";
+                dumpFooter(entry);
+                if (!storeShared(storeDir, func.name, entry.str(), sharedRefs)) {
+                    return false;
+                }
+                continue;
+            }
+            dumpFunction(func, ss);
+        }
+    }
+    for (const Func &func : tu.funcs) {
+        funcs.push_back(&func);
+        dumpFunction(func, ss);
+    }
+    ss << NBSP2 << "}, # end allConstructs dict\n\n";
+
+    ss << NBSP2 << "allVars = {\n";
+    for (const Func *func : funcs) {
+        if (!sharedRefs.count(func->name)) {
+            dumpLocals(*func, ss);
+        }
+    }
+    ss << NBSP2 << "}, # end allVars dict\n\n";
+
+    if (!sharedRefs.empty()) {
+        ss << NBSP2 << "# name -> hash, in the SharedIrDir (see SlangSummaryCache.h)\n";
+        ss << NBSP2 << "sharedConstructs = {\n";
+        for (auto &sharedRef : sharedRefs) {
+            ss << NBSP4 << "\"" << sharedRef.first << "\": \"" << sharedRef.second << "\",\n";
+        }
+        ss << NBSP2 << "}, # end sharedConstructs dict\n\n";
+    }
+
+    ss << NBSP2 << "callGraph = {\n";
+    for (const Func *func : funcs) {
+        ss << NBSP4 << "\"" << func->name << "\": [";
+        const char *sep = "";
+        for (const std::string &callee : func->callees) {
+            ss << sep << "\"" << callee << "\"";
+            sep = ", ";
+        }
+        ss << "],\n";
+    }
+    ss << NBSP2 << "}, # end callGraph dict\n\n";
+    ss << NBSP2 << "callGraphSccs = [], # end callGraphSccs list\n\n";
+    ss << NBSP2 << "typeLayouts = {}, # end typeLayouts dict\n\n";
+    dumpFooter(ss);
+
+    return Util::writeToFile(outDir + "/" + tu.fileName + ".spanir", ss.getRef()) != 0;
+}
+
+// the bytes and files of a directory tree
+static uint64_t getTreeBytes(const std::string &dir, size_t &files) {
+    uint64_t bytes = 0;
+    std::error_code ec;
+    for (llvm::sys::fs::recursive_directory_iterator it(dir, ec), end; it != end && !ec;
+         it.increment(ec)) {
+        llvm::sys::fs::file_status status;
+        if (!llvm::sys::fs::status(it->path(), status) &&
+            status.type() == llvm::sys::fs::file_type::regular_file) {
+            bytes += status.getSize();
+            files += 1;
+        }
+    }
+    return bytes;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s OUTDIR [numTUs] [numHeaders] [headersPerTU]"
+                        " [inlinesPerHeader] [recordsPerHeader] [funcsPerTU]\n", argv[0]);
+        return 1;
+    }
+    std::string outDir = argv[1];
+    size_t numTus = argc > 2 ? (size_t)std::atoll(argv[2]) : 200;
+    size_t numHeaders = argc > 3 ? (size_t)std::atoll(argv[3]) : 30;
+    size_t headersPerTu = argc > 4 ? (size_t)std::atoll(argv[4]) : 8;
+    size_t inlinesPerHeader = argc > 5 ? (size_t)std::atoll(argv[5]) : 10;
+    size_t recordsPerHeader = argc > 6 ? (size_t)std::atoll(argv[6]) : 4;
+    size_t funcsPerTu = argc > 7 ? (size_t)std::atoll(argv[7]) : 25;
+    const size_t inlineStmts = 12, funcStmts = 30;
+
+    std::mt19937_64 rng(42);
+    std::vector<Header> headers(numHeaders);
+    for (size_t h = 0; h < numHeaders; ++h) {
+        Header &header = headers[h];
+        for (size_t r = 0; r < recordsPerHeader; ++r) {
+            header.recordNames.push_back("s:h" + std::to_string(h) + "_rec" + std::to_string(r));
+            header.records.push_back(makeRecord(header.recordNames.back()));
+        }
+        header.inlines.reserve(inlinesPerHeader);
+        for (size_t i = 0; i < inlinesPerHeader; ++i) {
+            std::vector<const Func *> calls;
+            if (i > 0) {
+                calls.push_back(&header.inlines[rng() % i]);
+            }
+            header.inlines.push_back(makeFunc("h" + std::to_string(h) + "_inl" + std::to_string(i),
+                                              inlineStmts,
+                                              header.recordNames[i % recordsPerHeader], calls));
+        }
+    }
+
+    std::vector<Tu> tus(numTus);
+    uint64_t headerStmts = 0, ownStmts = 0;
+    for (size_t t = 0; t < numTus; ++t) {
+        Tu &tu = tus[t];
+        tu.fileName = "m" + std::to_string(t) + ".c";
+        std::set<size_t> included;
+        while (included.size() < std::min(headersPerTu, numHeaders)) {
+            included.insert(rng() % numHeaders);
+        }
+        tu.headers.assign(included.begin(), included.end());
+        tu.funcs.reserve(funcsPerTu);
+        for (size_t f = 0; f < funcsPerTu; ++f) {
+            std::vector<const Func *> calls;
+            for (size_t c = 0; c < 4; ++c) {
+                const Header &header = headers[tu.headers[rng() % tu.headers.size()]];
+                calls.push_back(&header.inlines[rng() % header.inlines.size()]);
+            }
+            if (f > 0) {
+                calls.push_back(&tu.funcs[f - 1]);
+            }
+            size_t h = tu.headers[f % tu.headers.size()];
+            tu.funcs.push_back(makeFunc("m" + std::to_string(t) + "_func" + std::to_string(f),
+                                        funcStmts, headers[h].recordNames[0], calls));
+            ownStmts += funcStmts;
+        }
+        headerStmts += tu.headers.size() * inlinesPerHeader * inlineStmts;
+    }
+    printf("%zu TUs, %zu functions each, %zu of %zu headers each (%zu inline functions and"
+           " %zu records a header): %.0f%% of the statements in the headers\n",
+           numTus, funcsPerTu, headersPerTu, numHeaders, inlinesPerHeader, recordsPerHeader,
+           100.0 * headerStmts / (headerStmts + ownStmts));
+
+    for (const char *mode : {"full", "shared"}) {
+        std::string tuDir = outDir + "/" + mode;
+        std::string storeDir = std::string(mode) == "shared" ? outDir + "/store" : "";
+        llvm::sys::fs::remove_directories(tuDir);
+        llvm::sys::fs::create_directories(tuDir);
+        if (!storeDir.empty()) {
+            llvm::sys::fs::remove_directories(storeDir);
+        }
+        for (const char *build : {"first build", "rebuild"}) {
+            auto start = std::chrono::steady_clock::now();
+            for (const Tu &tu : tus) {
+                if (!emitTu(tu, headers, tuDir, storeDir)) {
+                    fprintf(stderr, "%s: cannot write %s\n", mode, tu.fileName.c_str());
+                    return 1;
+                }
+            }
+            double seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            size_t tuFiles = 0, storeFiles = 0;
+            uint64_t tuBytes = getTreeBytes(tuDir, tuFiles);
+            uint64_t storeBytes = storeDir.empty() ? 0 : getTreeBytes(storeDir, storeFiles);
+            printf("  %-6s %-11s %7.3f s, %8.2f MB = %8.2f MB in %zu TUs + %6.2f MB in %zu"
+                   " entries\n",
+                   mode, build, seconds, (tuBytes + storeBytes) / (1024.0 * 1024.0),
+                   tuBytes / (1024.0 * 1024.0), tuFiles, storeBytes / (1024.0 * 1024.0),
+                   storeFiles);
+        }
+    }
+    return 0;
+}
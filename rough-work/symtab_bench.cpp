@@ -0,0 +1,246 @@
+// Time and memory of the variable names of the lowering on a large
+// synthetic TU: a std::string name per SlangVar, built again at every
+// reference (as before), vs the SymbolTable of
+// ad/SlangCheckers/SlangSymbolTable.h, where a SlangVar keeps a SymbolId and
+// the text of its name is materialized once, at its first reference.
+//
+// The TU has numFuncs functions with localsPerFunc locals each (their
+// names drawn from a pool of common names, as in real code) and numGlobals
+// globals. Each local is referenced refsPerVar times by the statements of
+// its function, and each function references a few globals. The phases:
+//   declare: name each variable (and check varCountMap for a clash),
+//   lower  : append the name of every reference to the text of a statement.
+// The bytes are those still allocated after the lowering (the varMap with
+// its names, the varCountMap, the SymbolTable).
+//
+// Build (from the repo root, with an llvm install):
+//   g++ -std=c++14 -O2 -Iad/SlangCheckers $(llvm-config --cxxflags) rough-work/symtab_bench.cpp
+//     ad/SlangCheckers/SlangSymbolTable.cpp ad/SlangCheckers/SlangBuffer.cpp
+//     $(llvm-config --ldflags --libs support) -o symtab_bench
+// Run:
+//   ./symtab_bench [numFuncs] [localsPerFunc] [refsPerVar] [numGlobals]
+
+#include <malloc.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+
+#include "SlangBuffer.h"
+#include "SlangDeclMap.h"
+#include "SlangSymbolTable.h"
+
+using namespace slang;
+
+static size_t liveBytes = 0; // of operator new
+
+void *operator new(size_t size) {
+    if (void *p = std::malloc(size)) {
+        liveBytes += malloc_usable_size(p);
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept {
+    liveBytes -= malloc_usable_size(p);
+    std::free(p);
+}
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
+// the variables of the synthetic TU, as the lowering meets them
+struct Tu {
+    std::vector<std::string> funcNames;
+    std::vector<std::string> localNames; // localsPerFunc per function
+    std::vector<std::string> globalNames;
+    std::vector<uint64_t> localKeys, globalKeys; // like Decl addresses
+    std::vector<uint64_t> refs;                  // the references, in lowering order
+};
+
+static Tu makeTu(size_t numFuncs, size_t localsPerFunc, size_t refsPerVar, size_t numGlobals) {
+    static const char *common[] = {"i",   "j",    "k",     "n",   "p",    "q",     "len",
+                                   "buf", "ptr",  "tmp",   "ret", "err",  "node",  "next",
+                                   "ctx", "size", "count", "idx", "data", "result"};
+    std::mt19937_64 rng(42);
+    Tu tu;
+    uint64_t addr = 0x55d0c0a01000ULL;
+    for (size_t g = 0; g < numGlobals; ++g) {
+        tu.globalNames.push_back("g_config_entry_" + std::to_string(g));
+        tu.globalKeys.push_back(addr += 16 * (4 + rng() % 8));
+    }
+    for (size_t f = 0; f < numFuncs; ++f) {
+        tu.funcNames.push_back("module_handle_request_" + std::to_string(f));
+        for (size_t l = 0; l < localsPerFunc; ++l) {
+            size_t pick = rng() % 40;
+            tu.localNames.push_back(pick < 20 ? std::string(common[pick])
+                                              : "local_value_" + std::to_string(pick));
+            tu.localKeys.push_back(addr += 16 * (4 + rng() % 8));
+        }
+        for (size_t r = 0; r < localsPerFunc * refsPerVar; ++r) {
+            tu.refs.push_back(tu.localKeys[f * localsPerFunc + rng() % localsPerFunc]);
+            if (r % 8 == 0 && numGlobals) {
+                tu.refs.push_back(tu.globalKeys[rng() % numGlobals]);
+            }
+        }
+    }
+    return tu;
+}
+
+// the SlangVar and its naming before the SymbolTable
+struct StringVar {
+    uint64_t id;
+    std::string name;
+    std::string typeStr;
+
+    void setLocalVarName(std::string varName, std::string funcName) {
+        name = "v:";
+        name += funcName + ":" + varName;
+    }
+    void setGlobalVarName(std::string varName) {
+        name = "v:";
+        name += varName;
+    }
+};
+
+struct StringLowering {
+    DeclMap<StringVar> varMap;
+    std::unordered_map<std::string, uint64_t> varCountMap;
+
+    void declare(uint64_t key, const std::string &funcName, const std::string &varName) {
+        StringVar slangVar;
+        slangVar.id = key;
+        slangVar.typeStr = "types.Int32";
+        if (funcName.empty()) {
+            slangVar.setGlobalVarName(varName);
+        } else {
+            slangVar.setLocalVarName(varName, funcName);
+            auto count = varCountMap.find(slangVar.name);
+            if (count != varCountMap.end()) {
+                slangVar.setLocalVarName(std::to_string(++count->second) + "D" + varName, funcName);
+            } else {
+                varCountMap[slangVar.name] = 1;
+            }
+        }
+        varMap[key] = slangVar;
+    }
+
+    std::string convertVarExpr(uint64_t varAddr) {
+        std::stringstream ss;
+        auto slangVar = varMap[varAddr];
+        ss << slangVar.name;
+        return ss.str();
+    }
+};
+
+// the SlangVar and its naming with the SymbolTable
+struct IdVar {
+    uint64_t id;
+    SymbolId nameId;
+    std::string typeStr;
+};
+
+struct IdLowering {
+    SymbolTable symbols;
+    DeclMap<IdVar> varMap;
+    llvm::DenseMap<SymbolId, uint32_t> varCountMap;
+
+    void declare(uint64_t key, const std::string &funcName, const std::string &varName) {
+        IdVar slangVar;
+        slangVar.id = key;
+        slangVar.typeStr = "types.Int32";
+        if (funcName.empty()) {
+            slangVar.nameId = symbols.getGlobalVar(symbols.getString(varName));
+        } else {
+            SymbolId funcId = symbols.getString(funcName);
+            slangVar.nameId = symbols.getLocalVar(funcId, symbols.getString(varName));
+            auto count = varCountMap.find(slangVar.nameId);
+            if (count != varCountMap.end()) {
+                slangVar.nameId = symbols.getLocalVar(
+                    funcId, symbols.getString(std::to_string(++count->second) + "D" + varName));
+            } else {
+                varCountMap[slangVar.nameId] = 1;
+            }
+        }
+        varMap[key] = slangVar;
+    }
+
+    const std::string &convertVarExpr(uint64_t varAddr) {
+        return symbols.getName(varMap[varAddr].nameId);
+    }
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename LoweringT>
+static void run(const char *name, const Tu &tu, size_t localsPerFunc, size_t refsPerVar) {
+    size_t startBytes = liveBytes;
+    size_t textBytes = 0;
+    double declareSecs, lowerSecs;
+    {
+        LoweringT lowering;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t g = 0; g < tu.globalNames.size(); ++g) {
+            lowering.declare(tu.globalKeys[g], "", tu.globalNames[g]);
+        }
+        for (size_t i = 0; i < tu.localKeys.size(); ++i) {
+            lowering.declare(tu.localKeys[i], tu.funcNames[i / localsPerFunc], tu.localNames[i]);
+        }
+        declareSecs = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        AppendBuffer ss;
+        for (size_t r = 0; r < tu.refs.size(); ++r) {
+            ss << "expr.VarE(\"" << lowering.convertVarExpr(tu.refs[r]) << "\", Loc(1,1))";
+            if (r % 3 == 2) { // a statement is complete
+                textBytes += ss.size();
+                ss.clear();
+            }
+        }
+        lowerSecs = secondsSince(start);
+
+        printf("  %-14s declare %6.3f s, lower %6.3f s, %7.2f MB (%zu bytes of text)\n", name,
+               declareSecs, lowerSecs, (liveBytes - startBytes) / (1024.0 * 1024.0), textBytes);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t numFuncs = argc > 1 ? (size_t)std::atoll(argv[1]) : 20000;
+    size_t localsPerFunc = argc > 2 ? (size_t)std::atoll(argv[2]) : 12;
+    size_t refsPerVar = argc > 3 ? (size_t)std::atoll(argv[3]) : 10;
+    size_t numGlobals = argc > 4 ? (size_t)std::atoll(argv[4]) : 5000;
+
+    Tu tu = makeTu(numFuncs, localsPerFunc, refsPerVar, numGlobals);
+    printf("%zu functions, %zu locals, %zu globals, %zu references\n", numFuncs,
+           tu.localKeys.size(), numGlobals, tu.refs.size());
+    for (int run_ = 0; run_ < 2; ++run_) {
+        run<StringLowering>("std::string", tu, localsPerFunc, refsPerVar);
+        run<IdLowering>("SymbolTable", tu, localsPerFunc, refsPerVar);
+    }
+
+    // the materialization alone: the text of every name, built once
+    {
+        IdLowering lowering;
+        for (size_t i = 0; i < tu.localKeys.size(); ++i) {
+            lowering.declare(tu.localKeys[i], tu.funcNames[i / localsPerFunc], tu.localNames[i]);
+        }
+        size_t startBytes = liveBytes;
+        auto start = std::chrono::steady_clock::now();
+        size_t chars = 0;
+        for (uint64_t key : tu.localKeys) {
+            chars += lowering.convertVarExpr(key).size();
+        }
+        printf("  materialize the %zu local names: %6.3f s, %7.2f MB (%zu chars)\n",
+               tu.localKeys.size(), secondsSince(start),
+               (liveBytes - startBytes) / (1024.0 * 1024.0), chars);
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2019 Anshuman Dhuliya
+
+"""Builds the native loader of the SPAN IR, span.ir._irload (see
+span/ir/irload.py). From this directory,
+
+  python3 setup.py build_ext --inplace
+
+puts span/ir/_irload*.so next to irload.py. Without it the IR is eval()-ed.
+"""
+
+from setuptools import setup, Extension
+
+setup(
+  name="span",
+  packages=["span", "span.ir", "span.util"],
+  ext_modules=[
+    Extension(
+      "span.ir._irload",
+      sources=["span/ir/_irload.cpp"],
+      language="c++",
+      extra_compile_args=["-std=c++11", "-O2"],
+    ),
+  ],
+)
@@ -36,8 +36,10 @@ import span.ir.tunit as irTUnit # IMPORTANT
 from span.ir.types import Loc # IMPORTANT
 import span.ir.graph as graph # IMPORTANT
 import span.ir.ir as ir
+import span.ir.irload as irload
 
 import span.util.util as util
+import span.util.slangserver as slangserver
 
 # Set this variable to True only if,
 #   * you are intersted in SPAN IR only (view/print its dot graph etc)
@@ -152,6 +154,20 @@ def c2spanir(cFileName: str = None) -> int:
   """
   if not cFileName:
     cFileName = sys.argv[2]
+
+  serverSocket = slangserver.getServerSocket()
+  if serverSocket:
+    # a running slang-server keeps the headers parsed (much faster), and
+    # writes the same IR as clang --analyze (see tests/test_slangserver.py)
+    print(f"converting> with slang-server at {serverSocket}"
+          f" ({slangserver.SERVER_ENV_VAR}; unset it to run clang --analyze)")
+    spanir = slangserver.convert(serverSocket, cFileName)
+    if spanir is None:
+      print("SPAN: ERROR: slang-server could not convert", cFileName)
+      return 1
+    util.writeToFile(f"{cFileName}.spanir", spanir)
+    return 0
+
   cmd = f"clang --analyze -Xanalyzer -analyzer-checker=debug.SlangGenAst {cFileName}"
 
   print("running> ", cmd)
@@ -170,7 +186,7 @@ def diagnoseSpanIr() -> None:
   fileName = convertIfCFile(fileName)
 
   spanir = util.readFromFile(fileName)
-  currTUnit = eval(spanir)
+  currTUnit = irload.loadSpanIr(spanir)
 
   reports = []
   for objName, irObj in currTUnit.allObjs.items():
@@ -230,7 +246,7 @@ def analyzeSpanIr() -> None:
       printUsageAndExit(30)
 
   spanir = util.readFromFile(fileName)
-  currTUnit = eval(spanir)
+  currTUnit = irload.loadSpanIr(spanir)
 
   # for index in range(1,10000):
   #   start = time.time()
@@ -254,7 +270,7 @@ def viewDotFile():
   fileName = convertIfCFile(fileName)
 
   spanir = util.readFromFile(fileName)
-  currTUnit = eval(spanir)
+  currTUnit = irload.loadSpanIr(spanir)
 
   #if OPTIMIZE: irTUnit.OptimizeTUnit.optimizeO3(tUnit)
 
@@ -291,7 +307,7 @@ def spanir2hooplir():
   fileName = sys.argv[2]
 
   spanir = util.readFromFile(fileName)
-  currTUnit = eval(spanir)
+  currTUnit = irload.loadSpanIr(spanir)
 
   for objName, irObj in currTUnit.allObjs.items():
     if isinstance(irObj, obj.Func):
@@ -0,0 +1,612 @@
+//===----------------------------------------------------------------------===//
+//  MIT License.
+//  Copyright (c) 2019 The SLANG Authors.
+//
+//  Author: Anshuman Dhuliya (dhuliya@cse.iitb.ac.in)
+//
+//===----------------------------------------------------------------------===//
+// span.ir._irload: a native loader of the SPAN IR text (see irload.py).
+//
+// The .spanir file is a python expression. Instead of eval()-ing it, the
+// loader parses the subset of python the IR uses,
+//
+//     calls and dotted names     tunit.TranslationUnit(...), types.Int32
+//     keyword arguments          types.Ptr(to=types.Int8)
+//     literals                   1, -2, 0x1f, 1.5e3, "str", 'str', True, None
+//     containers                 [...], (...), {key: value, ...}, {...}
+//     comments                   # ...
+//
+// and calls the span.ir constructors directly. A (dotted) name is looked up,
+// whole, in the dict of names given (e.g. {"types.Ptr": span.ir.types.Ptr,
+// ...}, see _getNames() in irload.py): no attribute is ever taken, hence the
+// IR can only call the classes and functions of span.ir listed there. The
+// nesting of the values is limited to MAX_DEPTH.
+//
+// Build (from spanir, see setup.py),
+//   python3 setup.py build_ext --inplace
+//===----------------------------------------------------------------------===//
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace {
+
+// the strings shorter than this are shared (e.g. the variable names)
+#define MAX_SHARED_STRING_SIZE 64
+// the deepest nesting of the values (calls and containers) parsed
+#define MAX_DEPTH 256
+
+class IrLoader {
+  public:
+    IrLoader(const char *text, Py_ssize_t size, PyObject *names)
+        : begin{text}, curr{text}, end{text + size}, depth{0}, names{names},
+          strCache{PyDict_New()} {}
+
+    ~IrLoader() { Py_XDECREF(strCache); }
+
+    /** @return the value of the text (a new reference), or nullptr on an error. */
+    PyObject *load();
+
+  private:
+    const char *begin;
+    const char *curr;
+    const char *end;
+    int depth;          // of the value being parsed
+    PyObject *names;    // dotted name -> its object (borrowed)
+    PyObject *strCache; // short string -> str
+
+    void skipSpace();
+    bool isNameStart(char c) const { return c == '_' || isalpha((unsigned char)c); }
+    bool isNameChar(char c) const { return c == '_' || isalnum((unsigned char)c); }
+
+    PyObject *parseExpr();
+    PyObject *parseValue();
+    PyObject *parseRef();
+    PyObject *parseCall(PyObject *callable);
+    PyObject *parseString();
+    PyObject *parseNumber();
+    PyObject *parseList();
+    PyObject *parseDict();
+    PyObject *parseTuple();
+
+    PyObject *error(const char *message);
+    bool appendUtf8(std::string &str, uint32_t codePoint);
+};
+
+PyObject *IrLoader::load() {
+    if (!strCache) {
+        return nullptr;
+    }
+    PyObject *value = parseExpr();
+    if (value) {
+        skipSpace();
+        if (curr != end) {
+            Py_DECREF(value);
+            return error("unexpected text after the expression");
+        }
+    }
+    return value;
+}
+
+// skips the white space and the comments
+void IrLoader::skipSpace() {
+    while (curr < end) {
+        if (*curr == ' ' || *curr == '\n' || *curr == '\t' || *curr == '\r') {
+            ++curr;
+        } else if (*curr == '#') {
+            const char *newline = (const char *)memchr(curr, '\n', end - curr);
+            curr = newline ? newline + 1 : end;
+        } else {
+            break;
+        }
+    }
+}
+
+PyObject *IrLoader::error(const char *message) {
+    if (PyErr_Occurred()) {
+        return nullptr; // keep the first error
+    }
+    int line = 1, col = 1;
+    for (const char *p = begin; p < curr && p < end; ++p) {
+        if (*p == '\n') {
+            line += 1;
+            col = 1;
+        } else {
+            col += 1;
+        }
+    }
+    PyErr_Format(PyExc_ValueError, "spanir:%d:%d: %s", line, col, message);
+    return nullptr;
+}
+
+// BOUND START: expressions
+
+PyObject *IrLoader::parseExpr() {
+    if (depth >= MAX_DEPTH) {
+        return error("the values are nested too deep");
+    }
+    depth += 1;
+    PyObject *value = parseValue();
+    depth -= 1;
+    return value;
+}
+
+PyObject *IrLoader::parseValue() {
+    skipSpace();
+    if (curr >= end) {
+        return error("unexpected end of the text");
+    }
+
+    char c = *curr;
+    if (c == '-' || c == '+') {
+        ++curr;
+        PyObject *operand = parseExpr();
+        if (!operand || c == '+') {
+            return operand;
+        }
+        PyObject *value = PyNumber_Negative(operand);
+        Py_DECREF(operand);
+        return value;
+    } else if (c == '"' || c == '\'') {
+        return parseString();
+    } else if (isdigit((unsigned char)c) || c == '.') {
+        return parseNumber();
+    } else if (c == '[') {
+        return parseList();
+    } else if (c == '{') {
+        return parseDict();
+    } else if (c == '(') {
+        return parseTuple();
+    } else if (isNameStart(c)) {
+        PyObject *ref = parseRef();
+        if (!ref) {
+            return nullptr;
+        }
+        skipSpace();
+        if (curr < end && *curr == '(') {
+            PyObject *value = parseCall(ref);
+            Py_DECREF(ref);
+            return value;
+        }
+        return ref;
+    }
+    return error("unexpected character");
+}
+
+// a dotted name, e.g. types.Int32 (one of the names)
+PyObject *IrLoader::parseRef() {
+    const char *start = curr;
+    while (true) {
+        if (curr >= end || !isNameStart(*curr)) {
+            return error("a name expected");
+        }
+        if (*curr == '_') {
+            return error("the names starting with '_' are not accessible");
+        }
+        while (curr < end && isNameChar(*curr)) {
+            ++curr;
+        }
+        if (curr + 1 < end && *curr == '.' && isNameStart(curr[1])) {
+            ++curr;
+            continue;
+        }
+        break;
+    }
+
+    PyObject *name = PyUnicode_FromStringAndSize(start, curr - start);
+    if (!name) {
+        return nullptr;
+    }
+    PyObject *ref = PyDict_GetItemWithError(names, name);
+    Py_DECREF(name);
+    if (!ref) {
+        std::string message = "unknown name '" + std::string(start, curr - start) + "'";
+        curr = start;
+        return error(message.c_str());
+    }
+    Py_INCREF(ref);
+    return ref;
+} // parseRef()
+
+// (arg, ..., keyword=arg, ...)
+PyObject *IrLoader::parseCall(PyObject *callable) {
+    ++curr; // the '('
+    PyObject *args = PyList_New(0);
+    PyObject *kwargs = nullptr;
+    PyObject *value = nullptr;
+
+    while (args) {
+        skipSpace();
+        if (curr < end && *curr == ')') {
+            ++curr;
+            PyObject *argTuple = PyList_AsTuple(args);
+            if (argTuple) {
+                value = PyObject_Call(callable, argTuple, kwargs);
+                Py_DECREF(argTuple);
+            }
+            break;
+        }
+
+        // a keyword argument?
+        const char *nameEnd = curr;
+        while (nameEnd < end && isNameChar(*nameEnd)) {
+            ++nameEnd;
+        }
+        const char *afterName = nameEnd;
+        while (afterName < end && (*afterName == ' ' || *afterName == '\t')) {
+            ++afterName;
+        }
+        PyObject *keyword = nullptr;
+        if (nameEnd > curr && isNameStart(*curr) && afterName < end && *afterName == '=' &&
+            (afterName + 1 >= end || afterName[1] != '=')) {
+            keyword = PyUnicode_FromStringAndSize(curr, nameEnd - curr);
+            curr = afterName + 1;
+            if (!keyword) {
+                break;
+            }
+        }
+
+        PyObject *arg = parseExpr();
+        if (!arg) {
+            Py_XDECREF(keyword);
+            break;
+        }
+        int status;
+        if (keyword) {
+            if (!kwargs && !(kwargs = PyDict_New())) {
+                status = -1;
+            } else {
+                status = PyDict_SetItem(kwargs, keyword, arg);
+            }
+            Py_DECREF(keyword);
+        } else if (kwargs) {
+            status = -1;
+            error("a positional argument after a keyword argument");
+        } else {
+            status = PyList_Append(args, arg);
+        }
+        Py_DECREF(arg);
+        if (status < 0) {
+            break;
+        }
+
+        skipSpace();
+        if (curr < end && *curr == ',') {
+            ++curr;
+        } else if (curr >= end || *curr != ')') {
+            error("',' or ')' expected");
+            break;
+        }
+    }
+
+    Py_XDECREF(args);
+    Py_XDECREF(kwargs);
+    return value;
+} // parseCall()
+
+// BOUND END  : expressions
+
+// BOUND START: literals
+
+bool IrLoader::appendUtf8(std::string &str, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        str += (char)codePoint;
+    } else if (codePoint < 0x800) {
+        str += (char)(0xC0 | (codePoint >> 6));
+        str += (char)(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        str += (char)(0xE0 | (codePoint >> 12));
+        str += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        str += (char)(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x110000) {
+        str += (char)(0xF0 | (codePoint >> 18));
+        str += (char)(0x80 | ((codePoint >> 12) & 0x3F));
+        str += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        str += (char)(0x80 | (codePoint & 0x3F));
+    } else {
+        error("bad character code in a string");
+        return false;
+    }
+    return true;
+}
+
+// a string literal (adjacent literals are joined, as in python)
+PyObject *IrLoader::parseString() {
+    std::string str;
+    bool escaped = false;
+
+    do {
+        char quote = *curr++;
+        bool isTriple = curr + 1 < end && curr[0] == quote && curr[1] == quote;
+        if (isTriple) {
+            curr += 2; // e.g. a """description"""
+        }
+        while (true) {
+            if (curr >= end || (*curr == '\n' && !isTriple)) {
+                return error("unterminated string");
+            }
+            char c = *curr++;
+            if (c == quote && !isTriple) {
+                break;
+            } else if (c == quote && curr + 1 < end && curr[0] == quote && curr[1] == quote) {
+                curr += 2;
+                break;
+            } else if (c != '\\') {
+                str += c;
+                continue;
+            }
+
+            escaped = true;
+            if (curr >= end) {
+                return error("unterminated string");
+            }
+            c = *curr++;
+            uint32_t codePoint = 0;
+            int digits = 0;
+            switch (c) {
+            case '\n': break; // a line continuation
+            case 'n': str += '\n'; break;
+            case 't': str += '\t'; break;
+            case 'r': str += '\r'; break;
+            case 'a': str += '\a'; break;
+            case 'b': str += '\b'; break;
+            case 'f': str += '\f'; break;
+            case 'v': str += '\v'; break;
+            case '\\': case '\'': case '"': str += c; break;
+            case 'x': digits = 2; break;
+            case 'u': digits = 4; break;
+            case 'U': digits = 8; break;
+            default:
+                if (c >= '0' && c <= '7') { // up to three octal digits
+                    codePoint = c - '0';
+                    for (int i = 0; i < 2 && curr < end && *curr >= '0' && *curr <= '7'; ++i) {
+                        codePoint = codePoint * 8 + (*curr++ - '0');
+                    }
+                    if (!appendUtf8(str, codePoint)) {
+                        return nullptr;
+                    }
+                } else {
+                    str += '\\'; // kept as is, as in python
+                    str += c;
+                }
+            }
+            for (int i = 0; i < digits; ++i) {
+                if (curr >= end || !isxdigit((unsigned char)*curr)) {
+                    return error("bad escape in a string");
+                }
+                char h = *curr++;
+                codePoint = codePoint * 16 + (isdigit((unsigned char)h) ? h - '0'
+                                                  : (tolower((unsigned char)h) - 'a' + 10));
+            }
+            if (digits && !appendUtf8(str, codePoint)) {
+                return nullptr;
+            }
+        }
+        skipSpace();
+    } while (curr < end && (*curr == '"' || *curr == '\''));
+
+    PyObject *value = PyUnicode_DecodeUTF8(str.data(), str.size(), "strict");
+    if (!value || escaped || str.size() >= MAX_SHARED_STRING_SIZE) {
+        return value;
+    }
+    // share the equal strings (e.g. a variable name used many times)
+    PyObject *shared = PyDict_SetDefault(strCache, value, value);
+    Py_XINCREF(shared);
+    Py_DECREF(value);
+    return shared;
+} // parseString()
+
+PyObject *IrLoader::parseNumber() {
+    const char *start = curr;
+    bool isFloat = false;
+    if (curr + 1 < end && curr[0] == '0' && (curr[1] == 'x' || curr[1] == 'X')) {
+        curr += 2;
+        while (curr < end && isxdigit((unsigned char)*curr)) {
+            ++curr;
+        }
+    } else {
+        while (curr < end && (isdigit((unsigned char)*curr) || *curr == '.')) {
+            isFloat = isFloat || *curr == '.';
+            ++curr;
+        }
+        if (curr < end && (*curr == 'e' || *curr == 'E')) {
+            isFloat = true;
+            ++curr;
+            if (curr < end && (*curr == '+' || *curr == '-')) {
+                ++curr;
+            }
+            while (curr < end && isdigit((unsigned char)*curr)) {
+                ++curr;
+            }
+        }
+    }
+
+    std::string digits(start, curr - start);
+    if (isFloat) {
+        char *parsedEnd = nullptr;
+        double value = PyOS_string_to_double(digits.c_str(), &parsedEnd, nullptr);
+        if (value == -1.0 && PyErr_Occurred()) {
+            return nullptr;
+        }
+        if (*parsedEnd != '\0') {
+            curr = start;
+            return error("bad number");
+        }
+        return PyFloat_FromDouble(value);
+    }
+    char *parsedEnd = nullptr;
+    PyObject *value = PyLong_FromString(digits.c_str(), &parsedEnd, digits.size() > 1 &&
+                                        (digits[1] == 'x' || digits[1] == 'X') ? 16 : 10);
+    if (value && *parsedEnd != '\0') {
+        Py_DECREF(value);
+        curr = start;
+        return error("bad number");
+    }
+    return value;
+} // parseNumber()
+
+// BOUND END  : literals
+
+// BOUND START: containers
+
+PyObject *IrLoader::parseList() {
+    ++curr; // the '['
+    PyObject *list = PyList_New(0);
+    while (list) {
+        skipSpace();
+        if (curr < end && *curr == ']') {
+            ++curr;
+            return list;
+        }
+        PyObject *item = parseExpr();
+        if (!item || PyList_Append(list, item) < 0) {
+            Py_XDECREF(item);
+            break;
+        }
+        Py_DECREF(item);
+        skipSpace();
+        if (curr < end && *curr == ',') {
+            ++curr;
+        } else if (curr >= end || *curr != ']') {
+            error("',' or ']' expected");
+            break;
+        }
+    }
+    Py_XDECREF(list);
+    return nullptr;
+}
+
+// a dict, or a set (e.g. {expr.VarE("v:main:y")})
+PyObject *IrLoader::parseDict() {
+    ++curr; // the '{'
+    PyObject *container = nullptr; // decided by the first item
+    bool isSet = false;
+    while (true) {
+        skipSpace();
+        if (curr < end && *curr == '}') {
+            ++curr;
+            return container ? container : PyDict_New();
+        }
+        PyObject *key = parseExpr();
+        if (!key) {
+            break;
+        }
+        skipSpace();
+        if (!container) {
+            isSet = curr >= end || *curr != ':';
+            container = isSet ? PySet_New(nullptr) : PyDict_New();
+            if (!container) {
+                Py_DECREF(key);
+                break;
+            }
+        }
+
+        int status;
+        if (isSet) {
+            status = PySet_Add(container, key);
+        } else if (curr >= end || *curr != ':') {
+            status = -1;
+            error("':' expected");
+        } else {
+            ++curr;
+            PyObject *value = parseExpr();
+            status = value ? PyDict_SetItem(container, key, value) : -1;
+            Py_XDECREF(value);
+        }
+        Py_DECREF(key);
+        if (status < 0) {
+            break;
+        }
+        skipSpace();
+        if (curr < end && *curr == ',') {
+            ++curr;
+        } else if (curr >= end || *curr != '}') {
+            error("',' or '}' expected");
+            break;
+        }
+    }
+    Py_XDECREF(container);
+    return nullptr;
+} // parseDict()
+
+// a tuple, or a parenthesized expression
+PyObject *IrLoader::parseTuple() {
+    ++curr; // the '('
+    PyObject *items = PyList_New(0);
+    bool isTuple = false;
+    while (items) {
+        skipSpace();
+        if (curr < end && *curr == ')') {
+            ++curr;
+            if (!isTuple && PyList_GET_SIZE(items) == 1) {
+                PyObject *item = PyList_GET_ITEM(items, 0);
+                Py_INCREF(item);
+                Py_DECREF(items);
+                return item;
+            }
+            PyObject *tuple = PyList_AsTuple(items);
+            Py_DECREF(items);
+            return tuple;
+        }
+        PyObject *item = parseExpr();
+        if (!item || PyList_Append(items, item) < 0) {
+            Py_XDECREF(item);
+            break;
+        }
+        Py_DECREF(item);
+        skipSpace();
+        if (curr < end && *curr == ',') {
+            ++curr;
+            isTuple = true;
+        } else if (curr >= end || *curr != ')') {
+            error("',' or ')' expected");
+            break;
+        }
+    }
+    Py_XDECREF(items);
+    return nullptr;
+}
+
+// BOUND END  : containers
+
+PyObject *irload_load(PyObject * /*self*/, PyObject *args) {
+    PyObject *textObj;
+    PyObject *names;
+    if (!PyArg_ParseTuple(args, "OO!:load", &textObj, &PyDict_Type, &names)) {
+        return nullptr;
+    }
+
+    const char *text;
+    Py_ssize_t size;
+    if (PyUnicode_Check(textObj)) {
+        text = PyUnicode_AsUTF8AndSize(textObj, &size);
+        if (!text) {
+            return nullptr;
+        }
+    } else if (PyBytes_AsStringAndSize(textObj, (char **)&text, &size) < 0) {
+        return nullptr;
+    }
+
+    IrLoader loader(text, size, names);
+    return loader.load();
+}
+
+PyMethodDef irloadMethods[] = {
+    {"load", irload_load, METH_VARARGS,
+     "load(text, names) -> the value of the SPAN IR text.\n"
+     "The dotted names in the text are looked up, whole, in the names dict."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyModuleDef irloadModule = {
+    PyModuleDef_HEAD_INIT, "_irload", "A native loader of the SPAN IR text.", -1, irloadMethods,
+    nullptr, nullptr, nullptr, nullptr,
+};
+
+} // anonymous namespace
+
+PyMODINIT_FUNC PyInit__irload() { return PyModule_Create(&irloadModule); }
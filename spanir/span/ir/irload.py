@@ -0,0 +1,496 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2019 Anshuman Dhuliya
+
+"""Loads the SPAN IR (a .spanir file) into the span.ir objects.
+
+The IR is a python expression. The native loader (_irload.cpp, built as
+span/ir/_irload*.so with `python3 setup.py build_ext --inplace` in spanir)
+parses it and calls the span.ir constructors directly, without eval(). The
+IR can only use the names of NAMESPACE, and of its modules only the classes,
+functions and constants of span.ir (see _getNames()): it cannot run
+arbitrary code. With native=False the IR is eval()-ed instead, with the
+same names; eval() is not safe on an untrusted IR. If the native loader is
+not built, loading with native=True (the default) raises a RuntimeError,
+unless SPAN_IR_EVAL=1 is set in the environment: then the IR is eval()-ed,
+with a warning logged for each load.
+
+A .spanir file written with the checker option IrIndex=true has an index,
+the .spanir.idx file next to it: SpanIrFile uses it to parse only the
+functions (or the variables, the records) asked for.
+
+The IR written with the checker option Output=shards:DIR is split into
+shards (each a translation unit of some of the functions) and a manifest
+(the records, the global variables and the list of the shards), see
+loadManifest(), loadShard() and mapShards().
+
+The IR of a whole program, linked by slang-irlink, is in a binary
+.spanprog file: see SpanProgFile.
+
+The types of the functions and variables are written once, in the allTypes
+list at the end of the IR, and referred to by their index, as T(3): the
+list is loaded first, so each type is made once (see loadSpanIr()).
+
+The IR written with the checker option SharedIrDir=DIR only names the
+functions and records of the headers (its sharedConstructs): they are read
+from DIR, when given as the sharedDir of loadSpanIr().
+"""
+
+from typing import Any, Dict, List, NamedTuple, Optional, Tuple
+
+import inspect
+import mmap
+import multiprocessing
+import os
+import struct
+import types as pytypes
+
+import logging
+_log = logging.getLogger(__name__)
+
+import span.ir.types as types
+import span.ir.op as op
+import span.ir.expr as expr
+import span.ir.instr as instr
+import span.ir.obj as obj
+import span.ir.tunit as tunit
+import span.ir.graph as graph
+import span.ir.ir as ir
+from span.ir.types import Loc
+from span.util.summarycache import SummaryCache
+
+try:
+  import span.ir._irload as _irload
+except ImportError:
+  _irload = None
+
+
+def Manifest(**kwargs) -> Dict[str, Any]:
+  """The root of a manifest of a sharded IR (see dumpShards() in
+  ad/SlangCheckers/SlangGenAstChecker.cpp): its arguments, as a dict."""
+  return kwargs
+
+
+# the names the IR can use (the ones span.py imports to eval() the IR)
+NAMESPACE = {
+  "types": types,
+  "op": op,
+  "expr": expr,
+  "instr": instr,
+  "obj": obj,
+  "constructs": obj, # the checker writes constructs.Func
+  "tunit": tunit,
+  "irTUnit": tunit,
+  "graph": graph,
+  "ir": ir,
+  "Loc": Loc,
+  "Manifest": Manifest,
+  "True": True,
+  "False": False,
+  "None": None,
+}
+
+
+def _isIrName(name: str, value: Any) -> bool:
+  """Returns True if the attribute of a span.ir module is visible to the IR:
+  a class or a function of span.ir, or a constant (e.g. types.Int32,
+  types.FalseEdge), but not a module imported (e.g. expr.io) or anything
+  else."""
+  if name.startswith("_") or inspect.ismodule(value):
+    return False
+  if inspect.isclass(value) or inspect.isfunction(value):
+    return value.__module__.startswith("span.ir.")
+  if isinstance(value, (bool, int, float, str)):
+    return True
+  return not callable(value) and type(value).__module__.startswith("span.ir.")
+
+
+def _getNames(nameSpace: Dict[str, Any]) -> Dict[str, Any]:
+  """Returns the names the IR can use, each (dotted) name -> its object,
+  e.g. {"types.Ptr": types.Ptr, "Loc": Loc, ...}."""
+  names = {}
+  for name, value in nameSpace.items():
+    if not inspect.ismodule(value):
+      names[name] = value
+      continue
+    for attrName, attr in vars(value).items():
+      if _isIrName(attrName, attr):
+        names[f"{name}.{attrName}"] = attr
+  return names
+
+
+# the names of NAMESPACE (see _getNames())
+NAMES = _getNames(NAMESPACE)
+
+
+# the analysis id of the constructs in the shared dir
+# (SHARED_IR_CACHE_ID in ad/SlangCheckers/SlangSummaryCache.h)
+SHARED_IR_CACHE_ID = "slang.sharedir.v1"
+
+
+def _withTUnit(names: Dict[str, Any], translationUnit) -> Dict[str, Any]:
+  """Returns the names with the TranslationUnit of the IR replaced."""
+  return dict(names, **{"tunit.TranslationUnit": translationUnit,
+                        "irTUnit.TranslationUnit": translationUnit})
+
+
+def _argsTranslationUnit(**kwargs) -> Dict[str, Any]:
+  """The TranslationUnit of a shared construct: the dict of its arguments."""
+  return kwargs
+
+
+class _SharedTUnit:
+  """The TranslationUnit of a TU that may refer to shared constructs: they
+  are read from the shared dir and put back in, before the real
+  TranslationUnit is made."""
+
+  def __init__(self, sharedDir: Optional[str], native: bool) -> None:
+    self.sharedDir = sharedDir
+    self.native = native
+
+  def TranslationUnit(self, **kwargs) -> Any:
+    sharedConstructs = kwargs.pop("sharedConstructs", {})
+    if sharedConstructs and not self.sharedDir:
+      raise ValueError(f"{kwargs.get('name')}: refers to {len(sharedConstructs)} constructs"
+                       f" (e.g. {next(iter(sharedConstructs))}) written to the SharedIrDir"
+                       f" of the checker: give that directory as the sharedDir")
+    constructsKey = "allObjs" if "allObjs" in kwargs else "allConstructs"
+    cache = SummaryCache(self.sharedDir)
+    names = _withTUnit(NAMES, _argsTranslationUnit)
+    for name, irHash in sharedConstructs.items():
+      text = cache.lookup(SHARED_IR_CACHE_ID, irHash)
+      if text is None:
+        raise ValueError(f"{name}: not found in the shared dir {self.sharedDir}")
+      shared = _load(text, names, self.native)
+      kwargs.setdefault(constructsKey, {}).update(
+        shared.get("allConstructs", shared.get("allObjs", {})))
+      kwargs.setdefault("allVars", {}).update(shared.get("allVars", {}))
+    return tunit.TranslationUnit(**kwargs)
+
+
+def isNative() -> bool:
+  """Returns True if the native loader is available."""
+  return _irload is not None
+
+
+def _evalNameSpace(names: Dict[str, Any]) -> Dict[str, Any]:
+  """Returns the names (see _getNames()) as the namespace of eval()."""
+  nameSpace: Dict[str, Any] = {}
+  for name, value in names.items():
+    first, _, rest = name.partition(".")
+    if rest:
+      setattr(nameSpace.setdefault(first, pytypes.SimpleNamespace()), rest, value)
+    else:
+      nameSpace[name] = value
+  return nameSpace
+
+
+# the environment variable that lets a native load eval() the IR when the
+# native loader is not built (see _load())
+EVAL_FALLBACK_ENV = "SPAN_IR_EVAL"
+
+
+def _load(spanIr: str, names: Dict[str, Any], native: bool) -> Any:
+  """Loads the IR with the native loader, or with eval() if native is False.
+  If the native loader is not built, a native load eval()-s the IR only if
+  EVAL_FALLBACK_ENV=1 is set (and logs a warning): else it raises a
+  RuntimeError."""
+  if native:
+    if _irload:
+      return _irload.load(spanIr, names)
+    if os.environ.get(EVAL_FALLBACK_ENV) != "1":
+      raise RuntimeError("the native SPAN IR loader (span/ir/_irload) is not built: build it"
+                         " with `python3 setup.py build_ext --inplace` in spanir, or set"
+                         f" {EVAL_FALLBACK_ENV}=1 (or load with native=False) to eval() the IR")
+    _log.warning("the native SPAN IR loader is not built: eval()-ing the IR (%s=1)",
+                 EVAL_FALLBACK_ENV)
+  return eval(spanIr, {"__builtins__": {}}, _evalNameSpace(names))
+
+
+# the allTypes list of the IR (see ad/SlangCheckers/SlangTypeTable.h)
+_TYPES_START = "\n  allTypes = "
+_TYPES_END = ", # end allTypes list\n"
+
+
+def _splitTypeTable(spanIr: str) -> Tuple[str, Optional[str]]:
+  """Returns the IR without its allTypes list, and the list (None if absent)."""
+  start = spanIr.rfind(_TYPES_START)
+  end = spanIr.find(_TYPES_END, start) if start >= 0 else -1
+  if end < 0:
+    return spanIr, None
+  return (spanIr[:start + 1] + spanIr[end + len(_TYPES_END):],
+          spanIr[start + len(_TYPES_START):end])
+
+
+def _withTypes(names: Dict[str, Any], typesText: str, native: bool) -> Dict[str, Any]:
+  """Returns the names with T(<index>), the type in the allTypes list."""
+  allTypes = _load(typesText, NAMES, native)
+  return dict(names, T=allTypes.__getitem__)
+
+
+def loadSpanIr(spanIr: str,
+               native: bool = True,
+               sharedDir: Optional[str] = None,
+) -> Any:
+  """Returns the value (e.g. a tunit.TranslationUnit) of the SPAN IR text.
+  The shared constructs it refers to are read from sharedDir.
+
+  Raises ValueError on a syntax error in the IR (with its line and column),
+  on shared constructs without a sharedDir, or on one not found in it.
+  """
+  names = _withTUnit(NAMES, _SharedTUnit(sharedDir, native).TranslationUnit)
+  spanIr, typesText = _splitTypeTable(spanIr)
+  if typesText is not None:
+    names = _withTypes(names, typesText, native)
+  return _load(spanIr, names, native)
+
+
+def loadSpanIrFile(fileName: str,
+                   native: bool = True,
+                   sharedDir: Optional[str] = None,
+) -> Any:
+  """Returns the value of the SPAN IR in the file."""
+  with open(fileName) as f:
+    return loadSpanIr(f.read(), native, sharedDir)
+
+
+class FuncEntry(NamedTuple):
+  """A function in the index of a .spanir file."""
+  name: str
+  offset: int
+  length: int
+  blocks: int
+  instrs: int
+  temps: int
+
+
+class SpanIrIndex:
+  """The index of a .spanir file (see dumpIrIndex() in
+  ad/SlangCheckers/SlangGenAstChecker.cpp); offsets are in bytes."""
+
+  def __init__(self):
+    self.name: str = ""
+    self.size: int = 0
+    self.records: Tuple[int, int] = (0, 0) # (offset, length)
+    self.vars: Tuple[int, int] = (0, 0)
+    self.types: Optional[Tuple[int, int]] = None # the allTypes list
+    self.funcs: Dict[str, FuncEntry] = {}
+
+
+def loadSpanIrIndex(indexFileName: str) -> SpanIrIndex:
+  """Reads the index (the .spanir.idx file).
+
+  Raises ValueError on a malformed line.
+  """
+  index = SpanIrIndex()
+  with open(indexFileName) as f:
+    for lineNum, line in enumerate(f, 1):
+      fields = line.rstrip("\n").split("\t")
+      try:
+        if not fields[0] or fields[0].startswith("#"):
+          continue
+        elif fields[0] == "spanir":
+          index.name, index.size = fields[1], int(fields[2])
+        elif fields[0] == "records":
+          index.records = (int(fields[1]), int(fields[2]))
+        elif fields[0] == "vars":
+          index.vars = (int(fields[1]), int(fields[2]))
+        elif fields[0] == "types":
+          index.types = (int(fields[1]), int(fields[2]))
+        elif fields[0] == "func":
+          entry = FuncEntry(fields[1], *(int(field) for field in fields[2:7]))
+          index.funcs[entry.name] = entry
+        else:
+          raise ValueError("unknown entry")
+      except (IndexError, TypeError, ValueError) as e:
+        raise ValueError(f"{indexFileName}:{lineNum}: bad index entry: {e}")
+  return index
+
+
+class SpanIrFile:
+  """A .spanir file, memory mapped, whose parts are loaded on demand
+  through its index.
+
+    with SpanIrFile("test.c.spanir") as irFile:
+      func = irFile.loadFunc("f:main")
+
+  The functions and records of the headers written to the SharedIrDir of
+  the checker (the sharedConstructs of the IR) are not in the file, hence
+  not in its index: loadFunc() returns None for them. Load the whole TU
+  with loadSpanIrFile(fileName, sharedDir=...) to have them.
+  """
+
+  def __init__(self, fileName: str, native: bool = True):
+    self.fileName = fileName
+    self.native = native
+    self.index = loadSpanIrIndex(fileName + ".idx")
+    self._file = open(fileName, "rb")
+    self._map = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+    if len(self._map) != self.index.size:
+      self.close()
+      raise ValueError(f"{fileName}: the index is stale (the size differs)")
+    self._names = NAMES
+    if self.index.types:
+      self._names = _withTypes(NAMES, self.getText(*self.index.types), native)
+
+  def close(self) -> None:
+    self._map.close()
+    self._file.close()
+
+  def __enter__(self) -> "SpanIrFile":
+    return self
+
+  def __exit__(self, *args) -> None:
+    self.close()
+
+  def getText(self, offset: int, length: int) -> str:
+    return self._map[offset:offset + length].decode()
+
+  def getFuncNames(self) -> List[str]:
+    return list(self.index.funcs)
+
+  def loadFunc(self, funcName: str) -> Optional[Any]:
+    """Returns the function (e.g. an obj.Func), or None if absent."""
+    entry = self.index.funcs.get(funcName)
+    if entry is None:
+      return None
+    return _load(self.getText(entry.offset, entry.length), self._names, self.native)
+
+  def loadVars(self) -> Dict[str, Any]:
+    """Returns the allVars dict (variable name -> type)."""
+    return _load(self.getText(*self.index.vars), self._names, self.native)
+
+  def loadRecords(self) -> Dict[str, Any]:
+    """Returns the records (record name -> types.Struct/types.Union)."""
+    return _load("{" + self.getText(*self.index.records) + "}", self._names, self.native)
+
+
+def loadManifest(manifestFileName: str, native: bool = True) -> Dict[str, Any]:
+  """Returns the manifest of a sharded IR (a .spanir.manifest file): a dict
+  of name, description, allConstructs (the records), allVars (the global
+  variables), funcSigs (the signature of each function), callGraph,
+  callGraphSccs, typeLayouts and shards, a list of
+  (shard file name, [function names])."""
+  return loadSpanIrFile(manifestFileName, native)
+
+
+def getShardPaths(manifestFileName: str, manifest: Dict[str, Any]) -> List[str]:
+  """Returns the paths of the shards (they are next to the manifest)."""
+  shardDir = os.path.dirname(manifestFileName)
+  return [os.path.join(shardDir, shardName) for shardName, _ in manifest["shards"]]
+
+
+def loadShard(shardPath: str,
+              manifest: Optional[Dict[str, Any]] = None,
+              native: bool = True,
+) -> Any:
+  """Returns the tunit.TranslationUnit of a shard, with what the shards
+  share put back in from the manifest (by default the one next to the
+  shard, e.g. test.c.spanir.manifest for test.c.3.spanir): the records, the
+  global variables, the call graph and the type layouts; and the functions
+  of the other shards, as declarations of their signature."""
+  if manifest is None:
+    shardDir, shardName = os.path.split(shardPath)
+    baseName = shardName.rsplit(".", 2)[0] # test.c.3.spanir -> test.c
+    manifest = loadManifest(os.path.join(shardDir, baseName + ".spanir.manifest"), native)
+  with open(shardPath) as f:
+    args = _load(f.read(), _withTUnit(NAMES, _argsTranslationUnit), native)
+  args["allConstructs"] = dict(manifest["allConstructs"], **args.pop("allConstructs", {}))
+  args["allVars"] = dict(manifest["allVars"], **args.get("allVars", {}))
+  for funcName, sig in manifest.get("funcSigs", {}).items():
+    if funcName not in args["allConstructs"]:
+      args["allConstructs"][funcName] = obj.Func(name=funcName, paramNames=[],
+        returnType=sig.returnType, paramTypes=sig.paramTypes, variadic=sig.variadic)
+  for key in ("callGraph", "callGraphSccs", "typeLayouts"):
+    if key in manifest:
+      args.setdefault(key, manifest[key])
+  return tunit.TranslationUnit(**args)
+
+
+def mapShards(manifestFileName: str,
+              func,
+              processes: Optional[int] = None,
+              native: bool = True,
+) -> List[Any]:
+  """Calls func(shardPath) on each shard of the sharded IR, on as many
+  processes (all the cores by default), and returns the results in the
+  order of the shards. The func, a top level function, loads the shard
+  itself (loadShard())."""
+  shardPaths = getShardPaths(manifestFileName, loadManifest(manifestFileName, native))
+  with multiprocessing.Pool(processes) as pool:
+    return pool.map(func, shardPaths, chunksize=1)
+
+
+# the kinds of the items of a .spanprog file (see ad/SlangCheckers/SlangIrLinker.h)
+PROG_FUNC = 0         # "f:main": a constructs.Func
+PROG_LOCALS = 1       # "f:main": the dict of its local variables
+PROG_GLOBAL = 2       # "v:x": its type
+PROG_RECORD = 3       # "s:node": a types.Struct or types.Union
+PROG_CALL_GRAPH = 4   # "callGraph"
+PROG_SCCS = 5         # "callGraphSccs"
+PROG_UNITS = 6        # "units": the names of the linked translation units
+PROG_TYPE_LAYOUTS = 7 # "typeLayouts": the layouts of the records and types
+
+
+class SpanProgFile:
+  """The IR of a whole program (a .spanprog file written by slang-irlink),
+  memory mapped; each item is loaded on demand.
+
+    with SpanProgFile("prog.spanprog") as prog:
+      func = prog.load(PROG_FUNC, "f:main")
+  """
+
+  def __init__(self, fileName: str, native: bool = True):
+    self.fileName = fileName
+    self.native = native
+    # (kind, name) -> (offset, size)
+    self.items: Dict[Tuple[int, str], Tuple[int, int]] = {}
+    self._file = open(fileName, "rb")
+    self._map = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+    try:
+      self._readIndex()
+    except (ValueError, struct.error) as e:
+      self.close()
+      raise ValueError(f"{fileName}: not a valid .spanprog file: {e}")
+
+  def _readIndex(self) -> None:
+    data = self._map
+    if data[:8] != b"SPANPROG" or data[-8:] != b"SPANIDX1":
+      raise ValueError("bad magic")
+    version, = struct.unpack_from("<I", data, 8)
+    if version != 1:
+      raise ValueError(f"unknown version {version}")
+
+    pos, = struct.unpack_from("<Q", data, len(data) - 16)
+    count, = struct.unpack_from("<I", data, pos)
+    pos += 4
+    for _ in range(count):
+      kind, nameSize = struct.unpack_from("<BI", data, pos)
+      pos += 5
+      name = data[pos:pos + nameSize].decode()
+      pos += nameSize
+      self.items[(kind, name)] = struct.unpack_from("<QQ", data, pos)
+      pos += 16
+
+  def close(self) -> None:
+    self._map.close()
+    self._file.close()
+
+  def __enter__(self) -> "SpanProgFile":
+    return self
+
+  def __exit__(self, *args) -> None:
+    self.close()
+
+  def getNames(self, kind: int) -> List[str]:
+    """Returns the names of the items of the kind (e.g. PROG_FUNC)."""
+    return [name for itemKind, name in self.items if itemKind == kind]
+
+  def load(self, kind: int, name: str) -> Optional[Any]:
+    """Returns the value of the item, or None if absent."""
+    item = self.items.get((kind, name))
+    if item is None:
+      return None
+    offset, size = item
+    return loadSpanIr(self._map[offset:offset + size].decode(), self.native)
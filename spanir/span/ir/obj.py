@@ -68,7 +68,8 @@ class Func (ObjT):
                bbEdges: Optional[List[Tuple[BasicBlockIdT, BasicBlockIdT, EdgeLabelT]]] =
                None,
                instrSeq: Optional[List[InstrIT]] = None,
-               loc: Optional[Loc] = None
+               loc: Optional[Loc] = None,
+               irHash: Optional[str] = None,
   ) -> None:
     self.name = name
     self.paramNames = paramNames
@@ -81,6 +82,8 @@ class Func (ObjT):
     self.bbEdges = bbEdges if bbEdges else []
     self.instrSeq = instrSeq
     self.loc = loc
+    # stable hash of the lowered function: keys its summaries (span.util.summarycache)
+    self.irHash = irHash
     self.cfg: Optional[graph.Cfg] = None # initialized in TUnit class
     self.tUnit = None # initialized to span.ir.tunit.TUnit obj in span.ir.tunit
 
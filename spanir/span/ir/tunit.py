@@ -117,8 +117,16 @@ class TranslationUnit:
                name: str,
                description: str,
                allVars: Dict[obj.VarNameT, types.Type],
-               allObjs: Dict[obj.ObjNamesT, obj.ObjT]
+               allObjs: Optional[Dict[obj.ObjNamesT, obj.ObjT]] = None,
+               callGraph: Optional[Dict[types.FuncNameT, List[types.FuncNameT]]] = None,
+               callGraphSccs: Optional[List[Tuple[int, List[types.FuncNameT]]]] = None,
+               typeLayouts: Optional[Dict[object, tuple]] = None,
+               allConstructs: Optional[Dict[obj.ObjNamesT, obj.ObjT]] = None,
+               internalVars: Optional[List[obj.VarNameT]] = None,
   ) -> None:
+    # the checker writes allConstructs (of constructs.Func, i.e. obj.Func)
+    if allObjs is None:
+      allObjs = allConstructs if allConstructs is not None else {}
     # analysis unit name and description
     self.name = name
     self.description = description
@@ -126,6 +134,21 @@ class TranslationUnit:
     # whole of TU is contained in these two dictionaries
     self.allVars = allVars
     self.allObjs = allObjs
+    # the global vars of internal linkage (e.g. static): of this TU alone
+    self.internalVars: Set[obj.VarNameT] = set(internalVars) if internalVars else set()
+
+    # function name to the names of the functions it may call
+    self.callGraph = callGraph if callGraph else {}
+    # (level, function names) of each SCC of the call graph, callees first.
+    # The SCCs at the same level do not call each other (can run in parallel).
+    self.callGraphSccs = callGraphSccs if callGraphSccs else []
+    # the layouts computed by Clang for the target (see getTypeLayout()),
+    # record name -> (size, align, [(offset, bitWidth), ...]),
+    # str(type) -> (size, align): sizes in bytes, offsets and bit widths in bits.
+    # (a type is keyed by its str(): the records in it may be filled later)
+    self.typeLayouts: Dict[str, tuple] = {}
+    for key, layout in (typeLayouts.items() if typeLayouts else ()):
+      self.typeLayouts[key if isinstance(key, str) else str(key)] = layout
 
     self.initialized: bool = False
 
@@ -273,7 +296,7 @@ class TranslationUnit:
         for _, instrs in irObj.basicBlocks.items():
           for insn in instrs:
             self.inferInstrType(insn)
-      self.extractTmpVarAssignExprs(irObj)
+        self.extractTmpVarAssignExprs(irObj)
 
   ################################################
   #BOUND START: Type_Inference
@@ -786,14 +809,14 @@ class TranslationUnit:
 
   def getMemAllocSizeExpr(self, insn: instr.AssignI) -> expr.ExprET:
     """Returns the expression deciding the size of memory allocated."""
-    lhs: expr.CallE = insn.lhs
-    calleeName = lhs.callee.name
+    rhs: expr.CallE = insn.rhs
+    calleeName = rhs.callee.name
     sizeExpr = None
 
     if calleeName == "f:malloc":
-      sizeExpr = lhs.args[0] # the one and only argument is the size expr
+      sizeExpr = rhs.args[0] # the one and only argument is the size expr
     elif calleeName == "f:calloc":
-      sizeExpr = expr.BinaryE(lhs.args[0], op.BO_MUL, lhs.args[1], loc=lhs.args[0].loc)
+      sizeExpr = expr.BinaryE(rhs.args[0], op.BO_MUL, rhs.args[1], loc=rhs.args[0].loc)
       self.inferExprType(sizeExpr)
 
     return sizeExpr
@@ -973,6 +996,30 @@ class TranslationUnit:
 
     return envVars
 
+  def getTypeLayout(self,
+                    givenType: types.Type
+  ) -> Optional[Tuple[int, int]]:
+    """Returns the (size, alignment) in bytes of the type,
+    or None if not known (e.g. an incomplete type)."""
+    if isinstance(givenType, types.RecordT):
+      layout = self.typeLayouts.get(givenType.name)
+    else:
+      layout = self.typeLayouts.get(str(givenType))
+    return (layout[0], layout[1]) if layout else None
+
+  def getFieldOffset(self,
+                     recordType: types.RecordT,
+                     fieldName: types.FieldNameT,
+  ) -> Optional[Tuple[int, int]]:
+    """Returns the (offset, bit width) in bits of the field of the record
+    (the bit width is 0 if it is not a bit-field), or None if not known."""
+    layout = self.typeLayouts.get(recordType.name)
+    if not layout or not recordType.fields: return None
+    for (fName, _), memberLayout in zip(recordType.fields, layout[2]):
+      if fName == fieldName:
+        return memberLayout
+    return None
+
   def __eq__(self,
              other: 'TranslationUnit'
   ) -> bool:
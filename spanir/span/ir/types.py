@@ -610,7 +610,9 @@ class Struct(RecordT):
                name: StructNameT,
                fields: List[Tuple[str, Type]] = None,
                loc: Optional[Loc] = None,
+               members: List[Tuple[str, Type]] = None, # as the checker writes fields
   ) -> None:
+    if fields is None: fields = members
     super().__init__(name, fields, loc, STRUCT_TC)
     self.name = name
     self.fields = fields
@@ -640,6 +642,9 @@ class Struct(RecordT):
       return False
     return True
 
+  # (defining __eq__ unsets the __hash__ of RecordT)
+  def __hash__(self): return super().__hash__()
+
 class Union(RecordT):
   """A union type.
   Anonymous unions are also given a unique name."""
@@ -648,7 +653,9 @@ class Union(RecordT):
                name: UnionNameT,
                fields: List[Tuple[str, Type]] = None,
                loc: Optional[Loc] = None,
+               members: List[Tuple[str, Type]] = None, # as the checker writes fields
   ) -> None:
+    if fields is None: fields = members
     super().__init__(name, fields, loc, UNION_TC)
 
   def bitSize(self) -> int:
@@ -676,3 +683,6 @@ class Union(RecordT):
       return False
     return True
 
+  # (defining __eq__ unsets the __hash__ of RecordT)
+  def __hash__(self): return super().__hash__()
+
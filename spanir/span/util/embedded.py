@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2019 Anshuman Dhuliya
+
+"""The entry point of span inside the Clang checker process.
+
+The SlangGenAst checker, built with SLANG_EMBED_PYTHON (see
+ad/SlangCheckers/SlangEmbeddedPython.h) and given the checker option
+Diagnoses=NAME[,NAME...], calls diagnose() with the SPAN IR of the
+translation unit at its end, and reports the bugs returned through Clang's
+BugReporter: no .spanir or .spanreport file is written, and the source is
+parsed once.
+"""
+
+from typing import Any, List, Tuple
+
+import logging
+_log = logging.getLogger(__name__)
+
+import span.ir.obj as obj
+import span.ir.irload as irload
+
+# (line, col, message)
+MessageTuple = Tuple[int, int, str]
+# (name, category, messages): the fields of a bug in a .spanreport
+BugTuple = Tuple[str, str, List[MessageTuple]]
+
+_sysDiagnosis = None
+
+
+def getSysDiagnosis():
+  """Returns the span.sys.diagnosis module (initialized once)."""
+  global _sysDiagnosis
+  if _sysDiagnosis is None:
+    import span.sys.diagnosis as sysDiagnosis
+    sysDiagnosis.init()
+    _sysDiagnosis = sysDiagnosis
+  return _sysDiagnosis
+
+
+def diagnose(spanIr: str, diagnoses: str) -> List[BugTuple]:
+  """Runs the diagnoses (comma separated names) on each function of the IR."""
+  sysDiagnosis = getSysDiagnosis()
+  currTUnit = irload.loadSpanIr(spanIr)
+
+  bugs: List[BugTuple] = []
+  for diName in filter(None, (name.strip() for name in diagnoses.split(","))):
+    for objName, irObj in currTUnit.allObjs.items():
+      if isinstance(irObj, obj.Func):
+        func: obj.Func = irObj
+        if func.basicBlocks: # if function is not empty
+          reports = sysDiagnosis.runDiagnosis(diName, func)
+          bugs.extend(toBugTuple(report) for report in reports or [])
+  _log.info("diagnose: %s: %d bugs", currTUnit.name, len(bugs))
+  return bugs
+
+
+def toBugTuple(report: Any) -> BugTuple:
+  """Converts a report of a diagnosis.
+
+  A report is a (name, category, messages) tuple, or has these attributes;
+  likewise each message is a (line, col, msg) tuple, or has these attributes.
+  """
+  if isinstance(report, tuple):
+    name, category, messages = report
+  else:
+    name, category, messages = report.name, report.category, report.messages
+
+  messageTuples: List[MessageTuple] = []
+  for message in messages:
+    if isinstance(message, tuple):
+      line, col, msg = message
+    else:
+      line, col, msg = message.line, message.col, message.msg
+    messageTuples.append((int(line), int(col), str(msg)))
+  return str(name), str(category), messageTuples
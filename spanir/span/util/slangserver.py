@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2019 Anshuman Dhuliya
+
+"""A client of slang-server (see ad/SlangServer/SlangServer.cpp).
+
+The server keeps the parsed C files (and their headers) between the
+conversions, so converting a file again takes milliseconds, not seconds.
+Start it with,
+
+  slang-server /tmp/slang.sock
+
+and set SLANG_SERVER=/tmp/slang.sock to make `span c2spanir` use it.
+"""
+
+import os
+import socket
+from typing import Dict, List, Optional
+
+import logging
+_log = logging.getLogger(__name__)
+
+SERVER_ENV_VAR = "SLANG_SERVER"
+
+
+def getServerSocket() -> Optional[str]:
+  """Returns the socket of the server to use, if any."""
+  return os.environ.get(SERVER_ENV_VAR) or None
+
+
+def convert(socketPath: str,
+    cFileName: str,
+    args: List[str] = None,
+    configs: Dict[str, str] = None,
+) -> Optional[str]:
+  """Returns the SPAN IR of the C file, or None on an error.
+
+  args are the compile flags, and configs the SlangGenAst checker options
+  (e.g. {"Output": "file:test.c.spanir"}, then "" is returned).
+  """
+  request = [f"convert {os.path.abspath(cFileName)}"]
+  request.extend(f"arg {arg}" for arg in (args or []))
+  request.extend(f"config {key}={value}" for key, value in (configs or {}).items())
+  request.append("end\n")
+
+  with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as sock:
+    try:
+      sock.connect(socketPath)
+    except OSError as e:
+      _log.error("slang-server at %s: %s", socketPath, e)
+      return None
+    sock.sendall("\n".join(request).encode("utf-8"))
+
+    reader = sock.makefile("rb")
+    status = reader.readline().decode("utf-8").rstrip("\n")
+    if not status.startswith("ok "):
+      _log.error("slang-server: %s", status)
+      return None
+    size = int(status.split(" ")[1])
+    return reader.read(size).decode("utf-8")
@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2019 Anshuman Dhuliya
+
+"""A persistent, content addressed store of function summaries.
+
+It is shared with the SLANG checkers (see SlangSummaryCache.h).
+A summary is keyed by the irHash of a function (see obj.Func.irHash)
+and an analysis id. The layout of the cache directory is,
+
+  <cacheDir>/<key[0:2]>/<key>, where key = md5(analysisId + "\\n" + irHash)
+
+The entries are written to a temporary file and renamed into place,
+hence many processes can share a cache directory safely.
+"""
+
+import hashlib
+import os
+import os.path as osp
+import tempfile
+from typing import Optional
+
+import logging
+_log = logging.getLogger(__name__)
+
+
+class SummaryCache:
+  def __init__(self, cacheDir: str) -> None:
+    self.cacheDir = cacheDir
+
+
+  def getEntryPath(self, analysisId: str, irHash: str) -> str:
+    key = hashlib.md5((analysisId + "\n" + irHash).encode("utf-8")).hexdigest()
+    return osp.join(self.cacheDir, key[0:2], key)
+
+
+  def lookup(self, analysisId: str, irHash: str) -> Optional[str]:
+    """Returns the summary, or None if it is not cached."""
+    try:
+      with open(self.getEntryPath(analysisId, irHash)) as f:
+        return f.read()
+    except OSError:
+      return None
+
+
+  def store(self, analysisId: str, irHash: str, summary: str) -> bool:
+    """Atomically stores (or replaces) a summary."""
+    entryPath = self.getEntryPath(analysisId, irHash)
+    entryDir = osp.dirname(entryPath)
+    tmpPath = None
+    try:
+      os.makedirs(entryDir, exist_ok=True)
+      fd, tmpPath = tempfile.mkstemp(prefix=osp.basename(entryPath) + ".tmp-", dir=entryDir)
+      with os.fdopen(fd, "w") as f:
+        f.write(summary)
+      os.replace(tmpPath, entryPath) # atomic
+      return True
+    except OSError as e:
+      _log.error("SummaryCache: cannot store %s: %s", entryPath, e)
+      if tmpPath and osp.exists(tmpPath):
+        os.remove(tmpPath)
+      return False
+
@@ -0,0 +1,22 @@
+#include <stdlib.h>
+
+struct node {
+  int val;
+  struct node *next;
+};
+
+int sum(struct node *p) {
+  int s = 0;
+  while (p) {
+    s = s + p->val;
+    p = p->next;
+  }
+  return s;
+}
+
+int main() {
+  struct node *n = malloc(sizeof(struct node));
+  n->val = 1;
+  n->next = 0;
+  return sum(n);
+}
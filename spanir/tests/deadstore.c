@@ -0,0 +1,13 @@
+// the dead stores of f() (see test_deadstore.py): the initial value of x,
+// and the last value of y
+int f(int a) {
+  int x = 1;
+  int y = a;
+  if (a) {
+    x = y + 2;
+  } else {
+    x = y;
+  }
+  y = 0;
+  return x;
+}
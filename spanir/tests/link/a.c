@@ -0,0 +1,13 @@
+// linked with b.c by test_irlink.py: each has its own count
+static int count;
+int total;
+
+static int next(void) {
+  count = count + 1;
+  return count;
+}
+
+int useA(void) {
+  total = next();
+  return total;
+}
@@ -0,0 +1,13 @@
+// linked with a.c by test_irlink.py: each has its own count
+static int count;
+int total;
+int useA(void);
+
+static int next(void) {
+  count = count + 2;
+  return count;
+}
+
+int main(void) {
+  return useA() + next();
+}
@@ -0,0 +1,36 @@
+// the points-to sets of main() (see test_pointsto.py): copies, a store and
+// a load through a pointer, a copy cycle and an indirect call
+#include <stdlib.h>
+
+int g;
+
+int *id(int *p) {
+  return p;
+}
+
+int *other(int *q) {
+  return &g;
+}
+
+int main(int argc) {
+  int a, b;
+  int *p, *q, *r, *s, *t;
+  int **pp, **h;
+  int *(*fp)(int *);
+
+  p = &a;
+  q = p;
+  r = q;
+  p = r;
+  pp = &q;
+  *pp = &b;
+  s = *pp;
+  fp = id;
+  if (argc) {
+    fp = other;
+  }
+  t = fp(&b);
+  h = malloc(sizeof(int *));
+  *h = t;
+  return **h;
+}
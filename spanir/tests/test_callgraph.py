@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2019 Anshuman Dhuliya
+
+"""Tests of the call graph and its SCCs (see ad/SlangCheckers/SlangCallGraph.h),
+built by slang-ircheck -call-graph from the IR of CALL_GRAPH_C (see
+makeCallGraphIr()). They run if slang-ircheck is on the PATH, or named by
+the environment variable SLANG_IRCHECK.
+"""
+
+import ast
+import json
+import os
+import shutil
+import subprocess
+import tempfile
+import unittest
+
+TESTS_DIR = os.path.dirname(os.path.abspath(__file__))
+
+IRCHECK = os.environ.get("SLANG_IRCHECK") or shutil.which("slang-ircheck")
+
+CALL_GRAPH_C = """
+  unsigned even(unsigned n) { return n ? odd(n - 1) : 1; }  // a cycle
+  unsigned odd(unsigned n) { return n ? even(n - 1) : 0; }
+  unsigned fact(unsigned n) { return n ? n * fact(n - 1) : 1; }  // self-recursive
+  int sq(int x) { return x * x; }
+  int neg(int x) { return -x; }
+  int len(char *s) { return 0; }
+  double half(double x) { return x / 2; }
+  double scale(int x) { return x * 1.5; }
+  double sumd(int n, ...) { return 0; }
+
+  int main(void) {
+    int (*fp)(int) = sq;  // calls sq() and neg(): the same signature
+    double (*gp)() = half;  // no prototype: calls half() and scale()
+    even(3);
+    fact(4);
+    fp(2);
+    gp(1);
+    return 0;
+  }
+"""
+
+# the callees of each function of CALL_GRAPH_C
+CALLEES = {
+  "f:even": ["f:odd"],
+  "f:fact": ["f:fact"],
+  "f:half": [],
+  "f:len": [],
+  "f:main": ["f:even", "f:fact", "f:half", "f:neg", "f:scale", "f:sq"],
+  "f:neg": [],
+  "f:odd": ["f:even"],
+  "f:scale": [],
+  "f:sq": [],
+  "f:sumd": [],
+}
+
+
+def makeCallGraphIr():
+  """Returns the IR of CALL_GRAPH_C (the instructions of the calls only)."""
+  uint, dbl = "types.UInt32", "types.Float64"
+  # name: (returnType, [(param, type)], variadic, [the callee of each call])
+  funcs = {
+    "even": (uint, [("n", uint)], False, ['expr.FuncE("f:odd", Loc(2,40))']),
+    "odd": (uint, [("n", uint)], False, ['expr.FuncE("f:even", Loc(3,39))']),
+    "fact": (uint, [("n", uint)], False, ['expr.FuncE("f:fact", Loc(4,44))']),
+    "sq": ("types.Int32", [("x", "types.Int32")], False, []),
+    "neg": ("types.Int32", [("x", "types.Int32")], False, []),
+    "len": ("types.Int32", [("s", "types.Ptr(to=types.Char)")], False, []),
+    "half": (dbl, [("x", dbl)], False, []),
+    "scale": (dbl, [("x", "types.Int32")], False, []),
+    "sumd": (dbl, [("n", "types.Int32")], True, []),
+    "main": ("types.Int32", [], False,
+             ['expr.FuncE("f:even", Loc(16,5))', 'expr.FuncE("f:fact", Loc(17,5))',
+              'expr.VarE("v:main:fp", Loc(18,5))', 'expr.VarE("v:main:gp", Loc(19,5))']),
+  }
+  allVars = {
+    "v:main:fp": "types.Ptr(to=types.FuncSig(returnType=types.Int32,"
+                 " paramTypes=[types.Int32]))",
+    "v:main:gp": f"types.Ptr(to=types.FuncSig(returnType={dbl}))",
+  }
+  constructs = []
+  for name, (returnType, params, variadic, callees) in funcs.items():
+    for param, paramType in params:
+      allVars[f"v:{name}:{param}"] = paramType
+    paramNames = ", ".join(f'"v:{name}:{param}"' for param, _ in params)
+    instrs = "".join(f"instr.CallI(expr.CallE({callee}, None, Loc(1,1)), Loc(1,1)),\n"
+                     for callee in callees)
+    constructs.append(f'"f:{name}": constructs.Func(name="f:{name}", paramNames=[{paramNames}],'
+                      f" variadic={variadic}, returnType={returnType}, instrSeq=[\n{instrs}]),")
+
+  varLines = [f'"{name}": {varType},' for name, varType in sorted(allVars.items())]
+  callGraph = [f'"{name}": {json.dumps(callees)},' for name, callees in CALLEES.items()]
+  return ("tunit.TranslationUnit(\n"
+          'name = "callgraph.c",\n'
+          'description = "Synthetic.",\n'
+          "allConstructs = {\n" + "\n".join(constructs) + "\n},\n"
+          "allVars = {\n" + "\n".join(varLines) + "\n},\n"
+          "callGraph = {\n" + "\n".join(callGraph) + "\n},\n"
+          "callGraphSccs = [],\n"
+          "typeLayouts = {},\n"
+          ")\n")
+
+
+def getNativeCallGraph(fileName):
+  """Returns the callGraph and the callGraphSccs of the IR file by
+  slang-ircheck -call-graph, and the lines of its notes."""
+  result = subprocess.run([IRCHECK, "-call-graph", fileName],
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                          universal_newlines=True)
+  if result.returncode != 0:
+    raise RuntimeError(result.stderr)
+  lines = result.stdout.splitlines()
+  start = lines.index("callGraph = {")
+  text = "\n".join(line.split("#")[0] for line in lines[start:])
+  text = text.replace("callGraph = ", "").replace("callGraphSccs = ", "")
+  callGraph, sccs = ast.literal_eval("(" + text + ")")[:2]
+  return callGraph, sccs, lines[2:start]
+
+
+@unittest.skipUnless(IRCHECK, "slang-ircheck is not found (see SLANG_IRCHECK)")
+class CallGraphTest(unittest.TestCase):
+
+  def test_call_graph(self):
+    with tempfile.TemporaryDirectory() as tmpDir:
+      fileName = os.path.join(tmpDir, "callgraph.c.spanir")
+      with open(fileName, "w") as f:
+        f.write(makeCallGraphIr())
+      callGraph, sccs, notes = getNativeCallGraph(fileName)
+
+    self.assertEqual(callGraph, CALLEES)
+    self.assertEqual(notes, [])  # the same as the callGraph of the file
+    levels = {tuple(funcNames): level for level, funcNames in sccs}
+    # the cycle is one SCC, at the level of a leaf (it calls no other SCC)
+    self.assertEqual(levels[("f:even", "f:odd")], 0)
+    # a self-recursive function is an SCC of its own
+    self.assertEqual(levels[("f:fact",)], 0)
+    self.assertEqual(levels[("f:main",)], 1)
+    self.assertEqual(len(sccs), len(CALLEES) - 1)
+    # callees before callers
+    order = [name for _, funcNames in sccs for name in funcNames]
+    self.assertGreater(order.index("f:main"), order.index("f:sq"))
+
+  def test_fixture(self):
+    # the indirect call fp(&b) of main() resolves to id() and other()
+    callGraph, _, notes = getNativeCallGraph(os.path.join(TESTS_DIR, "pointsto.c.spanir"))
+    self.assertEqual(callGraph["f:main"], ["f:id", "f:malloc", "f:other"])
+    self.assertEqual(notes, [])
+
+
+if __name__ == "__main__":
+  unittest.main()
@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2019 Anshuman Dhuliya
+
+"""Tests of the native liveness analysis of the DeadStore checker (see
+ad/SlangCheckers/SlangLiveness.h), run by slang-ircheck -dead-stores on
+the IR of tests/deadstore.c and tests/checker1.c. They run if slang-ircheck
+is on the PATH, or named by the environment variable SLANG_IRCHECK.
+"""
+
+import os
+import shutil
+import subprocess
+import unittest
+
+TESTS_DIR = os.path.dirname(os.path.abspath(__file__))
+IRCHECK = os.environ.get("SLANG_IRCHECK") or shutil.which("slang-ircheck")
+
+
+@unittest.skipUnless(IRCHECK, "slang-ircheck is not found (see SLANG_IRCHECK)")
+class DeadStoreTest(unittest.TestCase):
+
+  def getDeadStores(self, fileName):
+    """Returns the dead stores of the functions of the file in tests/."""
+    result = subprocess.run([IRCHECK, "-dead-stores", fileName], cwd=TESTS_DIR,
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                            universal_newlines=True)
+    self.assertEqual(result.returncode, 0, result.stderr)
+    lines = result.stdout.splitlines()
+    self.assertTrue(lines[0].startswith(fileName + ": ok: "), lines[0])
+    return lines[1:]
+
+  def test_local_initializer(self):
+    # the initializer of x is overwritten on both branches before x is read
+    self.assertEqual(self.getDeadStores("deadstore.c.spanir"), [
+      "deadstore.c.spanir: f:f: 4:3: Value stored to 'x' is never read",
+      "deadstore.c.spanir: f:f: 11:3: Value stored to 'y' is never read",
+    ])
+
+  def test_none(self):
+    for fileName in ["checker1.c.spanir", "checker1.c.types.spanir"]:
+      with self.subTest(fileName=fileName):
+        self.assertEqual(self.getDeadStores(fileName), [])
+
+
+if __name__ == "__main__":
+  unittest.main()
@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2019 Anshuman Dhuliya
+
+"""Tests of slang-irlink (see ad/SlangIrLink), on the IR of tests/link,
+read back with span.ir.irload.SpanProgFile. They run if slang-irlink is
+on the PATH, or named by the environment variable SLANG_IRLINK.
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+
+TESTS_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.dirname(TESTS_DIR))
+
+import span.ir.irload as irload
+from span.util.summarycache import SummaryCache
+
+LINK_DIR = os.path.join(TESTS_DIR, "link")
+IRLINK = os.environ.get("SLANG_IRLINK") or shutil.which("slang-irlink")
+
+
+@unittest.skipUnless(IRLINK, "slang-irlink is not found (see SLANG_IRLINK)")
+class IrLinkTest(unittest.TestCase):
+
+  def link(self, *fileNames, sharedDir=None):
+    """Links the files of tests/link: returns the (stderr, SpanProgFile)."""
+    progPath = os.path.join(self.tmpDir.name, "prog.spanprog")
+    paths = [os.path.join(LINK_DIR, fileName) for fileName in fileNames]
+    options = ["-shared", sharedDir] if sharedDir else []
+    result = subprocess.run([IRLINK] + options + ["-o", progPath] + paths,
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                            universal_newlines=True)
+    self.assertEqual(result.returncode, 0, result.stderr)
+    prog = irload.SpanProgFile(progPath, native=False)
+    self.addCleanup(prog.close)
+    return result.stderr, prog
+
+  def setUp(self):
+    self.tmpDir = tempfile.TemporaryDirectory()
+    self.addCleanup(self.tmpDir.cleanup)
+
+  def test_static_globals_per_unit(self):
+    _, prog = self.link("a.c.spanir", "b.c.spanir")
+    self.assertEqual(sorted(prog.getNames(irload.PROG_GLOBAL)),
+                     ["v:count@0", "v:count@1", "v:total"])
+    self.assertEqual(prog.load(irload.PROG_FUNC, "f:next").instrSeq[0].lhs.name, "v:count@0")
+    self.assertEqual(prog.load(irload.PROG_FUNC, "f:next@1").instrSeq[0].lhs.name, "v:count@1")
+
+  def test_conflicts_renamed(self):
+    stderr, prog = self.link("a.c.spanir", "b.c.spanir")
+    self.assertEqual(stderr, "conflict: f:next in b.c renamed to f:next@1\n")
+    self.assertEqual(sorted(prog.getNames(irload.PROG_FUNC)),
+                     ["f:main", "f:next", "f:next@1", "f:useA"])
+    # the declaration of f:useA in b.c resolves to its definition in a.c
+    self.assertTrue(prog.load(irload.PROG_FUNC, "f:useA").instrSeq)
+    callGraph = prog.load(irload.PROG_CALL_GRAPH, "callGraph")
+    self.assertEqual(callGraph["f:main"], ["f:next@1", "f:useA"])
+    self.assertEqual(callGraph["f:useA"], ["f:next"])
+    self.assertEqual(prog.load(irload.PROG_UNITS, "units"), ["a.c", "b.c"])
+
+  def test_same_unit_twice(self):
+    # the same definitions are kept once, but not the static globals
+    stderr, prog = self.link("a.c.spanir", "a.c.spanir")
+    self.assertEqual(sorted(prog.getNames(irload.PROG_GLOBAL)),
+                     ["v:count@0", "v:count@1", "v:total"])
+    self.assertIn("f:next in a.c renamed to f:next@1", stderr)
+
+  def test_shared_dir(self):
+    # two TUs refer to f:inl (and its local) in the shared dir: linked once
+    sharedDir = os.path.join(self.tmpDir.name, "shared")
+    self.assertTrue(SummaryCache(sharedDir).store(irload.SHARED_IR_CACHE_ID, "5e1d6a0c4b3f2e19", """
+tunit.TranslationUnit(
+  name = "shared:f:inl",
+  description = "",
+  allConstructs = {
+    "f:inl": constructs.Func(name = "f:inl", paramNames = [], variadic = False,
+      returnType = types.Int32, instrSeq = [
+        instr.AssignI(expr.VarE("v:inl:x", Loc(2,3)), expr.LitE(1, Loc(2,7)), Loc(2,3)),
+        instr.ReturnI(expr.VarE("v:inl:x", Loc(3,10)), Loc(3,3))]),
+  },
+  allVars = {"v:inl:x": types.Int32},
+)"""))
+    paths = []
+    for name in ["c", "d"]:
+      paths.append(os.path.join(self.tmpDir.name, name + ".c.spanir"))
+      with open(paths[-1], "w") as f:
+        f.write(f"""tunit.TranslationUnit(
+  name = "{name}.c",
+  description = "",
+  allConstructs = {{
+    "f:{name}": constructs.Func(name = "f:{name}", paramNames = [], variadic = False,
+      returnType = types.Int32, instrSeq = [instr.CallI(expr.CallE(
+        expr.FuncE("f:inl", Loc(2,3)), None, Loc(2,3)), Loc(2,3))]),
+  }},
+  allVars = {{}},
+  sharedConstructs = {{"f:inl": "5e1d6a0c4b3f2e19"}},
+  callGraph = {{"f:{name}": ["f:inl"], "f:inl": []}},
+)""")
+    stderr, prog = self.link(*paths, sharedDir=sharedDir)
+    self.assertEqual(stderr, "")
+    self.assertEqual(sorted(prog.getNames(irload.PROG_FUNC)), ["f:c", "f:d", "f:inl"])
+    self.assertEqual(list(prog.load(irload.PROG_LOCALS, "f:inl")), ["v:inl:x"])
+    self.assertEqual(prog.load(irload.PROG_CALL_GRAPH, "callGraph")["f:d"], ["f:inl"])
+
+    # an entry not in the shared dir
+    shutil.rmtree(sharedDir)
+    result = subprocess.run([IRLINK, "-shared", sharedDir, "-o", os.devnull] + paths,
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                            universal_newlines=True)
+    self.assertNotEqual(result.returncode, 0)
+    self.assertIn("f:inl of " + paths[0], result.stderr)
+
+
+if __name__ == "__main__":
+  unittest.main()
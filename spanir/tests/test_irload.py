@@ -0,0 +1,293 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2019 Anshuman Dhuliya
+
+"""Tests of span.ir.irload, with the native loader (if built, see
+spanir/setup.py) and with eval(). From spanir,
+
+  python3 -m unittest discover -s tests
+"""
+
+import os
+import sys
+import tempfile
+import unittest
+from unittest import mock
+
+TESTS_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.dirname(TESTS_DIR))
+
+import span.ir.irload as irload
+import span.ir.obj as obj
+import span.ir.tunit as tunit
+import span.ir.types as types
+import span.util.embedded as embedded
+from span.util.summarycache import SummaryCache
+
+# the IR of checker1.c, as the SlangGenAst checker writes it
+CHECKER_IR = os.path.join(TESTS_DIR, "checker1.c.spanir")
+# ... with TypeTable=true (the types referred to as T(<index>))
+CHECKER_TYPES_IR = os.path.join(TESTS_DIR, "checker1.c.types.spanir")
+# ... with Output=shards:tests/shards
+CHECKER_MANIFEST = os.path.join(TESTS_DIR, "shards", "checker1.c.spanir.manifest")
+# ... linked by slang-irlink (slang-irlink -o checker1.spanprog checker1.c.spanir)
+CHECKER_PROG = os.path.join(TESTS_DIR, "checker1.spanprog")
+
+# the loaders tested: True for the native one
+LOADERS = [True, False] if irload.isNative() else [False]
+
+
+class LoaderTest(unittest.TestCase):
+
+  def test_old_tests_load(self):
+    for native in LOADERS:
+      for i in range(1, 4):
+        with self.subTest(native=native, test=i):
+          tUnit = irload.loadSpanIrFile(os.path.join(TESTS_DIR, f"test{i}.py.spanir"), native)
+          self.assertIsInstance(tUnit, tunit.TranslationUnit)
+
+  def test_values(self):
+    for native in LOADERS:
+      with self.subTest(native=native):
+        self.assertEqual(irload.loadSpanIr('[1, -2, 0x1f, "a" "b", (1,), {"k": None}]', native),
+                         [1, -2, 31, "ab", (1,), {"k": None}])
+        self.assertEqual(irload.loadSpanIr("types.Ptr(to=types.Int32)", native),
+                         types.Ptr(to=types.Int32))
+
+  def test_internal_vars(self):
+    for native in LOADERS:
+      with self.subTest(native=native):
+        tUnit = irload.loadSpanIrFile(os.path.join(TESTS_DIR, "link", "a.c.spanir"), native)
+        self.assertEqual(tUnit.internalVars, {"v:count"})
+
+
+class CheckerIrTest(unittest.TestCase):
+
+  def test_load(self):
+    for native in LOADERS:
+      with self.subTest(native=native):
+        tUnit = irload.loadSpanIrFile(CHECKER_IR, native)
+        self.assertEqual(sorted(tUnit.allObjs), ["f:main", "f:malloc", "f:sum", "s:node"])
+        func = tUnit.allObjs["f:sum"]
+        self.assertIsInstance(func, obj.Func)
+        self.assertEqual(func.irHash, "5a1e0f3c9b27d4e8")
+        self.assertEqual(len(func.instrSeq), 10)
+        self.assertTrue(func.basicBlocks)
+        self.assertFalse(tUnit.allObjs["f:malloc"].hasBody())
+        self.assertEqual([name for name, _ in tUnit.allObjs["s:node"].fields], ["val", "next"])
+        self.assertEqual(tUnit.callGraph["f:main"], ["f:malloc", "f:sum"])
+        self.assertEqual(tUnit.getTypeLayout(types.Int32), (4, 4))
+
+  @unittest.skipUnless(irload.isNative(), "the native loader is not built")
+  def test_embedded_diagnose(self): # (it loads with the default, native loader)
+    class SysDiagnosis:
+      @staticmethod
+      def runDiagnosis(name, func):
+        return [(name, "Test", [(1, 1, func.name)])]
+
+    saved = embedded._sysDiagnosis
+    embedded._sysDiagnosis = SysDiagnosis
+    try:
+      with open(CHECKER_IR) as f:
+        bugs = embedded.diagnose(f.read(), "Test")
+    finally:
+      embedded._sysDiagnosis = saved
+    self.assertEqual(sorted(bug[2][0][2] for bug in bugs), ["f:main", "f:sum"])
+
+
+class TypeTableTest(unittest.TestCase):
+
+  def test_same_as_full_types(self):
+    for native in LOADERS:
+      with self.subTest(native=native):
+        full = irload.loadSpanIrFile(CHECKER_IR, native)
+        tUnit = irload.loadSpanIrFile(CHECKER_TYPES_IR, native)
+        # (str(): == recurses into the fields of the recursive s:node)
+        self.assertEqual({name: str(varType) for name, varType in tUnit.allVars.items()},
+                         {name: str(varType) for name, varType in full.allVars.items()})
+        for funcName in ["f:sum", "f:main", "f:malloc"]:
+          func, fullFunc = tUnit.allObjs[funcName], full.allObjs[funcName]
+          self.assertEqual(str(func.sig), str(fullFunc.sig))
+          self.assertEqual([str(insn) for insn in func.instrSeq],
+                           [str(insn) for insn in fullFunc.instrSeq])
+        # each type of the table is made once (seen in the arguments of the
+        # TranslationUnit, before its preProcess())
+        with open(CHECKER_TYPES_IR) as f:
+          spanIr, typesText = irload._splitTypeTable(f.read())
+        names = irload._withTypes(irload._withTUnit(irload.NAMES, dict), typesText, native)
+        args = irload._load(spanIr, names, native)
+        self.assertIs(args["allVars"]["v:sum:p"], args["allVars"]["v:main:n"])
+
+
+class SpanIrFileTest(unittest.TestCase):
+  """Loads the parts of checker1.c.spanir through its index (written as
+  dumpIrIndex() of the checker does)."""
+
+  def test_load_parts(self):
+    for native in LOADERS:
+      with self.subTest(native=native):
+        # the arguments of the TranslationUnit, before its preProcess()
+        with open(CHECKER_IR) as f:
+          args = irload._load(f.read(), irload._withTUnit(irload.NAMES, dict), native)
+        with irload.SpanIrFile(CHECKER_IR, native) as irFile:
+          self.assertEqual(irFile.getFuncNames(), ["f:sum", "f:main", "f:malloc"])
+          self.assertEqual(irFile.index.funcs["f:sum"].instrs, 7)
+          for funcName in irFile.getFuncNames():
+            func = irFile.loadFunc(funcName)
+            self.assertIsInstance(func, obj.Func)
+            self.assertEqual(func.name, funcName)
+            self.assertEqual([str(insn) for insn in func.instrSeq],
+                             [str(insn) for insn in args["allConstructs"][funcName].instrSeq])
+          self.assertIsNone(irFile.loadFunc("f:absent"))
+          self.assertEqual(irFile.loadVars(), args["allVars"])
+          self.assertEqual(irFile.loadRecords()["s:node"].fields,
+                           args["allConstructs"]["s:node"].fields)
+
+
+class SharedIrTest(unittest.TestCase):
+  """A TU written with the checker option SharedIrDir: f:inl is in the dir."""
+
+  IR = """tunit.TranslationUnit(
+  name = "inl.c",
+  description = "",
+  allConstructs = {},
+  allVars = {},
+  sharedConstructs = {"f:inl": "5e1d6a0c4b3f2e19"},
+)"""
+
+  SHARED_IR = """tunit.TranslationUnit(
+  name = "inl.h",
+  description = "",
+  allConstructs = {
+    "f:inl": constructs.Func(name = "f:inl", paramNames = [], variadic = False,
+      returnType = types.Int32, instrSeq = [instr.ReturnI(expr.LitE(1, Loc(2,10)), Loc(2,3))]),
+  },
+  allVars = {},
+)"""
+
+  def test_shared_dir(self):
+    for native in LOADERS:
+      with self.subTest(native=native), tempfile.TemporaryDirectory() as sharedDir:
+        self.assertTrue(SummaryCache(sharedDir).store(
+          irload.SHARED_IR_CACHE_ID, "5e1d6a0c4b3f2e19", self.SHARED_IR))
+        tUnit = irload.loadSpanIr(self.IR, native, sharedDir)
+        self.assertTrue(tUnit.allObjs["f:inl"].hasBody())
+
+  def test_no_shared_dir(self):
+    for native in LOADERS:
+      with self.subTest(native=native):
+        with self.assertRaises(ValueError) as cm:
+          irload.loadSpanIr(self.IR, native)
+        self.assertIn("f:inl", str(cm.exception))
+        self.assertIn("SharedIrDir", str(cm.exception))
+
+
+def getShardFuncNames(shardPath: str):
+  """(for mapShards())"""
+  allObjs = irload.loadShard(shardPath, native=irload.isNative()).allObjs
+  return sorted(name for name, value in allObjs.items()
+                if isinstance(value, obj.Func) and value.hasBody())
+
+
+class ShardsTest(unittest.TestCase):
+
+  def test_load_shards(self):
+    for native in LOADERS:
+      with self.subTest(native=native):
+        manifest = irload.loadManifest(CHECKER_MANIFEST, native)
+        self.assertEqual(list(manifest["allConstructs"]), ["s:node"])
+        shardPaths = irload.getShardPaths(CHECKER_MANIFEST, manifest)
+        self.assertEqual([os.path.basename(path) for path in shardPaths],
+                         ["checker1.c.0.spanir", "checker1.c.1.spanir"])
+        tUnit = irload.loadShard(shardPaths[0], manifest, native)
+        self.assertEqual(sorted(tUnit.allObjs), ["f:main", "f:malloc", "f:sum", "s:node"])
+        self.assertTrue(tUnit.allObjs["f:sum"].hasBody())
+        self.assertFalse(tUnit.allObjs["f:main"].hasBody()) # in the other shard
+        self.assertIn("v:sum:p", tUnit.allVars)
+        self.assertEqual(tUnit.callGraph["f:main"], ["f:malloc", "f:sum"])
+        # the malloc() of main(), typed by the signature in the manifest
+        tUnit = irload.loadShard(shardPaths[1], manifest, native)
+        self.assertIn("v:main:p.1", tUnit.allVars)
+
+  def test_map_shards(self):
+    self.assertEqual(irload.mapShards(CHECKER_MANIFEST, getShardFuncNames, processes=2,
+                                      native=irload.isNative()),
+                     [["f:sum"], ["f:main"]])
+
+
+class SpanProgFileTest(unittest.TestCase):
+
+  def test_load_items(self):
+    for native in LOADERS:
+      with self.subTest(native=native):
+        with irload.SpanProgFile(CHECKER_PROG, native) as prog:
+          self.assertEqual(sorted(prog.getNames(irload.PROG_FUNC)), ["f:main", "f:malloc", "f:sum"])
+          func = prog.load(irload.PROG_FUNC, "f:sum")
+          self.assertIsInstance(func, obj.Func)
+          self.assertEqual(len(func.instrSeq), 10)
+          self.assertEqual(prog.load(irload.PROG_LOCALS, "f:sum")["v:sum:s"], types.Int32)
+          self.assertEqual(prog.load(irload.PROG_RECORD, "s:node").fields[0], ("val", types.Int32))
+          self.assertEqual(prog.load(irload.PROG_UNITS, "units"), ["checker1.c"])
+          self.assertEqual(prog.load(irload.PROG_CALL_GRAPH, "callGraph")["f:main"],
+                           ["f:malloc", "f:sum"])
+          self.assertIsNone(prog.load(irload.PROG_FUNC, "f:absent"))
+
+
+class EvalFallbackTest(unittest.TestCase):
+  """A native load (the default) when the native loader is not built."""
+
+  IR = "types.Ptr(to=types.Int32)"
+
+  def setUp(self):
+    patcher = mock.patch.object(irload, "_irload", None)
+    patcher.start()
+    self.addCleanup(patcher.stop)
+
+  def test_no_silent_eval(self):
+    with mock.patch.dict(os.environ, {irload.EVAL_FALLBACK_ENV: ""}):
+      with self.assertRaises(RuntimeError) as cm:
+        irload.loadSpanIr(self.IR)
+    self.assertIn("not built", str(cm.exception))
+
+  def test_eval_opted_in(self):
+    with mock.patch.dict(os.environ, {irload.EVAL_FALLBACK_ENV: "1"}):
+      with self.assertLogs(irload._log, "WARNING") as cm:
+        self.assertEqual(irload.loadSpanIr(self.IR), types.Ptr(to=types.Int32))
+        irload.loadSpanIr(self.IR)
+    self.assertEqual(len(cm.output), 2) # a warning for each load
+    self.assertIn("eval()-ing", cm.output[0])
+
+  def test_eval_asked_for(self):
+    with mock.patch.dict(os.environ, {irload.EVAL_FALLBACK_ENV: ""}):
+      self.assertEqual(irload.loadSpanIr(self.IR, native=False), types.Ptr(to=types.Int32))
+
+
+@unittest.skipUnless(irload.isNative(), "the native loader is not built")
+class NativeLoaderSafetyTest(unittest.TestCase):
+
+  def assertRejected(self, text: str, message: str):
+    with self.assertRaises(ValueError) as cm:
+      irload.loadSpanIr(text)
+    self.assertIn(message, str(cm.exception))
+
+  def test_only_span_ir_names(self):
+    self.assertRejected("expr.util.os.getcwd()", "unknown name 'expr.util.os.getcwd'")
+    self.assertRejected("tunit.re.compile('x')", "unknown name 'tunit.re.compile'")
+    self.assertRejected("expr.VarE.mro()", "unknown name 'expr.VarE.mro'")
+    self.assertRejected("types.Int32.__class__", "the names starting with '_'")
+
+  def test_no_file_written(self):
+    with tempfile.TemporaryDirectory() as tmpDir:
+      path = os.path.join(tmpDir, "x")
+      self.assertRejected(f'expr.io.open("{path}", "w")', "unknown name 'expr.io.open'")
+      self.assertFalse(os.path.exists(path))
+
+  def test_nesting_limited(self):
+    self.assertRejected("[" * 1000 + "]" * 1000, "nested too deep")
+    self.assertRejected("-" * 1000 + "1", "nested too deep")
+    self.assertEqual(irload.loadSpanIr("[" * 100 + "]" * 100), eval("[" * 100 + "]" * 100))
+
+
+if __name__ == "__main__":
+  unittest.main()
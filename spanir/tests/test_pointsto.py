@@ -0,0 +1,383 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2019 Anshuman Dhuliya
+
+"""Tests of the native points-to analysis (see ad/SlangCheckers/SlangPointsTo.h),
+run by slang-ircheck -points-to, against RefPointsTo: a naive python solver
+of the same constraints, on the IR of tests/pointsto.c and on a synthetic IR
+(see makeSyntheticIr()). They run if slang-ircheck is on the PATH, or named
+by the environment variable SLANG_IRCHECK.
+"""
+
+import ast
+import collections
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+
+TESTS_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.dirname(TESTS_DIR))
+
+import span.ir.expr as expr
+import span.ir.instr as instr
+import span.ir.irload as irload
+import span.ir.obj as obj
+import span.ir.op as op
+import span.ir.types as types
+
+IRCHECK = os.environ.get("SLANG_IRCHECK") or shutil.which("slang-ircheck")
+
+ALLOC_FUNCS = {"f:malloc", "f:calloc", "f:realloc", "f:aligned_alloc",
+               "f:strdup", "f:strndup"}
+
+
+class RefPointsTo:
+  """The points-to analysis of SlangPointsTo.cpp (inclusion based, flow,
+  context and field insensitive), solved naively: all the constraints are
+  applied again until no set changes. It is the reference of the tests.
+
+  It takes the arguments of the TranslationUnit of the IR (see
+  loadTUnitArgs()): the IR as the checker wrote it, which the native
+  analysis sees, not as TranslationUnit.preProcess() transforms it."""
+
+  def __init__(self, tUnitArgs):
+    self.varTypes = tUnitArgs["allVars"]
+    self.pts = collections.defaultdict(set)  # node name -> object names
+    self.copies = []  # (src, dst): pts(dst) >= pts(src)
+    self.loads = []   # (ptr, dst): pts(dst) >= pts(*ptr)
+    self.stores = []  # (ptr, src): pts(*ptr) >= pts(src)
+    self.calls = []   # (func name, or None and the callee node, args, result)
+    self.params = {}  # func name -> param names
+    self.tmpCount = 0
+    self.funcName = ""
+
+    constructs = tUnitArgs.get("allConstructs", tUnitArgs.get("allObjs", {}))
+    funcs = [f for f in constructs.values() if isinstance(f, obj.Func)]
+    for func in funcs:
+      self.params[func.name] = func.paramNames
+    for func in funcs:
+      self.funcName = func.name
+      for ins in func.instrSeq:
+        self.addInstr(ins)
+
+  def newTmp(self):
+    self.tmpCount += 1
+    return f"tmp:{self.tmpCount}"
+
+  def isArrayVar(self, name):
+    return isinstance(self.varTypes.get(name), (types.ConstSizeArray, types.IncompleteArray))
+
+  def isRecordVar(self, name):
+    return isinstance(self.varTypes.get(name), (types.Struct, types.Union))
+
+  def heapName(self, e):
+    line, col = (e.loc.line, e.loc.col) if e.loc else (0, 0)
+    return f"heap:{self.funcName}:{line}:{col}"
+
+  def addInstr(self, ins):
+    if isinstance(ins, instr.AssignI):
+      sources = self.evalRhs(ins.rhs)
+      if isinstance(ins.lhs, expr.VarE):
+        for source in sources:
+          self.assign(ins.lhs.name, source)
+        return
+      location = self.getLocation(ins.lhs)
+      if location is None:
+        return
+      direct, node = location
+      for source in sources:
+        if direct:
+          self.assign(node, source)
+        else:
+          self.stores.append((node, self.toNode(source)))
+    elif isinstance(ins, instr.CallI):
+      self.evalCall(ins.arg, None)
+    elif isinstance(ins, instr.ReturnI) and ins.arg is not None:
+      for source in self.evalRhs(ins.arg):
+        self.assign("ret:" + self.funcName, source)
+
+  def evalRhs(self, e):
+    """Returns the (kind, node) sources of the value: kind is one of
+    "addr" (the node itself), "copy" (its set) and "load" (what it points to)."""
+    if isinstance(e, expr.VarE):
+      return [("addr" if self.isArrayVar(e.name) else "copy", e.name)]
+    if isinstance(e, expr.FuncE):
+      return [("addr", e.name)]
+    if isinstance(e, expr.AddrOfE):
+      if isinstance(e.arg, (expr.VarE, expr.FuncE)):
+        return [("addr", e.arg.name)]
+      location = self.getLocation(e.arg)
+      if location is None:
+        return []
+      return [("addr" if location[0] else "copy", location[1])]
+    if isinstance(e, (expr.UnaryE, expr.MemberE, expr.ArrayE)):
+      location = self.getLocation(e)
+      if location is None:
+        return []
+      return [("copy" if location[0] else "load", location[1])]
+    if isinstance(e, expr.CastE):
+      return self.evalRhs(e.arg)
+    if isinstance(e, expr.BinaryE):
+      if e.opr.opCode in (op.BO_ADD_OC, op.BO_SUB_OC):
+        return self.evalRhs(e.arg1) + self.evalRhs(e.arg2)
+      return []
+    if isinstance(e, expr.SelectE):
+      return self.evalRhs(e.arg1) + self.evalRhs(e.arg2)
+    if isinstance(e, expr.AllocE):
+      return [("addr", self.heapName(e))]
+    if isinstance(e, expr.CallE):
+      result = self.newTmp()
+      self.evalCall(e, result)
+      return [("copy", result)]
+    return []
+
+  def getLocation(self, e):
+    """Returns (direct, node) of the location accessed: the variable node
+    itself if direct, else whatever node points to; or None."""
+    if isinstance(e, expr.UnaryE):
+      if e.opr.opCode != op.UO_DEREF_OC:
+        return None
+      node = self.evalToNode(e.arg)
+      return None if node is None else (False, node)
+    if not isinstance(e, (expr.MemberE, expr.ArrayE)):
+      return None
+    base = e.of
+    if isinstance(base, expr.VarE):
+      if self.isRecordVar(base.name) or self.isArrayVar(base.name):
+        return (True, base.name)
+    elif isinstance(base, (expr.MemberE, expr.ArrayE)):
+      return self.getLocation(base)
+    node = self.evalToNode(base)
+    return None if node is None else (False, node)
+
+  def evalCall(self, e, result):
+    args = [self.evalToNode(arg) for arg in (e.args or [])]
+    if isinstance(e.callee, expr.FuncE):
+      if e.callee.name in ALLOC_FUNCS:
+        if result is not None:
+          self.pts[result].add(self.heapName(e))
+        return
+      self.calls.append((e.callee.name, None, args, result))
+      return
+    callee = self.evalToNode(e.callee)
+    if callee is not None:
+      self.calls.append((None, callee, args, result))
+
+  def evalToNode(self, e):
+    sources = self.evalRhs(e)
+    if not sources:
+      return None
+    if len(sources) == 1:
+      return self.toNode(sources[0])
+    tmp = self.newTmp()
+    for source in sources:
+      self.assign(tmp, source)
+    return tmp
+
+  def toNode(self, source):
+    if source[0] == "copy":
+      return source[1]
+    tmp = self.newTmp()
+    self.assign(tmp, source)
+    return tmp
+
+  def assign(self, dst, source):
+    kind, node = source
+    if kind == "addr":
+      self.pts[dst].add(node)
+    elif kind == "copy":
+      self.copies.append((node, dst))
+    else:
+      self.loads.append((node, dst))
+
+  def solve(self):
+    pts = self.pts
+
+    def copy(src, dst):
+      if src != dst and not pts[src] <= pts[dst]:
+        pts[dst] |= pts[src]
+        return True
+      return False
+
+    changed = True
+    while changed:
+      changed = False
+      for src, dst in self.copies:
+        changed |= copy(src, dst)
+      for ptr, dst in self.loads:
+        for o in list(pts[ptr]):
+          changed |= copy(o, dst)
+      for ptr, src in self.stores:
+        for o in list(pts[ptr]):
+          changed |= copy(src, o)
+      for funcName, callee, args, result in self.calls:
+        targets = [funcName] if funcName else [o for o in pts[callee] if o.startswith("f:")]
+        for target in targets:
+          if target not in self.params:
+            continue  # a library function without a declaration
+          for arg, param in zip(args, self.params[target]):
+            if arg is not None:
+              changed |= copy(arg, param)
+          if result is not None:
+            changed |= copy("ret:" + target, result)
+
+  def getPointsTo(self):
+    """Returns variable name -> sorted names of the objects it points to."""
+    return {name: sorted(objs) for name, objs in self.pts.items()
+            if name.startswith("v:") and objs}
+
+
+def loadTUnitArgs(fileName):
+  """Returns the arguments of the TranslationUnit of the IR file, as a dict."""
+  with open(fileName) as f:
+    return irload._load(f.read(), irload._withTUnit(irload.NAMES, dict), irload.isNative())
+
+
+def getRefPointsTo(fileName):
+  """Returns the points-to sets by RefPointsTo of the IR file."""
+  refPointsTo = RefPointsTo(loadTUnitArgs(fileName))
+  refPointsTo.solve()
+  return refPointsTo.getPointsTo()
+
+
+def getNativePointsTo(fileName):
+  """Returns the points-to sets of the IR file by slang-ircheck -points-to,
+  and the line of the solver statistics."""
+  result = subprocess.run([IRCHECK, "-points-to", fileName],
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                          universal_newlines=True)
+  if result.returncode != 0:
+    raise RuntimeError(result.stderr)
+  lines = result.stdout.splitlines()
+  return ast.literal_eval("\n".join(lines[2:])), lines[1]
+
+
+def makeSyntheticIr(numFuncs):
+  """Returns the IR of numFuncs functions f0, f1... each like
+
+    int *fI(int *p) {
+      int a, b;
+      int *x, *y, *z, *s, *t, *u;
+      int **pp, **h;
+      int *(*fp)(int *);
+      x = &a; y = x; z = y; x = z;  // a copy cycle
+      y = p;
+      pp = &x; *pp = &b; s = *pp;   // a store and a load
+      fp = f<I+1>; t = fp(&b);      // an indirect call
+      u = f<7I+3>(&a);              // a direct call
+      gp = u;
+      h = malloc(8);
+      *h = t;
+      return x;
+    }
+  """
+  ptr = "types.Ptr(to=types.Int32)"
+  ptrPtr = "types.Ptr(to=types.Ptr(to=types.Int32))"
+  funcPtr = ("types.Ptr(to=types.FuncSig(returnType=types.Ptr(to=types.Int32),"
+             " paramTypes=[types.Ptr(to=types.Int32)]))")
+  funcs, allVars, callGraph = [], {"v:gp": ptr}, []
+  for i in range(numFuncs):
+    f, nextF, callee = f"f{i}", f"f{(i + 1) % numFuncs}", f"f{(i * 7 + 3) % numFuncs}"
+    line = 10 * i
+
+    def v(name, col=3):
+      return f'expr.VarE("v:{f}:{name}", Loc({line},{col}))'
+
+    def assign(lhs, rhs, col=3):
+      return f"instr.AssignI({lhs}, {rhs}, Loc({line},{col}))"
+
+    instrs = [
+      assign(v("x"), f'expr.AddrOfE({v("a")}, Loc({line},7))'),
+      assign(v("y"), v("x")),
+      assign(v("z"), v("y")),
+      assign(v("x"), v("z")),
+      assign(v("y"), v("p")),
+      assign(v("pp"), f'expr.AddrOfE({v("x")}, Loc({line},8))'),
+      assign(v("1t"), f'expr.AddrOfE({v("b")}, Loc({line},9))'),
+      assign(f'expr.UnaryE(op.UO_DEREF, {v("pp")}, Loc({line},3))', v("1t")),
+      assign(v("s"), f'expr.UnaryE(op.UO_DEREF, {v("pp")}, Loc({line},7))'),
+      assign(v("fp"), f'expr.FuncE("f:{nextF}", Loc({line},8))'),
+      assign(v("2t"), f'expr.AddrOfE({v("b")}, Loc({line},10))'),
+      assign(v("t"), f'expr.CallE({v("fp")}, [{v("2t")}], Loc({line},7))'),
+      assign(v("3t"), f'expr.AddrOfE({v("a")}, Loc({line},11))'),
+      assign(v("u"), f'expr.CallE(expr.FuncE("f:{callee}", Loc({line},7)), [{v("3t")}],'
+                     f' Loc({line},7))'),
+      assign('expr.VarE("v:gp", Loc(1,1))', v("u")),
+      assign(v("4t"), f'expr.CallE(expr.FuncE("f:malloc", Loc({line},7)),'
+                      f' [expr.LitE(8, Loc({line},14))], Loc({line},7))'),
+      assign(v("h"), f"expr.CastE({v('4t')}, op.CastOp({ptrPtr}), Loc({line},7))"),
+      assign(f'expr.UnaryE(op.UO_DEREF, {v("h")}, Loc({line},3))', v("t")),
+      f'instr.ReturnI({v("x")}, Loc({line},3))',
+    ]
+    funcs.append(f'"f:{f}": constructs.Func(name="f:{f}", paramNames=["v:{f}:p"],'
+                 f' variadic=False, returnType={ptr}, instrSeq=[\n  '
+                 + ",\n  ".join(instrs) + "]),")
+    for name in ["a", "b"]:
+      allVars[f"v:{f}:{name}"] = "types.Int32"
+    for name in ["p", "x", "y", "z", "s", "t", "u", "1t", "2t", "3t"]:
+      allVars[f"v:{f}:{name}"] = ptr
+    allVars[f"v:{f}:4t"] = "types.Ptr(to=types.Void)"
+    for name in ["pp", "h"]:
+      allVars[f"v:{f}:{name}"] = ptrPtr
+    allVars[f"v:{f}:fp"] = funcPtr
+    callGraph.append(f'"f:{f}": ["f:{callee}", "f:malloc", "f:{nextF}"],')
+
+  funcs.append('"f:malloc": constructs.Func(name="f:malloc", paramNames=[], variadic=False,'
+               ' returnType=types.Ptr(to=types.Void), instrSeq=[]),')
+  varLines = [f'"{name}": {varType},' for name, varType in sorted(allVars.items())]
+  return ("tunit.TranslationUnit(\n"
+          f'name = "synthetic{numFuncs}.c",\n'
+          'description = "Synthetic.",\n'
+          "allConstructs = {\n" + "\n".join(funcs) + "\n},\n"
+          "allVars = {\n" + "\n".join(varLines) + "\n},\n"
+          "callGraph = {\n" + "\n".join(callGraph) + '\n"f:malloc": [],\n},\n'
+          "callGraphSccs = [],\n"
+          "typeLayouts = {},\n"
+          ")\n")
+
+
+@unittest.skipUnless(IRCHECK, "slang-ircheck is not found (see SLANG_IRCHECK)")
+class PointsToTest(unittest.TestCase):
+
+  def test_fixture(self):
+    fileName = os.path.join(TESTS_DIR, "pointsto.c.spanir")
+    pointsTo, _ = getNativePointsTo(fileName)
+    self.assertEqual(pointsTo, getRefPointsTo(fileName))
+
+    ab = ["v:main:a", "v:main:b"]
+    # copies (through the copy cycle p -> q -> r -> p), and a store: *pp = &b
+    for name in ["p", "q", "r"]:
+      self.assertEqual(pointsTo["v:main:" + name], ab)
+    # a load: s = *pp
+    self.assertEqual(pointsTo["v:main:pp"], ["v:main:q"])
+    self.assertEqual(pointsTo["v:main:s"], ab)
+    # an indirect call: t = fp(&b), fp is either id() or other()
+    self.assertEqual(pointsTo["v:main:fp"], ["f:id", "f:other"])
+    self.assertEqual(pointsTo["v:id:p"], ["v:main:b"])
+    self.assertEqual(pointsTo["v:other:q"], ["v:main:b"])
+    self.assertEqual(pointsTo["v:main:t"], ["v:g", "v:main:b"])
+    self.assertEqual(pointsTo["v:main:h"], ["heap:f:main:33:7"])
+
+  def test_checker_ir(self):
+    fileName = os.path.join(TESTS_DIR, "checker1.c.spanir")
+    pointsTo, _ = getNativePointsTo(fileName)
+    self.assertEqual(pointsTo, getRefPointsTo(fileName))
+    self.assertEqual(pointsTo["v:sum:p"], ["heap:f:main:18:20"])
+
+  def test_synthetic(self):
+    with tempfile.TemporaryDirectory() as tmpDir:
+      fileName = os.path.join(tmpDir, "synthetic.c.spanir")
+      with open(fileName, "w") as f:
+        f.write(makeSyntheticIr(50))
+      pointsTo, stats = getNativePointsTo(fileName)
+      self.assertEqual(pointsTo, getRefPointsTo(fileName))
+      self.assertIn(" 100 collapsed ", stats)  # the cycle x, y, z of each function
+      self.assertEqual(len(pointsTo["v:gp"]), 100)
+
+
+if __name__ == "__main__":
+  unittest.main()
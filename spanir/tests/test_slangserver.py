@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2019 Anshuman Dhuliya
+
+"""Tests that slang-server (see ad/SlangServer) writes the same SPAN IR as
+clang --analyze, on the C files of tests. They run if a slang-server is
+listening on the socket named by the environment variable SLANG_SERVER,
+and a clang with the SLANG checkers is on the PATH, or named by the
+environment variable SLANG_CLANG.
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+
+TESTS_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.dirname(TESTS_DIR))
+
+import span.util.slangserver as slangserver
+
+
+def findClang():
+  """Returns the clang to use, if it has the SLANG checkers."""
+  clang = os.environ.get("SLANG_CLANG") or shutil.which("clang")
+  if not clang:
+    return None
+  result = subprocess.run([clang, "-cc1", "-analyzer-checker-help"],
+                          stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                          universal_newlines=True)
+  return clang if "debug.SlangGenAst" in result.stdout else None
+
+
+SERVER = slangserver.getServerSocket()
+CLANG = findClang() if SERVER else None
+
+C_FILES = ["checker1.c", "deadstore.c", "pointsto.c"]
+
+
+def convertWithClang(cFileName: str, outFileName: str) -> str:
+  """Returns the SPAN IR of clang --analyze (the SlangGenAst checker)."""
+  subprocess.run([CLANG, "--analyze", "-Xanalyzer", "-analyzer-checker=debug.SlangGenAst",
+                  "-Xanalyzer", "-analyzer-config",
+                  "-Xanalyzer", f"debug.SlangGenAst:Output=file:{outFileName}",
+                  "-o", os.devnull, cFileName],
+                 check=True, stdout=subprocess.DEVNULL)
+  with open(outFileName) as f:
+    return f.read()
+
+
+@unittest.skipUnless(CLANG and SERVER,
+                     "needs slang-server (see SLANG_SERVER) and clang (see SLANG_CLANG)")
+class SlangServerTest(unittest.TestCase):
+
+  def test_same_ir_as_clang(self):
+    with tempfile.TemporaryDirectory() as tmpDir:
+      for fileName in C_FILES:
+        with self.subTest(file=fileName):
+          cFileName = os.path.join(TESTS_DIR, fileName)
+          clangIr = convertWithClang(cFileName, os.path.join(tmpDir, fileName + ".spanir"))
+          serverIr = slangserver.convert(SERVER, cFileName)
+          self.assertIsNotNone(serverIr)
+          self.assertEqual(serverIr, clangIr)
+          # again: from the TU the server kept parsed
+          self.assertEqual(slangserver.convert(SERVER, cFileName), clangIr)
+
+
+if __name__ == "__main__":
+  unittest.main()